@@ -10,9 +10,13 @@
 
 #include <entwine/formats/cesium/feature-table.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <stdexcept>
 
+#include <entwine/formats/cesium/settings.hpp>
 #include <entwine/formats/cesium/tile.hpp>
 
 namespace entwine
@@ -20,8 +24,80 @@ namespace entwine
 namespace cesium
 {
 
-FeatureTable::FeatureTable(const TileData& tileData)
+namespace
+{
+    const double quantizedMax(65535.0);
+
+    std::size_t align(std::size_t offset, std::size_t size)
+    {
+        return offset % size ? offset + size - offset % size : offset;
+    }
+
+    template<typename T>
+    void append(std::vector<char>& data, T v)
+    {
+        data.insert(
+                data.end(),
+                reinterpret_cast<const char*>(&v),
+                reinterpret_cast<const char*>(&v + 1));
+    }
+
+    void pad(std::vector<char>& data, std::size_t begin, std::size_t offset)
+    {
+        data.resize(begin + offset, 0);
+    }
+
+    uint16_t quantize(double v, double offset, double scale)
+    {
+        if (scale == 0.0) return 0;
+        const double q(std::round((v - offset) / scale * quantizedMax));
+        return std::max(0.0, std::min(quantizedMax, q));
+    }
+
+    uint8_t toSnorm(double v)
+    {
+        v = std::max(-1.0, std::min(1.0, v));
+        return std::round((v * 0.5 + 0.5) * 255.0);
+    }
+
+    double signNotZero(double v) { return v < 0.0 ? -1.0 : 1.0; }
+
+    // Octahedral encoding of a unit vector into two bytes, matching the
+    // decoding of NORMAL_OCT16P in Cesium's AttributeCompression.
+    void appendOct(std::vector<char>& data, const Point& n)
+    {
+        const double l1(std::abs(n.x) + std::abs(n.y) + std::abs(n.z));
+        double x(0), y(0);
+
+        if (l1 > 0.0)
+        {
+            x = n.x / l1;
+            y = n.y / l1;
+
+            if (n.z < 0.0)
+            {
+                const double ox(x);
+                x = (1.0 - std::abs(y)) * signNotZero(ox);
+                y = (1.0 - std::abs(ox)) * signNotZero(y);
+            }
+        }
+
+        data.push_back(toSnorm(x));
+        data.push_back(toSnorm(y));
+    }
+
+    uint16_t toRgb565(const Color& c)
+    {
+        return ((c.r >> 3) << 11) | ((c.g >> 2) << 5) | (c.b >> 3);
+    }
+}
+
+FeatureTable::FeatureTable(const TileData& tileData, const Settings& settings)
     : m_tileData(tileData)
+    , m_settings(settings)
+    , m_colorOffset(0)
+    , m_normalOffset(0)
+    , m_bytes(0)
 {
     if (colors().size() && colors().size() != points().size())
     {
@@ -34,27 +110,66 @@ FeatureTable::FeatureTable(const TileData& tileData)
         std::cout << normals().size() << " != " << points().size() << std::endl;
         throw std::runtime_error("Invalid normals size");
     }
+
+    if (m_settings.quantize() && points().size())
+    {
+        Point min(points().front());
+        Point max(points().front());
+
+        for (const Point& p : points())
+        {
+            min = Point::min(min, p);
+            max = Point::max(max, p);
+        }
+
+        m_volumeOffset = min;
+        m_volumeScale = Point(max.x - min.x, max.y - min.y, max.z - min.z);
+    }
+
+    m_colorOffset = align(positionBytes(), m_settings.rgb565() ? 2 : 1);
+    m_normalOffset = align(
+            m_colorOffset + colorBytes(),
+            m_settings.octNormals() ? 1 : sizeof(float));
+
+    const std::size_t end(m_normalOffset + normalBytes());
+    m_bytes = end ? align(end, 8) : 0;
 }
 
 Json::Value FeatureTable::getJson() const
 {
-    long byteOffset = 0;
-
     Json::Value json;
     json["POINTS_LENGTH"] = Json::UInt64(points().size());
-    json["POSITION"]["byteOffset"] = Json::UInt64(byteOffset);
-    byteOffset += points().size() * 3 * sizeof(float);
+
+    if (m_settings.quantize())
+    {
+        json["POSITION_QUANTIZED"]["byteOffset"] = 0;
+
+        Json::Value& offset(json["QUANTIZED_VOLUME_OFFSET"]);
+        offset.append(m_volumeOffset.x);
+        offset.append(m_volumeOffset.y);
+        offset.append(m_volumeOffset.z);
+
+        Json::Value& scale(json["QUANTIZED_VOLUME_SCALE"]);
+        scale.append(m_volumeScale.x);
+        scale.append(m_volumeScale.y);
+        scale.append(m_volumeScale.z);
+    }
+    else
+    {
+        json["POSITION"]["byteOffset"] = 0;
+    }
 
     if (colors().size())
     {
-        json["RGB"]["byteOffset"] = Json::UInt64(byteOffset);
-        byteOffset += colors().size() * 3 * sizeof(uint8_t);
+        const std::string name(m_settings.rgb565() ? "RGB565" : "RGB");
+        json[name]["byteOffset"] = Json::UInt64(m_colorOffset);
     }
 
     if (normals().size())
     {
-        json["NORMAL"]["byteOffset"] = Json::UInt64(byteOffset);
-        byteOffset += normals().size() * 3 * sizeof(float);
+        const std::string name(
+                m_settings.octNormals() ? "NORMAL_OCT16P" : "NORMAL");
+        json[name]["byteOffset"] = Json::UInt64(m_normalOffset);
     }
 
     return json;
@@ -62,48 +177,82 @@ Json::Value FeatureTable::getJson() const
 
 void FeatureTable::appendBinary(std::vector<char>& data) const
 {
-    float f;
-    const char* pos(reinterpret_cast<const char*>(&f));
-    const char* end(reinterpret_cast<const char*>(&f + 1));
+    const std::size_t begin(data.size());
+    data.reserve(begin + m_bytes);
 
-    for (const Point& p : points())
+    if (m_settings.quantize())
     {
-        f = p.x;
-        data.insert(data.end(), pos, end);
-
-        f = p.y;
-        data.insert(data.end(), pos, end);
+        const Point& o(m_volumeOffset);
+        const Point& s(m_volumeScale);
 
-        f = p.z;
-        data.insert(data.end(), pos, end);
+        for (const Point& p : points())
+        {
+            append(data, quantize(p.x, o.x, s.x));
+            append(data, quantize(p.y, o.y, s.y));
+            append(data, quantize(p.z, o.z, s.z));
+        }
     }
-
-    for (const Color& c : colors())
+    else
     {
-        data.push_back(c.r);
-        data.push_back(c.g);
-        data.push_back(c.b);
+        for (const Point& p : points())
+        {
+            append<float>(data, p.x);
+            append<float>(data, p.y);
+            append<float>(data, p.z);
+        }
     }
 
-    for (const Point& p : normals())
+    pad(data, begin, m_colorOffset);
+
+    if (m_settings.rgb565())
+    {
+        for (const Color& c : colors()) append(data, toRgb565(c));
+    }
+    else
     {
-        f = p.x;
-        data.insert(data.end(), pos, end);
+        for (const Color& c : colors())
+        {
+            data.push_back(c.r);
+            data.push_back(c.g);
+            data.push_back(c.b);
+        }
+    }
 
-        f = p.y;
-        data.insert(data.end(), pos, end);
+    pad(data, begin, m_normalOffset);
 
-        f = p.z;
-        data.insert(data.end(), pos, end);
+    if (m_settings.octNormals())
+    {
+        for (const Point& n : normals()) appendOct(data, n);
+    }
+    else
+    {
+        for (const Point& n : normals())
+        {
+            append<float>(data, n.x);
+            append<float>(data, n.y);
+            append<float>(data, n.z);
+        }
     }
+
+    pad(data, begin, m_bytes);
+}
+
+std::size_t FeatureTable::positionBytes() const
+{
+    return points().size() * 3 *
+        (m_settings.quantize() ? sizeof(uint16_t) : sizeof(float));
+}
+
+std::size_t FeatureTable::colorBytes() const
+{
+    return colors().size() *
+        (m_settings.rgb565() ? sizeof(uint16_t) : 3 * sizeof(uint8_t));
 }
 
-std::size_t FeatureTable::bytes() const
+std::size_t FeatureTable::normalBytes() const
 {
-    return
-        m_tileData.points.size() * 3 * sizeof(float) +
-        m_tileData.colors.size() * 3 * sizeof(uint8_t) +
-        m_tileData.normals.size() * 3 * sizeof(float);
+    return normals().size() *
+        (m_settings.octNormals() ? 2 * sizeof(uint8_t) : 3 * sizeof(float));
 }
 
 const std::vector<Point>& FeatureTable::points() const
@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include <json/json.h>
@@ -21,23 +22,39 @@ namespace entwine
 namespace cesium
 {
 
+class Settings;
 class TileData;
 
 class FeatureTable
 {
 public:
-    FeatureTable(const TileData& tileData);
+    FeatureTable(const TileData& tileData, const Settings& settings);
 
     Json::Value getJson() const;
     void appendBinary(std::vector<char>& data) const;
-    std::size_t bytes() const;
+    std::size_t bytes() const { return m_bytes; }
 
 private:
     const std::vector<Point>& points() const;
     const std::vector<Color>& colors() const;
     const std::vector<Point>& normals() const;
 
+    std::size_t positionBytes() const;
+    std::size_t colorBytes() const;
+    std::size_t normalBytes() const;
+
     const TileData& m_tileData;
+    const Settings& m_settings;
+
+    // Quantized positions are relative to the extents of this tile's points.
+    Point m_volumeOffset;
+    Point m_volumeScale;
+
+    // Each section of the binary body is aligned to its component size, and
+    // the body as a whole is padded to an 8-byte boundary.
+    std::size_t m_colorOffset;
+    std::size_t m_normalOffset;
+    std::size_t m_bytes;
 };
 
 } // namespace cesium
@@ -19,11 +19,17 @@ Settings::Settings(
         std::size_t tilesetSplit,
         double geometricErrorDivisor,
         std::string coloring,
-        bool truncate)
+        bool truncate,
+        bool quantize,
+        bool octNormals,
+        bool rgb565)
     : m_tilesetSplit(tilesetSplit)
     , m_geometricErrorDivisor(geometricErrorDivisor)
     , m_coloring(coloring)
     , m_truncate(truncate)
+    , m_quantize(quantize)
+    , m_octNormals(octNormals)
+    , m_rgb565(rgb565)
 {
     if (!m_tilesetSplit) m_tilesetSplit = 8;
     if (m_geometricErrorDivisor == 0.0) m_geometricErrorDivisor = 8.0;
@@ -34,7 +40,10 @@ Settings::Settings(const Json::Value& json)
             json["tilesetSplit"].asUInt64(),
             json["geometricErrorDivisor"].asDouble(),
             json["coloring"].asString(),
-            json["truncate"].asBool())
+            json["truncate"].asBool(),
+            json["quantize"].asBool(),
+            json["octNormals"].asBool(),
+            json["rgb565"].asBool())
 { }
 
 Json::Value Settings::toJson() const
@@ -44,6 +53,9 @@ Json::Value Settings::toJson() const
     json["geometricErrorDivisor"] = m_geometricErrorDivisor;
     if (m_coloring.size()) json["coloring"] = m_coloring;
     if (m_truncate) json["truncate"] = true;
+    if (m_quantize) json["quantize"] = true;
+    if (m_octNormals) json["octNormals"] = true;
+    if (m_rgb565) json["rgb565"] = true;
     return json;
 }
 
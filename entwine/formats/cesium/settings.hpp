@@ -26,7 +26,10 @@ public:
             std::size_t tilesetSplit,
             double geometricErrorDivisor,
             std::string coloring,
-            bool truncate);
+            bool truncate,
+            bool quantize = false,
+            bool octNormals = false,
+            bool rgb565 = false);
 
     Settings(const Json::Value& json);
 
@@ -36,12 +39,20 @@ public:
     double geometricErrorDivisor() const { return m_geometricErrorDivisor; }
     const std::string& coloring() const { return m_coloring; }
     bool truncate() const { return m_truncate; }
+    bool quantize() const { return m_quantize; }
+    bool octNormals() const { return m_octNormals; }
+    bool rgb565() const { return m_rgb565; }
 
 private:
     std::size_t m_tilesetSplit;
     double m_geometricErrorDivisor;
     std::string m_coloring;
     bool m_truncate;    // If true, color/intensity should be scaled to 8 bits.
+
+    // Compact feature table encodings, see the 3D Tiles Point Cloud spec.
+    bool m_quantize;    // POSITION_QUANTIZED rather than float32 POSITION.
+    bool m_octNormals;  // NORMAL_OCT16P rather than float32 NORMAL.
+    bool m_rgb565;      // RGB565 rather than RGB.
 };
 
 } // namespace cesium
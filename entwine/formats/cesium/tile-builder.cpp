@@ -42,6 +42,14 @@ TileBuilder::TileBuilder(const Metadata& metadata, const TileInfo& info)
         m_schema.contains("NormalY") &&
         m_schema.contains("NormalZ");
 
+    if (m_hasNormals)
+    {
+        pdal::PointLayout* pl(m_table.layout());
+        m_normalX = pl->findDim("NormalX");
+        m_normalY = pl->findDim("NormalY");
+        m_normalZ = pl->findDim("NormalZ");
+    }
+
     for (const auto& p : info.ticks())
     {
         m_data.emplace(
@@ -111,16 +119,10 @@ void TileBuilder::push(std::size_t rawTick, const Cell& cell)
 
         if (m_hasNormals)
         {
-            pdal::PointLayout *pl = m_table.layout();
-
-            pdal::Dimension::Id normalXDim = pl->findDim("NormalX");
-            pdal::Dimension::Id normalYDim = pl->findDim("NormalY");
-            pdal::Dimension::Id normalZDim = pl->findDim("NormalZ");
-
             selected.normals.emplace_back(
-                m_pr.getFieldAs<double>(normalXDim),
-                m_pr.getFieldAs<double>(normalYDim),
-                m_pr.getFieldAs<double>(normalZDim));
+                m_pr.getFieldAs<double>(m_normalX),
+                m_pr.getFieldAs<double>(m_normalY),
+                m_pr.getFieldAs<double>(m_normalZ));
         }
     }
 }
@@ -66,6 +66,9 @@ private:
     std::size_t m_divisor;
     bool m_hasColor;
     bool m_hasNormals;
+    pdal::Dimension::Id m_normalX = pdal::Dimension::Id::Unknown;
+    pdal::Dimension::Id m_normalY = pdal::Dimension::Id::Unknown;
+    pdal::Dimension::Id m_normalZ = pdal::Dimension::Id::Unknown;
     std::map<std::size_t, Color> m_tileColors;
     std::map<std::size_t, TileData> m_data;
 
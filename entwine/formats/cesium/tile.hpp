@@ -17,6 +17,7 @@
 
 #include <entwine/formats/cesium/batch-table.hpp>
 #include <entwine/formats/cesium/feature-table.hpp>
+#include <entwine/formats/cesium/settings.hpp>
 #include <entwine/formats/cesium/tile-info.hpp>
 #include <entwine/third/arbiter/arbiter.hpp>
 #include <entwine/tree/chunk.hpp>
@@ -45,8 +46,8 @@ public:
 class Tile
 {
 public:
-    Tile(const TileData& tileData)
-        : m_featureTable(tileData)
+    Tile(const TileData& tileData, const Settings& settings)
+        : m_featureTable(tileData, settings)
         , m_batchTable(tileData)
     { }
 
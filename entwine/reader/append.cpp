@@ -0,0 +1,149 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/reader/append.hpp>
+
+#include <iostream>
+#include <limits>
+
+#include <entwine/util/io.hpp>
+
+namespace entwine
+{
+
+AppendWriter::AppendWriter(const std::size_t threads, const Put put)
+    : m_put(put ? put : Put(
+                [](
+                    const arbiter::Endpoint& endpoint,
+                    const std::string& path,
+                    const std::vector<char>& data)
+                {
+                    io::ensurePut(endpoint, path, data);
+                }))
+    // Pending writes are coalesced per path, so the queue is bounded by the
+    // number of distinct appends - don't block callers waiting for space.
+    , m_pool(threads, std::numeric_limits<std::size_t>::max())
+{ }
+
+AppendWriter::~AppendWriter()
+{
+    try
+    {
+        flush();
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "Appended data was lost: " << e.what() << std::endl;
+    }
+}
+
+void AppendWriter::put(
+        const arbiter::Endpoint& endpoint,
+        const std::string& path,
+        std::vector<char> data)
+{
+    const std::string key(endpoint.prefixedRoot() + path);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // If this path is pending, it is already scheduled unless it is being
+        // held after a failure.  If it is being written, the writer will pick
+        // up the new data when it finishes.
+        const bool scheduled(
+                m_active.count(key) ||
+                (m_pending.count(key) && !m_errors.count(key)));
+
+        m_pending[key] = makeUnique<Pending>(endpoint, path, std::move(data));
+        if (scheduled) return;
+    }
+
+    m_pool.add([this, key]() { drain(key); });
+}
+
+void AppendWriter::drain(const std::string& key)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // A retry may race with a drain scheduled by put, in which case the
+    // active one will pick up whatever is pending.
+    if (m_active.count(key)) return;
+    m_active.insert(key);
+
+    auto it(m_pending.find(key));
+    while (it != m_pending.end())
+    {
+        std::unique_ptr<Pending> pending(std::move(it->second));
+        m_pending.erase(it);
+        lock.unlock();
+
+        std::string error;
+
+        try
+        {
+            m_put(pending->endpoint, pending->path, pending->data);
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+        }
+        catch (...)
+        {
+            error = "Unknown error";
+        }
+
+        lock.lock();
+        it = m_pending.find(key);
+
+        if (error.empty())
+        {
+            m_errors.erase(key);
+        }
+        else
+        {
+            m_errors[key] = pending->path + ": " + error;
+
+            // Newer data supersedes what failed to be written.  Otherwise,
+            // hold on to this data for the next flush.
+            if (it == m_pending.end())
+            {
+                m_pending[key] = std::move(pending);
+                break;
+            }
+        }
+    }
+
+    m_active.erase(key);
+}
+
+void AppendWriter::flush()
+{
+    std::vector<std::string> retries;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& p : m_errors)
+        {
+            if (m_pending.count(p.first)) retries.push_back(p.first);
+        }
+    }
+
+    for (const auto& key : retries) m_pool.add([this, key]() { drain(key); });
+    m_pool.await();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_errors.empty()) return;
+
+    throw std::runtime_error(
+            "Failed to write " + std::to_string(m_errors.size()) +
+            " append(s), including " + m_errors.begin()->second);
+}
+
+} // namespace entwine
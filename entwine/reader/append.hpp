@@ -10,79 +10,266 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <entwine/third/arbiter/arbiter.hpp>
 #include <entwine/types/defs.hpp>
 #include <entwine/types/schema.hpp>
-#include <entwine/types/vector-point-table.hpp>
-#include <entwine/util/io.hpp>
+#include <entwine/util/mapped-file.hpp>
+#include <entwine/util/pool.hpp>
+#include <entwine/util/unique.hpp>
 
 namespace entwine
 {
 
+// Writes appended-dimension data in the background, so that neither cache
+// eviction nor write queries wait on uploads.  Each submission is the full
+// contents of an append file, so writes to the same path are coalesced: if a
+// newer version is submitted while an older one is still pending, only the
+// newest is written.  Writes to a single path are never concurrent.
+//
+// If a write fails and nothing newer has been submitted for its path, its
+// data is kept and retried by the next flush.
+class AppendWriter
+{
+public:
+    using Put = std::function<void(
+            const arbiter::Endpoint& endpoint,
+            const std::string& path,
+            const std::vector<char>& data)>;
+
+    // Writes are performed by io::ensurePut unless another put is given.
+    AppendWriter(std::size_t threads = 4, Put put = Put());
+
+    // Waits for all pending writes.
+    ~AppendWriter();
+
+    void put(
+            const arbiter::Endpoint& endpoint,
+            const std::string& path,
+            std::vector<char> data);
+
+    // Block until everything submitted so far has been written, retrying
+    // previously failed writes.  Throws if the latest data for any path
+    // could not be written, in which case that data is kept for the next
+    // flush.
+    void flush();
+
+private:
+    struct Pending
+    {
+        Pending(
+                const arbiter::Endpoint& endpoint,
+                const std::string& path,
+                std::vector<char> data)
+            : endpoint(endpoint)
+            , path(path)
+            , data(std::move(data))
+        { }
+
+        const arbiter::Endpoint endpoint;
+        const std::string path;
+        std::vector<char> data;
+    };
+
+    void drain(const std::string& key);
+
+    const Put m_put;
+
+    std::map<std::string, std::unique_ptr<Pending>> m_pending;
+    std::set<std::string> m_active;
+
+    // Keyed by path, the error of the latest write if it failed.
+    std::map<std::string, std::string> m_errors;
+    std::mutex m_mutex;
+
+    Pool m_pool;
+};
+
+// A point-offset within a chunk, and the data to be written there.
+using AppendBatch = std::vector<std::pair<std::size_t, const char*>>;
+
+// The data of an appended-dimension set for a single chunk, stored at
+// d/<name>/<chunkId> as packed points in the schema of the set, in the same
+// order as the points of the chunk.
+//
+// Local files are memory-mapped and accessed in place, so only the pages
+// which are actually touched are read, and modifications are written through
+// to the file.  Remote files are fetched in full and written back by the
+// AppendWriter.
 class Append
 {
 public:
+    // If create is false, then no data is allocated for a nonexistent append,
+    // in which case exists() is false.
     Append(
             const arbiter::Endpoint& ep,
+            AppendWriter& writer,
             std::string name,
             const Schema& schema,
             const Id& id,
-            std::size_t numPoints)
+            std::size_t numPoints,
+            bool create = true)
         : m_ep(ep)
+        , m_writer(writer)
         , m_filename("d/" + name + "/" + id.str())
         , m_schema(schema.filter("Omit"))
-        , m_dimTypeList(m_schema.pdalLayout().dimTypes())
-        , m_table(m_schema, numPoints)
     {
-        if (m_ep.tryGetSize(m_filename))
+        const std::size_t size(numPoints * m_schema.pointSize());
+
+        if (m_ep.isLocal())
+        {
+            const auto local(arbiter::fs::expandTilde(m_ep.fullPath("d/")));
+            if (create) arbiter::fs::mkdirp(local + name);
+
+            m_mapped = MappedFile::create(
+                    local + name + "/" + id.str(),
+                    create ? size : 0);
+        }
+
+        if (!m_mapped)
         {
-            m_table.data() = m_ep.getBinary(m_filename);
+            if (m_ep.tryGetSize(m_filename))
+            {
+                m_data = m_ep.getBinary(m_filename);
+            }
+
+            if (m_data.empty() && create) m_data.resize(size, 0);
         }
     }
 
     static std::unique_ptr<Append> maybeCreate(
             const arbiter::Endpoint& ep,
+            AppendWriter& writer,
             std::string name,
             const Schema& schema,
             const Id& id,
             std::size_t numPoints)
     {
-        auto a(makeUnique<Append>(ep, name, schema, id, numPoints));
-        if (a->table().data().size()) return a;
+        auto a(
+                makeUnique<Append>(
+                    ep, writer, name, schema, id, numPoints, false));
+
+        if (a->exists()) return a;
         else return nullptr;
     }
 
-    void insert(const pdal::PointRef& pr, std::size_t offset)
+    bool exists() const { return m_mapped || !m_data.empty(); }
+    std::size_t size() const
     {
-        m_touched = true;
-        pr.getPackedData(m_dimTypeList, m_table.getPoint(offset));
+        return (m_mapped ? m_mapped->size() : m_data.size()) /
+            m_schema.pointSize();
     }
 
-    void write() const
+    // Data for the point at this offset within the chunk.
+    const char* point(std::size_t offset) const
     {
-        if (m_touched)
+        if (offset >= size())
         {
-            std::cout << "Writing " << m_filename << std::endl;
-            io::ensurePut(m_ep, m_filename, m_table.data());
+            throw std::out_of_range("Invalid append offset");
         }
+
+        return data() + offset * m_schema.pointSize();
+    }
+
+    // The batch data is laid out according to the source schema, which must
+    // contain all of our dimensions with matching types.  Data is copied a
+    // dimension at a time rather than a point at a time.
+    void insert(const Schema& source, const AppendBatch& batch)
+    {
+        if (batch.empty()) return;
+
+        const std::size_t pointSize(m_schema.pointSize());
+        const std::size_t numPoints(size());
+        const pdal::PointLayout& srcLayout(source.pdalLayout());
+        const pdal::PointLayout& dstLayout(m_schema.pdalLayout());
+
+        for (const auto& p : batch)
+        {
+            if (p.first >= numPoints)
+            {
+                throw std::out_of_range("Invalid append offset");
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        char* const dst(data());
+
+        for (const DimInfo& dim : m_schema.dims())
+        {
+            const std::size_t srcOffset(
+                    srcLayout.dimDetail(source.getId(dim.name()))->offset());
+            const std::size_t dstOffset(
+                    dstLayout.dimDetail(m_schema.getId(dim.name()))->offset());
+            const std::size_t size(dim.size());
+
+            for (const auto& p : batch)
+            {
+                const char* src(p.second + srcOffset);
+                char* pos(dst + p.first * pointSize + dstOffset);
+                std::copy(src, src + size, pos);
+            }
+        }
+
+        m_dirty = true;
+    }
+
+    // Persist any modifications since the last write.  Mapped data is synced
+    // to its file, and otherwise a copy of the data is handed to the writer.
+    // If this append is being discarded, the data is handed off rather than
+    // copied, and mapped data is left for the system to write back, after
+    // which this append may not be used.
+    void write(bool discard = false)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty) return;
+
+        if (m_mapped)
+        {
+            if (!discard) m_mapped->sync();
+        }
+        else if (discard)
+        {
+            m_writer.put(m_ep, m_filename, std::move(m_data));
+        }
+        else
+        {
+            m_writer.put(m_ep, m_filename, m_data);
+        }
+
+        m_dirty = false;
     }
 
     const Schema& schema() const { return m_schema; }
-    VectorPointTable& table() { return m_table; }
-    const VectorPointTable& table() const { return m_table; }
 
 private:
+    char* data() { return m_mapped ? m_mapped->data() : m_data.data(); }
+    const char* data() const
+    {
+        return m_mapped ? m_mapped->data() : m_data.data();
+    }
+
     const arbiter::Endpoint m_ep;
+    AppendWriter& m_writer;
     const std::string m_filename;
 
     const Schema m_schema;
-    const pdal::DimTypeList m_dimTypeList;
 
-    mutable VectorPointTable m_table;
-    bool m_touched = false;
+    std::unique_ptr<MappedFile> m_mapped;
+    std::vector<char> m_data;
+
+    bool m_dirty = false;
+    std::mutex m_mutex;
 };
 
 } // namespace entwine
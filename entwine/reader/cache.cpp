@@ -107,11 +107,30 @@ void Cache::release(const Reader& reader)
     m_cv.notify_all();
 }
 
+void Cache::flush(const Reader& reader)
+{
+    // Chunk readers are only assigned or destroyed while holding the global
+    // lock, so they can't change out from under us here.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_chunkManager.count(reader.path())) return;
+
+    for (const auto& p : m_chunkManager.at(reader.path()))
+    {
+        if (const auto& chunkReader = p.second->chunkReader)
+        {
+            chunkReader->chunk().writeAppends();
+        }
+    }
+}
+
 std::unique_ptr<Block> Cache::acquire(
         const std::string& readerPath,
-        const FetchInfoSet& fetches)
+        const FetchInfoSet& fetches,
+        QueryTrace* trace)
 {
+    const TraceTime start(TraceClock::now());
     std::unique_ptr<Block> block(reserve(readerPath, fetches));
+    m_stats.add(QueryStage::Reserve, start, TraceClock::now(), trace);
 
     bool success(true);
     std::mutex mutex;
@@ -119,9 +138,9 @@ std::unique_ptr<Block> Cache::acquire(
 
     for (const auto& f : fetches)
     {
-        pool.add([this, &readerPath, &f, &block, &mutex, &success]()->void
+        pool.add([this, &readerPath, &f, &block, &mutex, &success, trace]()
         {
-            if (const ColdChunkReader* chunkReader = fetch(readerPath, f))
+            if (const auto* chunkReader = fetch(readerPath, f, trace))
             {
                 std::lock_guard<std::mutex> lock(mutex);
                 block->set(f.id, chunkReader);
@@ -183,7 +202,10 @@ void Cache::release(const Block& block)
         const GlobalChunkInfo& toRemove(m_inactiveList.back());
 
         LocalManager& localManager(m_chunkManager.at(toRemove.path));
-        m_activeBytes -= localManager.at(toRemove.id)->chunkReader->size();
+        const std::size_t size(
+                localManager.at(toRemove.id)->chunkReader->size());
+        m_activeBytes -= size;
+        m_stats.evict(size);
         localManager.erase(toRemove.id);
 
         if (localManager.empty()) m_chunkManager.erase(toRemove.path);
@@ -248,8 +270,11 @@ std::unique_ptr<Block> Cache::reserve(
 
 const ColdChunkReader* Cache::fetch(
         const std::string& readerPath,
-        const FetchInfo& fetchInfo)
+        const FetchInfo& fetchInfo,
+        QueryTrace* trace)
 {
+    const TraceTime start(TraceClock::now());
+
     std::unique_lock<std::mutex> globalLock(m_mutex);
     DataChunkState& chunkState(*m_chunkManager.at(readerPath).at(fetchInfo.id));
     globalLock.unlock();
@@ -262,22 +287,43 @@ const ColdChunkReader* Cache::fetch(
         const Metadata& metadata(reader.metadata());
         const std::string path(metadata.basename(fetchInfo.id));
 
-        chunkState.chunkReader = makeUnique<ColdChunkReader>(
-                metadata,
-                reader.endpoint(),
-                reader.tmp(),
-                fetchInfo.bounds,
-                reader.pool(),
-                fetchInfo.id,
-                fetchInfo.depth);
+        auto chunkReader(
+                makeUnique<ColdChunkReader>(
+                    metadata,
+                    reader.endpoint(),
+                    reader.tmp(),
+                    fetchInfo.bounds,
+                    reader.pool(),
+                    fetchInfo.id,
+                    fetchInfo.depth));
+
+        const TraceTime end(TraceClock::now());
+        m_stats.add(QueryStage::Fetch, start, end, trace);
+        m_stats.add(
+                QueryStage::Sort,
+                end - chunkReader->sortTime(),
+                end,
+                trace);
+        m_stats.miss(chunkReader->size());
 
         globalLock.lock();
+        chunkState.chunkReader = std::move(chunkReader);
         m_activeBytes += chunkState.chunkReader->size();
     }
+    else m_stats.hit();
 
     return chunkState.chunkReader.get();
 }
 
+Json::Value Cache::stats() const
+{
+    Json::Value json(m_stats.toJson());
+    json["maxBytes"] = Json::UInt64(m_maxBytes);
+    json["activeBytes"] = Json::UInt64(m_activeBytes);
+    json["hierarchyBytes"] = Json::UInt64(m_hierarchyBytes);
+    return json;
+}
+
 void Cache::refHierarchySlot(
         const std::string& name,
         const HierarchyReader::Slot* slot)
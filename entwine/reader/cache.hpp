@@ -21,6 +21,7 @@
 #include <string>
 
 #include <entwine/reader/hierarchy-reader.hpp>
+#include <entwine/reader/trace.hpp>
 #include <entwine/types/structure.hpp>
 #include <entwine/third/arbiter/arbiter.hpp>
 
@@ -125,9 +126,12 @@ class Cache
 public:
     Cache(std::size_t maxBytes);
 
+    // If a trace is given, the reservation and any fetches are recorded to
+    // it.
     std::unique_ptr<Block> acquire(
             const std::string& readerPath,
-            const FetchInfoSet& fetches);
+            const FetchInfoSet& fetches,
+            QueryTrace* trace = nullptr);
 
     void refHierarchySlot(
             const std::string& name,
@@ -140,8 +144,19 @@ public:
     std::size_t maxBytes() const { return m_maxBytes; }
     std::size_t activeBytes() const { return m_activeBytes; }
 
+    // Query latency histograms and chunk hit/miss counters for all readers
+    // of this cache, along with its current usage.
+    Json::Value stats() const;
+    void clearStats() { m_stats.clear(); }
+
+    QueryStats& queryStats() { return m_stats; }
+
     void release(const Reader& reader);
 
+    // Submit the modified appends of this reader's cached chunks to its
+    // writer.
+    void flush(const Reader& reader);
+
 private:
     void release(const Block& block);
 
@@ -151,7 +166,8 @@ private:
 
     const ColdChunkReader* fetch(
             const std::string& readerPath,
-            const FetchInfo& fetchInfo);
+            const FetchInfo& fetchInfo,
+            QueryTrace* trace);
 
     const std::size_t m_maxBytes;
     const std::size_t m_maxHierarchyBytes;
@@ -166,6 +182,8 @@ private:
 
     std::mutex m_mutex;
     std::condition_variable m_cv;
+
+    QueryStats m_stats;
 };
 
 } // namespace entwine
@@ -134,7 +134,7 @@ void ChunkReader::initLegacyBase(const arbiter::Endpoint& tmp)
 ChunkReader::~ChunkReader()
 {
     m_pool.release(std::move(m_cells));
-    for (const auto& p : m_appends) p.second->write();
+    for (const auto& p : m_appends) p.second->write(true);
 }
 
 ColdChunkReader::ColdChunkReader(
@@ -162,7 +162,10 @@ ColdChunkReader::ColdChunkReader(
         ++offset;
     }
 
+    const auto start(std::chrono::steady_clock::now());
     std::sort(m_points.begin(), m_points.end());
+    m_sortTime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
 }
 
 ColdChunkReader::QueryRange ColdChunkReader::candidates(const Bounds& qb) const
@@ -11,9 +11,13 @@
 #pragma once
 
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <string>
 #include <vector>
 
 #include <entwine/reader/append.hpp>
@@ -60,13 +64,17 @@ public:
     const Cell::PooledStack& cells() const { return m_cells; }
     const std::vector<std::size_t> offsets() const { return m_offsets; }
 
-    Append& getOrCreateAppend(std::string name, const Schema& s) const
+    Append& getOrCreateAppend(
+            std::string name,
+            const Schema& s,
+            AppendWriter& writer) const
     {
         std::lock_guard<std::mutex> lock(m);
         if (!m_appends.count(name))
         {
             auto append = makeUnique<Append>(
                     m_endpoint,
+                    writer,
                     name,
                     s,
                     m_id,
@@ -76,18 +84,35 @@ public:
         return *m_appends.at(name);
     }
 
-    Append* findAppend(const std::string name, const Schema& s) const
+    Append* findAppend(
+            const std::string name,
+            const Schema& s,
+            AppendWriter& writer) const
     {
         std::lock_guard<std::mutex> lock(m);
         if (m_appends.count(name)) return m_appends.at(name).get();
 
+        // Don't look for the same nonexistent append on every query.  If it
+        // is written later, it will be created by getOrCreateAppend.
+        if (m_missingAppends.count(name)) return nullptr;
+
         const auto np(m_cells.size());
-        if (auto a = Append::maybeCreate(m_endpoint, name, s, m_id, np))
+        const auto& ep(m_endpoint);
+        if (auto a = Append::maybeCreate(ep, writer, name, s, m_id, np))
         {
             m_appends[name] = std::move(a);
             return m_appends.at(name).get();
         }
-        else return nullptr;
+
+        m_missingAppends.insert(name);
+        return nullptr;
+    }
+
+    // Persist any modified appends.
+    void writeAppends() const
+    {
+        std::lock_guard<std::mutex> lock(m);
+        for (const auto& p : m_appends) p.second->write();
     }
 
 protected:
@@ -106,6 +131,7 @@ protected:
 
     mutable std::mutex m;
     mutable std::map<std::string, std::unique_ptr<Append>> m_appends;
+    mutable std::set<std::string> m_missingAppends;
 };
 
 class PointInfo
@@ -171,9 +197,13 @@ public:
     ChunkReader& chunk() { return m_chunk; }
     ChunkReader& chunk() const { return m_chunk; }
 
+    // Time spent sorting the points, which is the last step of construction.
+    std::chrono::nanoseconds sortTime() const { return m_sortTime; }
+
 private:
     mutable ChunkReader m_chunk;
     TubeData m_points;
+    std::chrono::nanoseconds m_sortTime;
 };
 
 class BaseChunkReader
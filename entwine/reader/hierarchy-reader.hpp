@@ -27,11 +27,10 @@ class HierarchyReader : public Hierarchy
 {
 public:
     HierarchyReader(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const arbiter::Endpoint& top,
             Cache& cache)
-        : Hierarchy(pool, metadata, top, nullptr, true, true)
+        : Hierarchy(metadata, top, nullptr, true, true)
         , m_cache(cache)
     { }
 
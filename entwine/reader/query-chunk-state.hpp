@@ -11,6 +11,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 #include <entwine/types/bounds.hpp>
 #include <entwine/types/defs.hpp>
@@ -28,6 +29,11 @@ public:
         , m_depth(m_structure.nominalChunkDepth())
         , m_chunkId(m_structure.nominalChunkIndex())
         , m_pointsPerChunk(m_structure.basePointsPerChunk())
+        , m_position(
+                ((m_chunkId -
+                    ChunkInfo::calcLevelIndex(
+                        m_structure.dimensions(),
+                        m_depth)) / m_pointsPerChunk).getSimple())
     { }
 
     bool allDirections() const
@@ -49,6 +55,8 @@ public:
         result.m_chunkId <<= m_structure.dimensions();
         ++result.m_chunkId.data().front();
         result.m_chunkId += toIntegral(dir) * m_pointsPerChunk;
+        result.m_position =
+            m_position * m_structure.factor() + toIntegral(dir);
 
         return result;
     }
@@ -70,6 +78,9 @@ public:
     const Id& chunkId() const { return m_chunkId; }
     const Id& pointsPerChunk() const { return m_pointsPerChunk; }
 
+    // Position of this chunk within its depth, see ChunkIndex.
+    uint64_t position() const { return m_position; }
+
 private:
     QueryChunkState(const QueryChunkState& other) = default;
 
@@ -79,6 +90,7 @@ private:
 
     Id m_chunkId;
     Id m_pointsPerChunk;
+    uint64_t m_position;
 };
 
 } // namespace entwine
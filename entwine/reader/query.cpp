@@ -102,11 +102,22 @@ Query::Query(const Reader& reader, const QueryParams& p)
 {
     if (!m_depthEnd || m_depthEnd > m_structure.coldDepthBegin())
     {
+        const TraceTime start(TraceClock::now());
         QueryChunkState chunkState(m_structure, m_metadata.boundsScaledCubic());
         getFetches(chunkState);
+        record(QueryStage::Traverse, start);
     }
 }
 
+void Query::record(const QueryStage stage, const TraceTime start)
+{
+    m_reader.cache().queryStats().add(
+            stage,
+            start,
+            TraceClock::now(),
+            &m_trace);
+}
+
 void Query::getFetches(const QueryChunkState& c)
 {
     if (!m_filter.check(c.bounds())) return;
@@ -147,6 +158,8 @@ bool Query::next()
 
             if (m_reader.base())
             {
+                const TraceTime start(TraceClock::now());
+
                 if (m_depthBegin < m_structure.baseDepthEnd())
                 {
                     chunk(m_reader.base()->chunk());
@@ -154,12 +167,17 @@ bool Query::next()
 
                 PointState ps(m_structure, m_metadata.boundsScaledCubic());
                 getBase(ps);
+                chunkDone();
+                record(QueryStage::Process, start);
+
                 m_done = m_chunks.empty();
             }
         }
         else getChunked();
     }
 
+    if (m_done) record(QueryStage::Query, m_trace.begin());
+
     return !m_done;
 }
 
@@ -198,7 +216,7 @@ void Query::maybeAcquire()
     std::advance(end, std::min(fetchesPerIteration, m_chunks.size()));
 
     FetchInfoSet fetches(begin, end);
-    m_block = m_reader.cache().acquire(m_reader.path(), fetches);
+    m_block = m_reader.cache().acquire(m_reader.path(), fetches, &m_trace);
     m_chunks.erase(begin, end);
 
     if (m_block) m_chunkReaderIt = m_block->chunkMap().begin();
@@ -212,6 +230,7 @@ void Query::getChunked()
     {
         if (const ColdChunkReader* cr = m_chunkReaderIt->second)
         {
+            const TraceTime start(TraceClock::now());
             chunk(cr->chunk());
 
             ColdChunkReader::QueryRange range(cr->candidates(m_bounds));
@@ -223,6 +242,9 @@ void Query::getChunked()
                 ++it;
             }
 
+            chunkDone();
+            record(QueryStage::Process, start);
+
             if (++m_chunkReaderIt == m_block->chunkMap().end())
             {
                 m_block.reset();
@@ -287,7 +309,11 @@ void ReadQuery::chunk(const ChunkReader& cr)
         {
             const auto appendName(m_reader.findAppendName(d.info().name()));
             const Schema& appendSchema(m_reader.appendAt(appendName));
-            d.setAppend(cr.findAppend(appendName, appendSchema));
+            d.setAppend(
+                    cr.findAppend(
+                        appendName,
+                        appendSchema,
+                        m_reader.appendWriter()));
         }
     }
 }
@@ -311,10 +337,9 @@ void ReadQuery::process(const PointInfo& info)
         {
             m_pointRef.getField(pos, dimInfo.id(), dimInfo.type());
         }
-        else if (Append* append = dim.append())
+        else if (dim.append())
         {
-            auto pr(append->table().at(info.offset()));
-            pr.getField(pos, dimInfo.id(), dimInfo.type());
+            dim.getAppended(info.offset(), pos);
         }
 
         pos += dimInfo.size();
@@ -323,18 +348,27 @@ void ReadQuery::process(const PointInfo& info)
 
 void WriteQuery::chunk(const ChunkReader& cr)
 {
-    m_append = &cr.getOrCreateAppend(m_name, m_schema);
+    AppendWriter& writer(m_reader.appendWriter());
+    m_append = &cr.getOrCreateAppend(m_name, m_schema, writer);
 }
 
 void WriteQuery::process(const PointInfo& info)
 {
-    m_table.setPoint(m_pos);
+    const char* pos(m_pos);
+    m_table.setPoint(pos);
     m_pos += m_schema.pointSize();
 
     if (m_pos > m_end) throw std::runtime_error("Invalid point count written");
 
     if (m_pr.getFieldAs<bool>(pdal::Dimension::Id::Omit)) return;
-    m_append->insert(m_pr, info.offset());
+    m_batch.emplace_back(info.offset(), pos);
+}
+
+void WriteQuery::chunkDone()
+{
+    if (m_append) m_append->insert(m_schema, m_batch);
+    m_append = nullptr;
+    m_batch.clear();
 }
 
 } // namespace entwine
@@ -21,6 +21,7 @@
 #include <entwine/reader/filter.hpp>
 #include <entwine/reader/query-chunk-state.hpp>
 #include <entwine/reader/query-params.hpp>
+#include <entwine/reader/trace.hpp>
 #include <entwine/types/binary-point-table.hpp>
 #include <entwine/types/delta.hpp>
 #include <entwine/types/dir.hpp>
@@ -49,10 +50,18 @@ public:
     bool done() const { return m_done; }
     std::size_t numPoints() const { return m_numPoints; }
 
+    // Timeline of this query so far.  Its stages are also recorded into the
+    // global statistics of the reader's cache.
+    const QueryTrace& trace() const { return m_trace; }
+
 protected:
     virtual void process(const PointInfo& info) = 0;
     virtual void chunk(const ChunkReader& cr) { }
 
+    // Called after the points of the chunk most recently passed to chunk()
+    // have been processed, while that chunk is still held.
+    virtual void chunkDone() { }
+
     void getFetches(const QueryChunkState& c);
     void getBase(const PointState& pointState);
     void getChunked();
@@ -76,6 +85,9 @@ private:
     Delta localize(const Delta& out) const;
     Bounds localize(const Bounds& bounds, const Delta& localDelta) const;
 
+    void record(QueryStage stage, TraceTime start);
+
+    QueryTrace m_trace;
     FetchInfoSet m_chunks;
     std::unique_ptr<Block> m_block;
     ChunkMap::const_iterator m_chunkReaderIt;
@@ -127,11 +139,25 @@ public:
     void setAppend(Append* a) { m_append = a; }
     Append* append() const { return m_append; }
 
+    // Reads from the append are done in place, through a point table over
+    // the append's schema.
+    void getAppended(std::size_t offset, char* dst) const
+    {
+        if (!m_appendTable)
+        {
+            m_appendTable = makeUnique<BinaryPointTable>(m_schema);
+        }
+
+        m_appendTable->setPoint(m_append->point(offset));
+        m_appendTable->ref().getField(dst, m_dim.id(), m_dim.type());
+    }
+
 private:
     const Schema& m_schema;
     const DimInfo m_dim;
     const bool m_native;
     mutable Append* m_append = nullptr;
+    mutable std::unique_ptr<BinaryPointTable> m_appendTable;
 };
 
 class RegisteredSchema
@@ -263,6 +289,7 @@ public:
 protected:
     virtual void process(const PointInfo& info) override;
     virtual void chunk(const ChunkReader& cr) override;
+    virtual void chunkDone() override;
 
 private:
     const std::string m_name;
@@ -270,7 +297,9 @@ private:
     BinaryPointTable m_table;
     pdal::PointRef m_pr;
 
+    // Points of the current chunk, which are written to its append together.
     Append* m_append = nullptr;
+    AppendBatch m_batch;
 
     const char* m_pos;
     const char* m_end;
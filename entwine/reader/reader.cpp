@@ -66,8 +66,6 @@ namespace
         }
     }
 
-    HierarchyCell::Pool hierarchyPool(4096);
-
     const std::size_t basePoolBlockSize(65536);
 }
 
@@ -80,7 +78,6 @@ Reader::Reader(const std::string path, const std::string tmp, Cache& cache)
     , m_cache(cache)
     , m_hierarchy(
             makeUnique<HierarchyReader>(
-                hierarchyPool,
                 m_metadata,
                 m_endpoint,
                 m_cache))
@@ -100,7 +97,6 @@ Reader::Reader(
     , m_cache(cache)
     , m_hierarchy(
             makeUnique<HierarchyReader>(
-                hierarchyPool,
                 m_metadata,
                 m_endpoint,
                 m_cache))
@@ -124,36 +120,20 @@ void Reader::init()
 
     if (structure.hasCold())
     {
-        m_threadPool.add([&]()
-        {
-            const auto ids(extractIds(m_endpoint.get("entwine-ids")));
-            if (ids.empty()) return;
-
-            std::size_t depth(ChunkInfo::calcDepth(4, ids.front()));
-            Id nextDepthIndex(ChunkInfo::calcLevelIndex(2, depth + 1));
+        m_chunks = ChunkIndex::tryCreate(structure, m_endpoint);
 
-            m_ids.resize(ChunkInfo::calcDepth(4, ids.back()) + 1);
-
-            for (const auto& id : ids)
+        if (m_chunks) m_ready = true;
+        else
+        {
+            // Builds which predate the binary chunk index have a JSON list of
+            // chunk IDs, which can be slow to parse.
+            m_threadPool.add([&]()
             {
-                if (id >= nextDepthIndex)
-                {
-                    ++depth;
-                    nextDepthIndex <<= structure.dimensions();
-                    ++nextDepthIndex;
-                }
-
-                if (ChunkInfo::calcDepth(4, id) != depth)
-                {
-                    throw std::runtime_error("Invalid depth");
-                }
-
-                m_ids.at(depth).push_back(id);
-            }
-
-            std::cout << m_endpoint.prefixedRoot() << " ready" << std::endl;
-            m_ready = true;
-        });
+                m_chunks = ChunkIndex::create(structure, m_endpoint);
+                std::cout << m_endpoint.prefixedRoot() << " ready" << std::endl;
+                m_ready = true;
+            });
+        }
     }
 
     if (m_endpoint.tryGetSize("d/dimensions.json"))
@@ -262,15 +242,20 @@ std::size_t Reader::write(
     return writeQuery.numPoints();
 }
 
+void Reader::flush()
+{
+    if (m_base) m_base->chunk().writeAppends();
+    m_cache.flush(*this);
+    m_appendWriter.flush();
+}
+
 Reader::~Reader() { m_cache.release(*this); }
 
 bool Reader::exists(const QueryChunkState& c) const
 {
     if (m_ready)
     {
-        if (c.depth() >= m_ids.size()) return false;
-        const auto& slice(m_ids[c.depth()]);
-        return std::binary_search(slice.begin(), slice.end(), c.chunkId());
+        return m_chunks->exists(c.depth(), c.position());
     }
     else
     {
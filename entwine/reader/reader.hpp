@@ -10,6 +10,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <list>
 #include <memory>
@@ -18,6 +19,7 @@
 #include <vector>
 
 #include <entwine/reader/query.hpp>
+#include <entwine/tree/chunk-index.hpp>
 #include <entwine/tree/hierarchy.hpp>
 #include <entwine/types/file-info.hpp>
 #include <entwine/types/metadata.hpp>
@@ -100,11 +102,17 @@ public:
     }
 
     void registerAppend(std::string name, Schema schema);
+
+    // Appended data is written in the background as its chunks leave the
+    // cache.  Call flush() to make sure that everything written so far has
+    // been persisted.
     std::size_t write(
             std::string name,
             const std::vector<char>& data,
             const Json::Value& query);
 
+    void flush();
+
     // Hierarchy query.
     Json::Value hierarchy(
             const Bounds& qbox,
@@ -137,6 +145,7 @@ public:
     const Metadata& metadata() const { return m_metadata; }
     Cache& cache() const { return m_cache; }
     PointPool& pool() const { return m_pool; }
+    AppendWriter& appendWriter() const { return m_appendWriter; }
     std::string path() const { return m_endpoint.root(); }
 
     const BaseChunkReader* base() const { return m_base.get(); }
@@ -200,14 +209,17 @@ private:
     mutable PointPool m_pool;
     Cache& m_cache;
 
+    // Declared ahead of the chunk readers, which submit their appends as they
+    // are destroyed.
+    mutable AppendWriter m_appendWriter;
+
     std::unique_ptr<HierarchyReader> m_hierarchy;
     std::unique_ptr<BaseChunkReader> m_base;
 
-    // Outer vector is organized by depth.
-    std::vector<std::vector<Id>> m_ids;
+    std::unique_ptr<ChunkIndex> m_chunks;
 
     Pool m_threadPool;
-    bool m_ready = false;
+    std::atomic_bool m_ready { false };
 
     mutable std::mutex m_mutex;
     mutable std::map<Id, bool> m_pre;
@@ -0,0 +1,218 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/reader/trace.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace entwine
+{
+
+namespace
+{
+    const std::size_t numStages(static_cast<std::size_t>(QueryStage::End));
+
+    double toSeconds(const uint64_t ns) { return ns / 1000000000.0; }
+
+    double toSeconds(const TraceClock::duration d)
+    {
+        return std::chrono::duration<double>(d).count();
+    }
+}
+
+std::string toString(const QueryStage stage)
+{
+    switch (stage)
+    {
+        case QueryStage::Traverse:  return "traverse";
+        case QueryStage::Reserve:   return "reserve";
+        case QueryStage::Fetch:     return "fetch";
+        case QueryStage::Sort:      return "sort";
+        case QueryStage::Process:   return "process";
+        case QueryStage::Query:     return "query";
+        default:                    break;
+    }
+
+    throw std::runtime_error("Invalid query stage");
+}
+
+std::size_t Histogram::bucket(const uint64_t ns)
+{
+    if (ns < 8) return ns;
+
+    std::size_t msb(3);
+    while (ns >> (msb + 1)) ++msb;
+
+    const std::size_t sub((ns >> (msb - 3)) & 7);
+    return (msb - 2) * 8 + sub;
+}
+
+uint64_t Histogram::mid(const std::size_t b)
+{
+    if (b < 8) return b;
+
+    const std::size_t shift(b / 8 - 1);
+    const uint64_t lower(static_cast<uint64_t>(8 + b % 8) << shift);
+    return lower + ((1ull << shift) >> 1);
+}
+
+void Histogram::add(const std::chrono::nanoseconds elapsed)
+{
+    const uint64_t ns(std::max<int64_t>(elapsed.count(), 0));
+
+    ++m_buckets[bucket(ns)];
+    ++m_count;
+    m_total += ns;
+
+    uint64_t max(m_max);
+    while (ns > max && !m_max.compare_exchange_weak(max, ns)) { }
+}
+
+void Histogram::clear()
+{
+    for (auto& b : m_buckets) b = 0;
+    m_count = 0;
+    m_total = 0;
+    m_max = 0;
+}
+
+double Histogram::percentile(const double p) const
+{
+    const uint64_t count(m_count);
+    if (!count) return 0;
+
+    const uint64_t target(
+            std::max<uint64_t>(std::ceil(std::min(p, 1.0) * count), 1));
+
+    uint64_t seen(0);
+    for (std::size_t i(0); i < numBuckets; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= target)
+        {
+            return toSeconds(std::min<uint64_t>(mid(i), m_max));
+        }
+    }
+
+    return toSeconds(m_max);
+}
+
+Json::Value Histogram::toJson() const
+{
+    Json::Value json;
+    const uint64_t count(m_count);
+
+    json["count"] = Json::UInt64(count);
+    json["seconds"] = toSeconds(m_total);
+    json["mean"] = count ? toSeconds(m_total) / count : 0.0;
+    json["p50"] = percentile(0.5);
+    json["p90"] = percentile(0.9);
+    json["p99"] = percentile(0.99);
+    json["max"] = toSeconds(m_max);
+
+    return json;
+}
+
+void QueryTrace::add(
+        const QueryStage stage,
+        const TraceTime start,
+        const TraceTime end)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_spans.emplace_back(
+            stage,
+            toSeconds(start - m_begin),
+            toSeconds(end - start));
+}
+
+std::vector<QueryTrace::Span> QueryTrace::spans() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_spans;
+}
+
+Json::Value QueryTrace::toJson() const
+{
+    Json::Value json;
+
+    for (std::size_t i(0); i < numStages; ++i)
+    {
+        const std::string name(toString(static_cast<QueryStage>(i)));
+        Json::Value& stage(json["stages"][name]);
+        stage["count"] = 0;
+        stage["seconds"] = 0.0;
+    }
+
+    Json::Value& spans(json["spans"]);
+    spans = Json::arrayValue;
+
+    for (const Span& s : this->spans())
+    {
+        const std::string name(toString(s.stage));
+
+        Json::Value& stage(json["stages"][name]);
+        stage["count"] = stage["count"].asUInt64() + 1;
+        stage["seconds"] = stage["seconds"].asDouble() + s.seconds;
+
+        Json::Value& span(spans.append(Json::objectValue));
+        span["stage"] = name;
+        span["start"] = s.start;
+        span["seconds"] = s.seconds;
+    }
+
+    return json;
+}
+
+void QueryStats::add(
+        const QueryStage stage,
+        const TraceTime start,
+        const TraceTime end,
+        QueryTrace* trace)
+{
+    m_histograms.at(static_cast<std::size_t>(stage)).add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start));
+
+    if (trace) trace->add(stage, start, end);
+}
+
+void QueryStats::clear()
+{
+    for (auto& h : m_histograms) h.clear();
+    m_hits = 0;
+    m_misses = 0;
+    m_evictions = 0;
+    m_bytesFetched = 0;
+    m_bytesEvicted = 0;
+}
+
+Json::Value QueryStats::toJson() const
+{
+    Json::Value json;
+
+    for (std::size_t i(0); i < numStages; ++i)
+    {
+        json["stages"][toString(static_cast<QueryStage>(i))] =
+            m_histograms[i].toJson();
+    }
+
+    Json::Value& chunks(json["chunks"]);
+    chunks["hits"] = Json::UInt64(m_hits);
+    chunks["misses"] = Json::UInt64(m_misses);
+    chunks["evictions"] = Json::UInt64(m_evictions);
+    chunks["bytesFetched"] = Json::UInt64(m_bytesFetched);
+    chunks["bytesEvicted"] = Json::UInt64(m_bytesEvicted);
+
+    return json;
+}
+
+} // namespace entwine
+
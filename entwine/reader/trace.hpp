@@ -0,0 +1,154 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+namespace entwine
+{
+
+using TraceClock = std::chrono::steady_clock;
+using TraceTime = TraceClock::time_point;
+
+// Stages of a query.  Fetches happen on the cache's fetch threads, and
+// include the sorting of the fetched chunk.
+enum class QueryStage
+{
+    Traverse,   // Gather the chunks overlapping the query.
+    Reserve,    // Wait for room in the cache.
+    Fetch,      // Download and decompress a chunk that was not cached.
+    Sort,       // Sort the points of a fetched chunk.
+    Process,    // Filter and process the points of a chunk.
+    Query,      // Construction until completion of a query.
+    End
+};
+
+std::string toString(QueryStage stage);
+
+// Log-linear latency histogram, with eight buckets per power of two, so
+// percentiles are accurate to within about 6%.  Safe for concurrent adds.
+class Histogram
+{
+public:
+    Histogram() { clear(); }
+
+    void add(std::chrono::nanoseconds elapsed);
+    void clear();
+
+    uint64_t count() const { return m_count; }
+
+    // Returns the latency, in seconds, below which p (in [0, 1]) of the
+    // samples fall.
+    double percentile(double p) const;
+
+    // { "count": n, "seconds": s, "mean": s, "p50": s, "p90": s, "p99": s,
+    //   "max": s }
+    Json::Value toJson() const;
+
+private:
+    static const std::size_t numBuckets = 8 * 62;
+
+    static std::size_t bucket(uint64_t ns);
+    static uint64_t mid(std::size_t bucket);
+
+    std::array<std::atomic<uint64_t>, numBuckets> m_buckets;
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_total;
+    std::atomic<uint64_t> m_max;
+};
+
+// The timeline of a single query.
+class QueryTrace
+{
+public:
+    QueryTrace() : m_begin(TraceClock::now()) { }
+
+    struct Span
+    {
+        Span(QueryStage stage, double start, double seconds)
+            : stage(stage)
+            , start(start)
+            , seconds(seconds)
+        { }
+
+        QueryStage stage;
+        double start;   // Seconds since the query was created.
+        double seconds;
+    };
+
+    void add(QueryStage stage, TraceTime start, TraceTime end);
+
+    TraceTime begin() const { return m_begin; }
+
+    std::vector<Span> spans() const;
+
+    // { "stages": { "<stage>": { "count": n, "seconds": s }, ... },
+    //   "spans": [ { "stage": "<stage>", "start": s, "seconds": s }, ... ] }
+    Json::Value toJson() const;
+
+private:
+    const TraceTime m_begin;
+
+    mutable std::mutex m_mutex;
+    std::vector<Span> m_spans;
+};
+
+// Process-lifetime query statistics for a Cache, shared by all of its
+// Readers.
+class QueryStats
+{
+public:
+    // Record a stage into its global histogram, and into this query's trace
+    // if one is given.
+    void add(
+            QueryStage stage,
+            TraceTime start,
+            TraceTime end = TraceClock::now(),
+            QueryTrace* trace = nullptr);
+
+    void hit() { ++m_hits; }
+    void miss(std::size_t bytes) { ++m_misses; m_bytesFetched += bytes; }
+    void evict(std::size_t bytes) { ++m_evictions; m_bytesEvicted += bytes; }
+
+    const Histogram& histogram(QueryStage stage) const
+    {
+        return m_histograms.at(static_cast<std::size_t>(stage));
+    }
+
+    void clear();
+
+    // { "stages": { "<stage>": <Histogram>, ... },
+    //   "chunks": { "hits": n, "misses": n, "evictions": n,
+    //               "bytesFetched": n, "bytesEvicted": n } }
+    Json::Value toJson() const;
+
+private:
+    std::array<Histogram, static_cast<std::size_t>(QueryStage::End)>
+        m_histograms;
+
+    std::atomic<uint64_t> m_hits { 0 };
+    std::atomic<uint64_t> m_misses { 0 };
+    std::atomic<uint64_t> m_evictions { 0 };
+    std::atomic<uint64_t> m_bytesFetched { 0 };
+    std::atomic<uint64_t> m_bytesEvicted { 0 };
+};
+
+} // namespace entwine
+
@@ -10,10 +10,12 @@
 
 #include <entwine/tree/builder.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 #include <numeric>
 #include <random>
+#include <sstream>
 #include <thread>
 
 #include <entwine/third/arbiter/arbiter.hpp>
@@ -24,6 +26,7 @@
 #include <entwine/tree/heuristics.hpp>
 #include <entwine/tree/hierarchy-block.hpp>
 #include <entwine/tree/registry.hpp>
+#include <entwine/tree/resolver.hpp>
 #include <entwine/tree/sequence.hpp>
 #include <entwine/tree/thread-pools.hpp>
 #include <entwine/tree/traverser.hpp>
@@ -37,6 +40,7 @@
 #include <entwine/util/compression.hpp>
 #include <entwine/util/executor.hpp>
 #include <entwine/util/json.hpp>
+#include <entwine/util/metrics.hpp>
 #include <entwine/util/pool.hpp>
 #include <entwine/util/unique.hpp>
 
@@ -70,9 +74,7 @@ Builder::Builder(
     , m_isContinuation(false)
     , m_pointPool(
             outerScope.getPointPool(m_metadata->schema(), m_metadata->delta()))
-    , m_hierarchyPool(outerScope.getHierarchyPool(heuristics::poolBlockSize))
     , m_hierarchy(makeUnique<Hierarchy>(
-                *m_hierarchyPool,
                 *m_metadata,
                 *m_outEndpoint,
                 m_outEndpoint.get(),
@@ -99,10 +101,8 @@ Builder::Builder(
     , m_isContinuation(true)
     , m_pointPool(
             outerScope.getPointPool(m_metadata->schema(), m_metadata->delta()))
-    , m_hierarchyPool(outerScope.getHierarchyPool(heuristics::poolBlockSize))
     , m_hierarchy(
             makeUnique<Hierarchy>(
-                *m_hierarchyPool,
                 *m_metadata,
                 *m_outEndpoint,
                 m_outEndpoint.get(),
@@ -146,6 +146,19 @@ void Builder::go(std::size_t max)
 
     const std::size_t alreadyInserted(manifest.pointStats().inserts());
 
+    std::unique_ptr<std::ofstream> metrics;
+    if (m_metricsPath.size())
+    {
+        metrics = makeUnique<std::ofstream>(
+                m_metricsPath,
+                std::ios::out | std::ios::app);
+
+        if (!metrics->good())
+        {
+            throw std::runtime_error("Could not open " + m_metricsPath);
+        }
+    }
+
     Pool p(2);
     p.add([this, max, &done]()
     {
@@ -153,11 +166,14 @@ void Builder::go(std::size_t max)
         done = true;
     });
 
-    p.add([this, &done, &manifest, alreadyInserted]()
+    p.add([this, &done, &manifest, alreadyInserted, &metrics]()
     {
         using ms = std::chrono::milliseconds;
         const std::size_t interval(10);
 
+        std::size_t last(0);
+        std::vector<double> prevWork, prevClip;
+
         while (!done)
         {
             const auto t(since<ms>(m_start));
@@ -185,10 +201,25 @@ void Builder::go(std::size_t max)
                     " A: " << commify(d.allocated()) <<
                     " U: " << used << "%"  <<
                     " C: " << commify(Chunk::count()) <<
+                    " M: " << commify(
+                            PagedTubes::bytes() /
+                            std::max<std::size_t>(Chunk::count(), 1) /
+                            1024) << "K/chunk" <<
                     " H: " << commify(HierarchyBlock::count()) <<
                     " I: " << commify(inserts) <<
                     " P: " << std::round(progress * 100.0) << "%" <<
                     std::endl;
+
+                if (metrics)
+                {
+                    Json::Value json(
+                            telemetry(inserts, s - last, prevWork, prevClip));
+                    json["time"] = Json::UInt64(s);
+                    json["progress"] = progress;
+                    *metrics << toFastString(json) << std::flush;
+                }
+
+                last = s;
             }
         }
     });
@@ -196,6 +227,59 @@ void Builder::go(std::size_t max)
     p.join();
 }
 
+Json::Value Builder::telemetry(
+        const std::size_t inserts,
+        const double seconds,
+        std::vector<double>& prevWork,
+        std::vector<double>& prevClip) const
+{
+    Json::Value json(Metrics::toJson());
+
+    json["inserts"] = Json::UInt64(inserts);
+    json["chunks"] = Json::UInt64(Chunk::count());
+    json["hierarchyBlocks"] = Json::UInt64(HierarchyBlock::count());
+
+    auto pool([seconds](const Pool& pool, std::vector<double>& prev)
+    {
+        Json::Value json;
+        json["threads"] = Json::UInt64(pool.numThreads());
+        json["queued"] = Json::UInt64(pool.queued());
+        json["active"] = Json::UInt64(pool.active());
+
+        // Busy times restart when a pool is cycled.
+        const std::vector<double> busy(pool.busy());
+        if (prev.size() != busy.size()) prev.assign(busy.size(), 0);
+
+        Json::Value& utilization(json["utilization"]);
+        utilization = Json::arrayValue;
+
+        for (std::size_t i(0); i < busy.size(); ++i)
+        {
+            const double delta(busy[i] >= prev[i] ? busy[i] - prev[i] : 0);
+            utilization.append(seconds ? std::min(delta / seconds, 1.0) : 0);
+        }
+
+        prev = busy;
+        return json;
+    });
+
+    json["pools"]["work"] = pool(m_threadPools->workPool(), prevWork);
+    json["pools"]["clip"] = pool(m_threadPools->clipPool(), prevClip);
+
+    const auto& d(m_pointPool->dataPool());
+    const auto& c(m_pointPool->cellPool());
+
+    Json::Value& memory(json["memory"]);
+    memory["dataAllocated"] = Json::UInt64(d.allocated());
+    memory["dataAvailable"] = Json::UInt64(d.available());
+    memory["cellsAllocated"] = Json::UInt64(c.allocated());
+    memory["cellsAvailable"] = Json::UInt64(c.available());
+    memory["bytesPerPoint"] = m_pointPool->bytesPerPoint();
+    memory["tubeBytes"] = Json::UInt64(PagedTubes::bytes());
+
+    return json;
+}
+
 void Builder::doRun(const std::size_t max)
 {
     if (!m_tmpEndpoint)
@@ -203,7 +287,7 @@ void Builder::doRun(const std::size_t max)
         throw std::runtime_error("Cannot add to read-only builder");
     }
 
-    while (auto o = m_sequence->next(max))
+    while (auto o = next(max))
     {
         const Origin origin(*o);
         FileInfo& info(m_metadata->manifest().get(origin));
@@ -222,6 +306,30 @@ void Builder::doRun(const std::size_t max)
             try
             {
                 insertPath(origin, info);
+
+                // Sampled bounds are only estimates, so make some noise if
+                // points were dropped.  The index bounds may have been given
+                // rather than inferred, in which case they needn't cover the
+                // sampled bounds.  If they do, the sample missed points.
+                const FileInfo& inserted(info);
+                const auto& stats(inserted.pointStats());
+                if (inserted.sampled() && stats.outOfBounds())
+                {
+                    const Bounds& bounds(m_metadata->boundsConforming());
+                    const Bounds* sampled(inserted.bounds());
+
+                    std::ostringstream ss;
+                    ss << "\tSampled file " << path << " had " <<
+                        stats.outOfBounds() <<
+                        " points outside of the index bounds " << bounds;
+
+                    if (sampled && bounds.contains(*sampled))
+                    {
+                        ss << ", which cover its sampled bounds " << *sampled;
+                    }
+
+                    std::cout << ss.str() << std::endl;
+                }
             }
             catch (const std::exception& e)
             {
@@ -264,9 +372,15 @@ void Builder::insertPath(const Origin origin, FileInfo& info)
     std::size_t tries(0);
     std::unique_ptr<arbiter::fs::LocalHandle> localHandle;
 
+    Metrics::Timer fetchTimer(Metrics::Phase::Fetch);
+
     do
     {
-        if (tries) std::this_thread::sleep_for(std::chrono::seconds(tries));
+        if (tries)
+        {
+            Metrics::count(Metrics::Counter::FetchRetries);
+            std::this_thread::sleep_for(std::chrono::seconds(tries));
+        }
 
         try
         {
@@ -294,6 +408,7 @@ void Builder::insertPath(const Origin origin, FileInfo& info)
     while (!localHandle && ++tries < inputRetryLimit);
 
     if (!localHandle) throw std::runtime_error("No local handle: " + rawPath);
+    fetchTimer.stop();
 
     const std::string& localPath(localHandle->localPath());
 
@@ -344,6 +459,8 @@ void Builder::insertPath(const Origin origin, FileInfo& info)
                 m_metadata->delta(),
                 origin));
 
+    Metrics::Timer readTimer(Metrics::Phase::Read);
+
     if (!Executor::get().run(
                 *table,
                 localPath,
@@ -361,6 +478,8 @@ Cell::PooledStack Builder::insertData(
         Clipper& clipper,
         Climber& climber)
 {
+    Metrics::Timer timer(Metrics::Phase::Insert);
+
     PointStats pointStats;
     Cell::PooledStack rejected(m_pointPool->cellPool());
 
@@ -373,6 +492,32 @@ Cell::PooledStack Builder::insertData(
     const auto boundsSubset(m_metadata->boundsScaledSubset());
     const std::size_t baseDepthBegin(m_metadata->structure().baseDepthBegin());
 
+    // Balanced subsets aren't necessarily rectangular, so their bounds only
+    // suffice for a quick rejection.
+    std::vector<Bounds> boxesSubset;
+    if (const Subset* subset = m_metadata->subset())
+    {
+        if (subset->splits().size())
+        {
+            for (const Bounds& b : subset->boxes())
+            {
+                boxesSubset.push_back(b.deltify(m_metadata->delta()));
+            }
+        }
+    }
+
+    auto inSubset([&boundsSubset, &boxesSubset](const Point& point)
+    {
+        if (!boundsSubset) return true;
+        if (!boundsSubset->contains(point)) return false;
+        if (boxesSubset.empty()) return true;
+
+        return std::any_of(
+                boxesSubset.begin(),
+                boxesSubset.end(),
+                [&point](const Bounds& b) { return b.contains(point); });
+    });
+
     while (!cells.empty())
     {
         Cell::PooledNode cell(cells.popOne());
@@ -380,7 +525,7 @@ Cell::PooledStack Builder::insertData(
 
         if (boundsConforming.contains(point))
         {
-            if (!boundsSubset || boundsSubset->contains(point))
+            if (inSubset(point))
             {
                 climber.reset();
                 climber.magnifyTo(point, baseDepthBegin);
@@ -519,11 +664,6 @@ std::shared_ptr<PointPool> Builder::sharedPointPool() const
     return m_pointPool;
 }
 
-std::shared_ptr<HierarchyCell::Pool> Builder::sharedHierarchyPool() const
-{
-    return m_hierarchyPool;
-}
-
 const arbiter::Endpoint& Builder::outEndpoint() const { return *m_outEndpoint; }
 const arbiter::Endpoint& Builder::tmpEndpoint() const { return *m_tmpEndpoint; }
 
@@ -532,7 +672,44 @@ std::mutex& Builder::mutex() { return m_mutex; }
 void Builder::append(const FileInfoList& fileInfo)
 {
     m_metadata->manifest().append(fileInfo);
-    m_sequence = makeUnique<Sequence>(*this);
+    m_sequence->extend();
+}
+
+void Builder::stream(std::unique_ptr<Resolver> resolver)
+{
+    m_resolver = std::move(resolver);
+}
+
+std::unique_ptr<Origin> Builder::next(const std::size_t max)
+{
+    auto o(m_sequence->next(max));
+
+    while (!o && m_resolver && m_sequence->accepting(max))
+    {
+        FileInfoList fileInfo;
+        if (!m_resolver->next(fileInfo))
+        {
+            m_resolver.reset();
+            break;
+        }
+
+        if (fileInfo.empty()) continue;
+
+        if (verbose())
+        {
+            std::cout << "Streaming " << fileInfo.size() << " more files" <<
+                std::endl;
+        }
+
+        // Inserting files hold references into the manifest, so let them
+        // finish before it grows.
+        m_threadPools->workPool().await();
+        append(fileInfo);
+
+        o = m_sequence->next(max);
+    }
+
+    return o;
 }
 
 void Builder::clip(
@@ -50,6 +50,7 @@ class Metadata;
 class Pool;
 class Registry;
 class Reprojection;
+class Resolver;
 class Schema;
 class Sequence;
 class Structure;
@@ -102,7 +103,6 @@ public:
 
     PointPool& pointPool() const;
     std::shared_ptr<PointPool> sharedPointPool() const;
-    std::shared_ptr<HierarchyCell::Pool> sharedHierarchyPool() const;
 
     bool isContinuation() const { return m_isContinuation; }
 
@@ -115,9 +115,17 @@ public:
 
     void append(const FileInfoList& fileInfo);
 
+    // Continue to append files from this resolver while building, as each of
+    // its inputs finishes listing.
+    void stream(std::unique_ptr<Resolver> resolver);
+
     bool verbose() const { return m_verbose; }
     void verbose(bool v) { m_verbose = v; }
 
+    // While building, periodically append a line of JSON telemetry to this
+    // local file.  See telemetry() for its contents.
+    void metrics(std::string path) { m_metricsPath = path; }
+
     static std::unique_ptr<Builder> tryCreateExisting(
             std::string path,
             std::string tmp,
@@ -128,8 +136,22 @@ public:
 
 private:
     void doRun(std::size_t max);
+
+    // The next file to insert, pulling more files from our resolver as
+    // needed.
+    std::unique_ptr<Origin> next(std::size_t max);
     bool exists() const { return !!m_metadata->manifestPtr(); }
 
+    // The phase timings and counters of the Metrics registry, along with the
+    // state of our thread pools and point pool.  Pool utilization is the
+    // fraction of the elapsed seconds since the previous snapshot that each
+    // thread spent running tasks.
+    Json::Value telemetry(
+            std::size_t inserts,
+            double seconds,
+            std::vector<double>& prevWork,
+            std::vector<double>& prevClip) const;
+
     std::mutex& mutex();
 
     // Save the current state of the tree.  Files may no longer be inserted
@@ -176,13 +198,14 @@ private:
     bool m_isContinuation;
 
     mutable std::shared_ptr<PointPool> m_pointPool;
-    mutable std::shared_ptr<HierarchyCell::Pool> m_hierarchyPool;
 
     std::unique_ptr<Hierarchy> m_hierarchy;
     std::unique_ptr<Sequence> m_sequence;
+    std::unique_ptr<Resolver> m_resolver;
     std::unique_ptr<Registry> m_registry;
 
     bool m_verbose = false;
+    std::string m_metricsPath;
 
     TimePoint m_start;
 
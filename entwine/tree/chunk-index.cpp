@@ -0,0 +1,317 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/tree/chunk-index.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/types/structure.hpp>
+#include <entwine/util/io.hpp>
+#include <entwine/util/json.hpp>
+#include <entwine/util/unique.hpp>
+
+namespace entwine
+{
+
+namespace
+{
+    const std::string magic("EIDX");
+    const uint32_t version(1);
+
+    std::string filename(const std::string& postfix)
+    {
+        return "entwine-index" + postfix;
+    }
+
+    std::string legacyFilename(const std::string& postfix)
+    {
+        return "entwine-ids" + postfix;
+    }
+
+    template<typename T>
+    void append(std::vector<char>& data, T v)
+    {
+        data.insert(
+                data.end(),
+                reinterpret_cast<const char*>(&v),
+                reinterpret_cast<const char*>(&v + 1));
+    }
+
+    template<typename T>
+    T extract(const std::vector<char>& data, std::size_t& pos)
+    {
+        if (pos + sizeof(T) > data.size())
+        {
+            throw std::runtime_error("Invalid chunk index");
+        }
+
+        T v;
+        std::memcpy(&v, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+
+    uint8_t widthOf(uint64_t v)
+    {
+        uint8_t width(1);
+        while (v >>= 8) ++width;
+        return width;
+    }
+}
+
+ChunkIndex::Depth::Depth(const std::vector<uint64_t>& positions)
+{
+    if (positions.empty()) return;
+
+    const uint64_t span(positions.back() + 1);
+    width = widthOf(positions.back());
+
+    dense = span / 8 + 1 <= positions.size() * width;
+    count = dense ? span : positions.size();
+
+    if (dense)
+    {
+        data.resize(span / 8 + 1, 0);
+        for (const uint64_t p : positions) data[p / 8] |= 1 << (p % 8);
+    }
+    else
+    {
+        data.resize(positions.size() * width);
+        for (std::size_t i(0); i < positions.size(); ++i)
+        {
+            std::memcpy(data.data() + i * width, &positions[i], width);
+        }
+    }
+}
+
+bool ChunkIndex::Depth::exists(const uint64_t position) const
+{
+    if (dense)
+    {
+        return position < count && (data[position / 8] >> (position % 8)) & 1;
+    }
+
+    std::size_t lo(0);
+    std::size_t hi(count);
+
+    while (lo < hi)
+    {
+        const std::size_t mid(lo + (hi - lo) / 2);
+        const uint64_t v(at(mid));
+
+        if (v == position) return true;
+        else if (v < position) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return false;
+}
+
+uint64_t ChunkIndex::Depth::at(const std::size_t i) const
+{
+    uint64_t v(0);
+    std::memcpy(&v, data.data() + i * width, width);
+    return v;
+}
+
+std::size_t ChunkIndex::Depth::size() const
+{
+    if (!dense) return count;
+
+    std::size_t n(0);
+    for (const unsigned char c : data)
+    {
+        for (unsigned char b(c); b; b &= b - 1) ++n;
+    }
+    return n;
+}
+
+ChunkIndex::ChunkIndex(const Structure& structure, const std::set<Id>& ids)
+    : m_structure(structure)
+{
+    std::vector<std::vector<uint64_t>> positions;
+
+    // The IDs are sorted, so the positions within each depth are too.
+    for (const Id& id : ids)
+    {
+        const std::size_t depth(
+                ChunkInfo::calcDepth(m_structure.factor(), id));
+
+        if (depth >= positions.size()) positions.resize(depth + 1);
+        positions[depth].push_back(position(m_structure, id, depth));
+    }
+
+    for (const auto& p : positions) m_depths.emplace_back(p);
+}
+
+ChunkIndex::ChunkIndex(const Structure& structure, const std::vector<char>& d)
+    : m_structure(structure)
+{
+    std::size_t pos(magic.size());
+
+    if (d.size() < pos || std::string(d.data(), pos) != magic)
+    {
+        throw std::runtime_error("Invalid chunk index");
+    }
+
+    if (extract<uint32_t>(d, pos) != version)
+    {
+        throw std::runtime_error("Unsupported chunk index version");
+    }
+
+    m_depths.resize(extract<uint32_t>(d, pos));
+
+    for (Depth& depth : m_depths)
+    {
+        depth.dense = extract<uint8_t>(d, pos);
+        depth.width = extract<uint8_t>(d, pos);
+        depth.count = extract<uint64_t>(d, pos);
+
+        const uint64_t bytes(extract<uint64_t>(d, pos));
+        const uint64_t expected(
+                depth.dense ?
+                    (depth.count ? depth.count / 8 + 1 : 0) :
+                    depth.count * depth.width);
+
+        if (bytes != expected || bytes > d.size() - pos || depth.width > 8)
+        {
+            throw std::runtime_error("Invalid chunk index");
+        }
+
+        depth.data.assign(d.data() + pos, d.data() + pos + bytes);
+        pos += bytes;
+    }
+}
+
+std::unique_ptr<ChunkIndex> ChunkIndex::create(
+        const Structure& structure,
+        const arbiter::Endpoint& endpoint,
+        const std::string& postfix)
+{
+    if (auto index = tryCreate(structure, endpoint, postfix)) return index;
+
+    const std::vector<Id> legacy(
+            extractIds(io::ensureGetString(endpoint, legacyFilename(postfix))));
+
+    return makeUnique<ChunkIndex>(
+            structure,
+            std::set<Id>(legacy.begin(), legacy.end()));
+}
+
+std::unique_ptr<ChunkIndex> ChunkIndex::tryCreate(
+        const Structure& structure,
+        const arbiter::Endpoint& endpoint,
+        const std::string& postfix)
+{
+    if (!endpoint.tryGetSize(filename(postfix))) return nullptr;
+
+    return makeUnique<ChunkIndex>(
+            structure,
+            *io::ensureGet(endpoint, filename(postfix)));
+}
+
+void ChunkIndex::save(
+        const arbiter::Endpoint& endpoint,
+        const std::string& postfix) const
+{
+    io::ensurePut(endpoint, filename(postfix), toBinary());
+}
+
+std::vector<char> ChunkIndex::toBinary() const
+{
+    std::vector<char> data(magic.begin(), magic.end());
+    append(data, version);
+    append(data, static_cast<uint32_t>(m_depths.size()));
+
+    for (const Depth& depth : m_depths)
+    {
+        append(data, static_cast<uint8_t>(depth.dense));
+        append(data, depth.width);
+        append(data, depth.count);
+        append(data, static_cast<uint64_t>(depth.data.size()));
+        data.insert(data.end(), depth.data.begin(), depth.data.end());
+    }
+
+    return data;
+}
+
+uint64_t ChunkIndex::position(
+        const Structure& structure,
+        const Id& chunkId,
+        const std::size_t depth)
+{
+    const Id levelIndex(
+            ChunkInfo::calcLevelIndex(structure.dimensions(), depth));
+    const ChunkInfo info(structure, chunkId);
+
+    return ((chunkId - levelIndex) / info.pointsPerChunk()).getSimple();
+}
+
+bool ChunkIndex::exists(const Id& chunkId) const
+{
+    if (chunkId < m_structure.coldIndexBegin()) return false;
+
+    const std::size_t depth(
+            ChunkInfo::calcDepth(m_structure.factor(), chunkId));
+
+    return exists(depth, position(m_structure, chunkId, depth));
+}
+
+std::set<Id> ChunkIndex::ids() const
+{
+    std::set<Id> results;
+
+    for (std::size_t d(0); d < m_depths.size(); ++d)
+    {
+        const Depth& depth(m_depths[d]);
+        if (!depth.count) continue;
+
+        const Id levelIndex(
+                ChunkInfo::calcLevelIndex(m_structure.dimensions(), d));
+        const Id ppc(pointsPerChunk(d));
+
+        auto add([&](uint64_t p) { results.insert(levelIndex + ppc * p); });
+
+        if (depth.dense)
+        {
+            for (uint64_t p(0); p < depth.count; ++p)
+            {
+                if (depth.exists(p)) add(p);
+            }
+        }
+        else
+        {
+            for (std::size_t i(0); i < depth.count; ++i) add(depth.at(i));
+        }
+    }
+
+    return results;
+}
+
+std::size_t ChunkIndex::size() const
+{
+    std::size_t n(0);
+    for (const Depth& depth : m_depths) n += depth.size();
+    return n;
+}
+
+Id ChunkIndex::pointsPerChunk(const std::size_t depth) const
+{
+    return ChunkInfo(
+            m_structure,
+            ChunkInfo::calcLevelIndex(m_structure.dimensions(), depth))
+        .pointsPerChunk();
+}
+
+} // namespace entwine
+
@@ -0,0 +1,102 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <entwine/types/defs.hpp>
+
+namespace entwine
+{
+
+namespace arbiter { class Endpoint; }
+
+class Structure;
+
+// A compact record of which cold chunks exist in an index, which replaces the
+// JSON list of chunk IDs.  Each chunk is identified by its depth and by its
+// position within that depth, so a lookup doesn't need any big-integer math.
+//
+// Depths where a large fraction of the possible chunks exist are stored as
+// bitmaps, and sparse depths as sorted arrays of positions packed to the
+// minimum byte width, whichever is smaller.  The serialized form is exactly
+// the in-memory form, so the whole thing loads with a single read.
+class ChunkIndex
+{
+public:
+    ChunkIndex(const Structure& structure, const std::set<Id>& ids);
+    ChunkIndex(const Structure& structure, const std::vector<char>& data);
+
+    // Load the chunk index of an existing build, falling back to the legacy
+    // JSON list of IDs for builds which predate the binary index.  Throws if
+    // neither exists.
+    static std::unique_ptr<ChunkIndex> create(
+            const Structure& structure,
+            const arbiter::Endpoint& endpoint,
+            const std::string& postfix = "");
+
+    // Returns null if there is no binary index at this endpoint.
+    static std::unique_ptr<ChunkIndex> tryCreate(
+            const Structure& structure,
+            const arbiter::Endpoint& endpoint,
+            const std::string& postfix = "");
+
+    void save(
+            const arbiter::Endpoint& endpoint,
+            const std::string& postfix = "") const;
+
+    std::vector<char> toBinary() const;
+
+    // Position of a chunk within its depth.
+    static uint64_t position(
+            const Structure& structure,
+            const Id& chunkId,
+            std::size_t depth);
+
+    bool exists(std::size_t depth, uint64_t position) const
+    {
+        return depth < m_depths.size() && m_depths[depth].exists(position);
+    }
+
+    bool exists(const Id& chunkId) const;
+
+    std::set<Id> ids() const;
+    std::size_t size() const;
+
+private:
+    struct Depth
+    {
+        Depth() = default;
+        explicit Depth(const std::vector<uint64_t>& positions);
+
+        bool exists(uint64_t position) const;
+        std::size_t size() const;
+        uint64_t at(std::size_t i) const;
+
+        bool dense = false;
+        uint8_t width = 0;
+        uint64_t count = 0;     // Bits if dense, else number of positions.
+        std::vector<unsigned char> data;
+    };
+
+    Id pointsPerChunk(std::size_t depth) const;
+
+    const Structure& m_structure;
+    std::vector<Depth> m_depths;
+};
+
+} // namespace entwine
+
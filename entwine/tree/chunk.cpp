@@ -30,6 +30,7 @@
 #include <entwine/types/subset.hpp>
 #include <entwine/util/compression.hpp>
 #include <entwine/util/io.hpp>
+#include <entwine/util/metrics.hpp>
 #include <entwine/util/unique.hpp>
 
 namespace entwine
@@ -47,7 +48,8 @@ Chunk::Chunk(
         const Bounds& bounds,
         const std::size_t depth,
         const Id& id,
-        const Id& maxPoints)
+        const Id& maxPoints,
+        const bool exists)
     : m_builder(builder)
     , m_metadata(m_builder.metadata())
     , m_bounds(bounds)
@@ -56,8 +58,10 @@ Chunk::Chunk(
     , m_zDepth(std::min(Tube::maxTickDepth(), depth))
     , m_id(id)
     , m_maxPoints(maxPoints)
+    , m_exists(exists)
 {
     ++chunkCount;
+    Metrics::count(Metrics::Counter::ChunksCreated);
 }
 
 void Chunk::populate(Cell::PooledStack cells)
@@ -77,7 +81,9 @@ void Chunk::populate(Cell::PooledStack cells)
 
 void Chunk::save()
 {
+    Metrics::Timer timer(Metrics::Phase::Serialize);
     storage().serialize(*this);
+    Metrics::count(Metrics::Counter::ChunksSaved);
 }
 
 Chunk::~Chunk()
@@ -128,7 +134,7 @@ SparseChunk::SparseChunk(
         const Id& id,
         const Id& maxPoints,
         const bool exists)
-    : Chunk(builder, bounds, depth, id, maxPoints)
+    : Chunk(builder, bounds, depth, id, maxPoints, exists)
 {
     if (exists)
     {
@@ -203,7 +209,7 @@ void SparseChunk::tile() const
         const std::size_t tick(tilePair.first);
         const auto& tileData(tilePair.second);
 
-        cesium::Tile tile(tileData);
+        cesium::Tile tile(tileData, *m_metadata.cesiumSettings());
 
         io::ensurePut(
                 endpoint,
@@ -221,7 +227,7 @@ ContiguousChunk::ContiguousChunk(
         const Id& id,
         const Id& maxPoints,
         const bool exists)
-    : Chunk(builder, bounds, depth, id, maxPoints)
+    : Chunk(builder, bounds, depth, id, maxPoints, exists)
     , m_tubes(maxPoints.getSimple())
 {
     if (exists)
@@ -238,10 +244,10 @@ Cell::PooledStack ContiguousChunk::acquire()
 {
     Cell::PooledStack cells(m_pointPool.cellPool());
 
-    for (Tube& tube : m_tubes)
+    m_tubes.forEach([&cells](std::size_t, Tube& tube)
     {
         for (auto& inner : tube) cells.push(std::move(inner.second));
-    }
+    });
 
     return cells;
 }
@@ -253,7 +259,7 @@ cesium::TileInfo ContiguousChunk::info() const
     const std::size_t div(divisor());
     const bool inBase(m_depth < m_metadata.structure().coldDepthBegin());
 
-    for (const auto& tube : m_tubes)
+    m_tubes.forEach([&](std::size_t, const Tube& tube)
     {
         for (const auto& cellPair : tube)
         {
@@ -261,7 +267,7 @@ cesium::TileInfo ContiguousChunk::info() const
             if (ticks.count(cur)) ticks[cur] += cellPair.second->size();
             else ticks[cur] = cellPair.second->size();
         }
-    }
+    });
 
     Bounds b(m_bounds);
     if (const auto d = m_metadata.delta())
@@ -279,20 +285,20 @@ void ContiguousChunk::tile() const
     const bool inBase(m_depth < m_metadata.structure().coldDepthBegin());
     cesium::TileBuilder tileBuilder(m_metadata, tileInfo);
 
-    for (const auto& tube : m_tubes)
+    m_tubes.forEach([&](std::size_t, const Tube& tube)
     {
         for (const auto& cellPair : tube)
         {
             tileBuilder.push(inBase ? 0 : cellPair.first, *cellPair.second);
         }
-    }
+    });
 
     for (const auto& tilePair : tileBuilder.data())
     {
         const std::size_t tick(tilePair.first);
         const auto& tileData(tilePair.second);
 
-        cesium::Tile tile(tileData);
+        cesium::Tile tile(tileData, *m_metadata.cesiumSettings());
 
         io::ensurePut(
                 endpoint,
@@ -353,7 +359,8 @@ BaseChunk::BaseChunk(const Builder& builder, const bool exists)
             builder.metadata().boundsScaledCubic(),
             builder.metadata().structure().baseDepthBegin(),
             builder.metadata().structure().baseIndexBegin(),
-            builder.metadata().structure().baseIndexSpan())
+            builder.metadata().structure().baseIndexSpan(),
+            exists)
 {
     std::srand(std::time(0));
     const auto& s(m_metadata.structure());
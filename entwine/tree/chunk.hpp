@@ -48,7 +48,8 @@ public:
             const Bounds& bounds,
             std::size_t depth,
             const Id& id,
-            const Id& maxPoints);
+            const Id& maxPoints,
+            bool exists);
 
     Chunk(Chunk&& other) = default;
 
@@ -69,6 +70,10 @@ public:
     const Storage& storage() const { return m_metadata.storage(); }
     const Bounds& bounds() const { return m_bounds; }
 
+    // True if this chunk was populated from a previously written chunk, in
+    // which case saving it overwrites that data.
+    bool exists() const { return m_exists; }
+
     virtual void save();
 
     virtual ChunkType type() const = 0;
@@ -119,6 +124,7 @@ protected:
     Id m_id;
 
     Id m_maxPoints;
+    bool m_exists;
 };
 
 class SparseChunk : public Chunk
@@ -181,14 +187,7 @@ public:
 
     virtual cesium::TileInfo info() const override;
 
-    bool empty() const
-    {
-        for (const auto& tube : m_tubes)
-        {
-            if (!tube.empty()) return false;
-        }
-        return true;
-    }
+    bool empty() const { return m_tubes.empty(); }
 
 protected:
     virtual Cell::PooledStack acquire() override;
@@ -210,11 +209,7 @@ protected:
 
     void append(ContiguousChunk& other)
     {
-        m_tubes.insert(
-                m_tubes.end(),
-                std::make_move_iterator(other.m_tubes.begin()),
-                std::make_move_iterator(other.m_tubes.end()));
-
+        m_tubes.append(other.m_tubes);
         m_maxPoints += other.maxPoints();
     }
 
@@ -225,7 +220,7 @@ protected:
         m_maxPoints = 0;
     }
 
-    std::vector<Tube> m_tubes;
+    PagedTubes m_tubes;
 };
 
 class BaseChunk : public Chunk
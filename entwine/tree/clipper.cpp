@@ -10,6 +10,7 @@
 
 #include <entwine/tree/clipper.hpp>
 #include <entwine/tree/heuristics.hpp>
+#include <entwine/util/metrics.hpp>
 
 namespace entwine
 {
@@ -18,6 +19,8 @@ void Clipper::clip()
 {
     if (m_clips.size() < heuristics::clipCacheSize) return;
 
+    Metrics::Timer timer(Metrics::Phase::Clip);
+
     m_fastCache.assign(32, m_clips.end());
     bool done(false);
 
@@ -16,6 +16,7 @@
 #include <entwine/formats/cesium/tileset.hpp>
 #include <entwine/third/arbiter/arbiter.hpp>
 #include <entwine/tree/builder.hpp>
+#include <entwine/tree/chunk-index.hpp>
 #include <entwine/tree/climber.hpp>
 #include <entwine/tree/clipper.hpp>
 #include <entwine/tree/thread-pools.hpp>
@@ -48,18 +49,14 @@ Cold::Cold(const Builder& builder, bool exists)
 
     if (exists)
     {
-        const Json::Value json(([this, &metadata]()
-        {
-            const std::string path("entwine-ids" + metadata.postfix());
-            return parse(io::ensureGetString(m_builder.outEndpoint(), path));
-        })());
-
-        Id chunkId(0);
+        const auto index(
+                ChunkIndex::create(
+                    m_structure,
+                    m_builder.outEndpoint(),
+                    metadata.postfix()));
 
-        for (Json::ArrayIndex i(0); i < json.size(); ++i)
+        for (const Id& chunkId : index->ids())
         {
-            chunkId = Id(json[i].asString());
-
             const ChunkInfo chunkInfo(m_structure.getInfo(chunkId));
             const std::size_t chunkNum(chunkInfo.chunkNum());
 
@@ -120,7 +117,9 @@ Tube::Insertion Cold::insert(
         }
     }
 
-    return countedChunk->chunk->insert(climber, cell);
+    const Tube::Insertion result(countedChunk->chunk->insert(climber, cell));
+    if (result.changed() && !countedChunk->dirty) countedChunk->dirty = true;
+    return result;
 }
 
 void Cold::ensureChunk(
@@ -170,12 +169,8 @@ void Cold::save(const arbiter::Endpoint& endpoint) const
         baseChunk->save();
     }
 
-    const auto aggregated(ids());
-    Json::Value json;
-    for (const auto& id : aggregated) json.append(id.str());
-
-    const std::string subpath("entwine-ids" + m_builder.metadata().postfix());
-    io::ensurePut(endpoint, subpath, toFastString(json));
+    const ChunkIndex index(m_structure, ids());
+    index.save(endpoint, m_builder.metadata().postfix());
 
     if (m_builder.metadata().cesiumSettings()) saveCesiumMetadata(endpoint);
 }
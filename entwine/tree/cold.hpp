@@ -47,6 +47,10 @@ struct CountedChunk
     std::unique_ptr<Chunk> chunk;
     std::unordered_map<std::size_t, std::size_t> refs;
 
+    // Set when an insertion modifies the chunk.  A chunk that was loaded from
+    // an existing index but never modified doesn't need to be rewritten.
+    std::atomic_bool dirty { false };
+
     bool unique() const
     {
         return refs.size() == 1 && refs.begin()->second == 1;
@@ -59,8 +63,9 @@ struct CountedChunk
             refs.erase(id);
             if (refs.empty())
             {
-                chunk->save();
+                if (dirty) chunk->save();
                 chunk.reset();
+                dirty = false;
             }
         }
     }
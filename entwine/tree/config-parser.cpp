@@ -8,6 +8,7 @@
 *
 ******************************************************************************/
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <numeric>
@@ -18,6 +19,7 @@
 #include <entwine/third/arbiter/arbiter.hpp>
 #include <entwine/tree/builder.hpp>
 #include <entwine/tree/inference.hpp>
+#include <entwine/tree/resolver.hpp>
 #include <entwine/tree/thread-pools.hpp>
 #include <entwine/types/bounds.hpp>
 #include <entwine/types/storage.hpp>
@@ -54,6 +56,19 @@ namespace
 
         return settings;
     }
+
+    // True if the input consists only of paths, without any per-file
+    // information that would need to be aggregated before building.
+    bool onlyPaths(const Json::Value& input)
+    {
+        if (input.isString()) return true;
+        if (!input.isArray()) return false;
+
+        return std::all_of(
+                input.begin(),
+                input.end(),
+                [](const Json::Value& v) { return v.isString(); });
+    }
 }
 
 Json::Value ConfigParser::defaults()
@@ -126,8 +141,9 @@ std::unique_ptr<Builder> ConfigParser::getBuilder(
     const auto outType(arbiter::Arbiter::getType(out));
     if (outType == "s3" || outType == "gs") json["prefixIds"] = true;
 
-    normalizeInput(json, *arbiter);
-    auto fileInfo(extract<FileInfo>(json["input"]));
+    const bool pathInput(onlyPaths(json["input"]));
+    auto resolver(normalizeInput(json, *arbiter, workThreads + clipThreads));
+    FileInfoList fileInfo;
 
     if (!json["force"].asBool())
     {
@@ -145,12 +161,30 @@ std::unique_ptr<Builder> ConfigParser::getBuilder(
                 std::cout << "Scanning for new files..." << std::endl;
             }
 
+            if (json.isMember("metrics"))
+            {
+                builder->metrics(json["metrics"].asString());
+            }
+
+            resolveInput(json, resolver.get());
+            fileInfo = extract<FileInfo>(json["input"]);
+
             // Only scan for files that aren't already in the index.
             fileInfo = builder->metadata().manifest().diff(fileInfo);
 
             if (fileInfo.size())
             {
                 Inference inference(*builder, fileInfo);
+                if (json.isMember("cache"))
+                {
+                    inference.cache(json["cache"].asString());
+                }
+
+                if (json.isMember("sample"))
+                {
+                    inference.sample(json["sample"].asDouble());
+                }
+
                 inference.go();
                 fileInfo = inference.fileInfo();
 
@@ -175,6 +209,19 @@ std::unique_ptr<Builder> ConfigParser::getBuilder(
     }
 
     const auto storage(toChunkStorageType(json["storage"]));
+
+    Json::Value storageOptions;
+    if (storage == ChunkStorageType::Zstandard && json.isMember("zstdLevel"))
+    {
+        storageOptions["zstdLevel"] = json["zstdLevel"];
+    }
+    if (
+            storage == ChunkStorageType::LazPerfSegmented &&
+            json.isMember("segmentPoints"))
+    {
+        storageOptions["segmentPoints"] = json["segmentPoints"];
+    }
+
     const bool trustHeaders(json["trustHeaders"].asBool());
     const bool storePointId(json["storePointId"].asBool());
     auto cesiumSettings(getCesiumSettings(json["formats"]));
@@ -212,6 +259,25 @@ std::unique_ptr<Builder> ConfigParser::getBuilder(
             !numPointsHint ||
             (!absolute && !delta));
 
+    // Without an inference there's no need for the full file list up front,
+    // so start building from the first inputs while the rest are still being
+    // listed.  Balancing a subset requires every file, though.
+    const bool streaming(
+            resolver &&
+            pathInput &&
+            !needsInference &&
+            !(json.isMember("subset") && json["subset"]["balance"].asBool()));
+
+    if (streaming)
+    {
+        while (fileInfo.empty() && resolver->next(fileInfo)) { }
+    }
+    else
+    {
+        resolveInput(json, resolver.get());
+        fileInfo = extract<FileInfo>(json["input"]);
+    }
+
     if (needsInference)
     {
         if (verbose)
@@ -235,6 +301,16 @@ std::unique_ptr<Builder> ConfigParser::getBuilder(
             inference.transformation(*transformation);
         }
 
+        if (json.isMember("cache"))
+        {
+            inference.cache(json["cache"].asString());
+        }
+
+        if (json.isMember("sample"))
+        {
+            inference.sample(json["sample"].asDouble());
+        }
+
         inference.go();
 
         // Overwrite our initial fileInfo with the inferred version, which
@@ -344,7 +420,12 @@ std::unique_ptr<Builder> ConfigParser::getBuilder(
         }
     }
 
-    auto subset(maybeAccommodateSubset(json, *boundsConforming, delta.get()));
+    auto subset(
+            maybeAccommodateSubset(
+                json,
+                *boundsConforming,
+                delta.get(),
+                fileInfo));
     json["numPointsHint"] = static_cast<Json::UInt64>(numPointsHint);
 
     const double density(
@@ -384,7 +465,8 @@ std::unique_ptr<Builder> ConfigParser::getBuilder(
             delta.get(),
             transformation.get(),
             cesiumSettings.get(),
-            preserveSpatial);
+            preserveSpatial,
+            storageOptions);
 
     OuterScope outerScope;
     outerScope.setArbiter(arbiter);
@@ -398,6 +480,8 @@ std::unique_ptr<Builder> ConfigParser::getBuilder(
             outerScope);
 
     if (verbose) builder->verbose(true);
+    if (json.isMember("metrics")) builder->metrics(json["metrics"].asString());
+    if (streaming) builder->stream(std::move(resolver));
     return builder;
 }
 
@@ -430,9 +514,10 @@ std::unique_ptr<Builder> ConfigParser::tryGetExisting(
             os);
 }
 
-void ConfigParser::normalizeInput(
+std::unique_ptr<Resolver> ConfigParser::normalizeInput(
         Json::Value& json,
-        const arbiter::Arbiter& arbiter)
+        const arbiter::Arbiter& arbiter,
+        const std::size_t threads)
 {
     Json::Value& input(json["input"]);
     const bool verbose(json["verbose"].asBool());
@@ -445,47 +530,13 @@ void ConfigParser::normalizeInput(
 
     if (!isInferencePath)
     {
-        // The input source is a path or array of paths.  First, we possibly
-        // need to expand out directories into their containing files.
-        FileInfoList fileInfo;
-
-        auto insert([&fileInfo, &arbiter, verbose](std::string in)
-        {
-            Paths current(arbiter.resolve(in, verbose));
-            std::sort(current.begin(), current.end());
-            for (const auto& c : current) fileInfo.emplace_back(c);
-        });
-
-        if (input.isArray())
-        {
-            for (const auto& entry : input)
-            {
-                if (entry.isString())
-                {
-                    insert(directorify(entry.asString()));
-                }
-                else
-                {
-                    fileInfo.emplace_back(entry);
-                }
-            }
-        }
-        else if (input.isString())
-        {
-            insert(directorify(input.asString()));
-        }
-        else return;
-
-        // Now, we have an array of files (no directories).
-        //
-        // Reset our input with our resolved paths.  config.input.fileInfo will
-        // be an array of strings, containing only paths with no associated
-        // information.
-        input = Json::Value();
-        input.resize(fileInfo.size());
-        for (std::size_t i(0); i < fileInfo.size(); ++i)
+        // The input source is a path or array of paths, which may need to be
+        // expanded out from directories into their containing files.  Start
+        // listing them now - the caller will decide whether to wait for all
+        // of them.
+        if (input.isArray() || input.isString())
         {
-            input[Json::ArrayIndex(i)] = fileInfo[i].toJson();
+            return makeUnique<Resolver>(arbiter, input, threads, verbose);
         }
     }
     else if (isInferencePath)
@@ -514,6 +565,28 @@ void ConfigParser::normalizeInput(
             if (!json.isMember("offset")) json["offset"] = inference["offset"];
         }
     }
+
+    return std::unique_ptr<Resolver>();
+}
+
+void ConfigParser::resolveInput(Json::Value& json, Resolver* resolver)
+{
+    if (!resolver) return;
+
+    // Now, we have an array of files (no directories).
+    //
+    // Reset our input with our resolved paths.  config.input.fileInfo will be
+    // an array of strings, containing only paths with no associated
+    // information.
+    const FileInfoList fileInfo(resolver->all());
+
+    Json::Value& input(json["input"]);
+    input = Json::Value();
+    input.resize(fileInfo.size());
+    for (std::size_t i(0); i < fileInfo.size(); ++i)
+    {
+        input[Json::ArrayIndex(i)] = fileInfo[i].toJson();
+    }
 }
 
 std::string ConfigParser::directorify(const std::string rawPath)
@@ -540,7 +613,8 @@ std::string ConfigParser::directorify(const std::string rawPath)
 std::unique_ptr<Subset> ConfigParser::maybeAccommodateSubset(
         Json::Value& json,
         const Bounds& boundsConforming,
-        const Delta* delta)
+        const Delta* delta,
+        const FileInfoList& fileInfo)
 {
     std::unique_ptr<Subset> subset;
     const bool verbose(json["verbose"].asBool());
@@ -548,6 +622,14 @@ std::unique_ptr<Subset> ConfigParser::maybeAccommodateSubset(
     if (json.isMember("subset"))
     {
         Bounds cube(Metadata::makeNativeCube(boundsConforming, delta));
+
+        Json::Value& s(json["subset"]);
+        if (s["balance"].asBool() && !s.isMember("splits"))
+        {
+            s["splits"] = toJsonArray(
+                    Subset::balance(cube, s["of"].asUInt64(), fileInfo));
+        }
+
         subset = makeUnique<Subset>(cube, json["subset"]);
         const std::size_t configNullDepth(json["nullDepth"].asUInt64());
         const std::size_t minimumNullDepth(subset->minimumNullDepth());
@@ -10,7 +10,9 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <json/json.h>
@@ -23,7 +25,9 @@ namespace arbiter { class Arbiter; }
 class Bounds;
 class Builder;
 class Delta;
+class FileInfo;
 class Manifest;
+class Resolver;
 class Subset;
 
 class ConfigParser
@@ -38,9 +42,15 @@ public:
     static std::string directorify(std::string path);
 
 private:
-    static void normalizeInput(
+    // Returns a Resolver if the input needs to be listed, in which case the
+    // input is left as-is until it is resolved.
+    static std::unique_ptr<Resolver> normalizeInput(
             Json::Value& json,
-            const arbiter::Arbiter& arbiter);
+            const arbiter::Arbiter& arbiter,
+            std::size_t threads);
+
+    // Replace the input with the full list of files from the resolver.
+    static void resolveInput(Json::Value& json, Resolver* resolver);
 
     static std::unique_ptr<Builder> tryGetExisting(
             const Json::Value& config,
@@ -53,7 +63,8 @@ private:
     static std::unique_ptr<Subset> maybeAccommodateSubset(
             Json::Value& json,
             const Bounds& boundsConforming,
-            const Delta* delta);
+            const Delta* delta,
+            const std::vector<FileInfo>& fileInfo);
 };
 
 } // namespace entwine
@@ -0,0 +1,425 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/tree/coordinator.hpp>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+
+#include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/tree/builder.hpp>
+#include <entwine/tree/config-parser.hpp>
+#include <entwine/tree/heuristics.hpp>
+#include <entwine/tree/merger.hpp>
+#include <entwine/types/bounds.hpp>
+#include <entwine/types/manifest.hpp>
+#include <entwine/types/metadata.hpp>
+#include <entwine/types/subset.hpp>
+#include <entwine/util/json.hpp>
+#include <entwine/util/time.hpp>
+
+namespace entwine
+{
+
+namespace
+{
+    std::size_t totalThreads(const Json::Value& threads)
+    {
+        if (threads.isArray())
+        {
+            return threads[0].asUInt64() + threads[1].asUInt64();
+        }
+        return threads.asUInt64();
+    }
+
+    double overlap(const Bounds& a, const Bounds& b)
+    {
+        const double w(
+                std::min(a.max().x, b.max().x) -
+                std::max(a.min().x, b.min().x));
+        const double d(
+                std::min(a.max().y, b.max().y) -
+                std::max(a.min().y, b.min().y));
+
+        if (w <= 0 || d <= 0) return 0;
+        return a.area() ? w * d / a.area() : 1;
+    }
+
+#ifndef _WIN32
+    // Run this function in a child process, with its output (if any) written
+    // to the returned pipe.  The child exits with a non-zero status if the
+    // function throws.
+    std::pair<pid_t, int> spawn(
+            std::function<void(int fd)> f,
+            const bool redirect)
+    {
+        int fds[2];
+        if (pipe(fds) != 0) throw std::runtime_error("Could not create pipe");
+
+        std::cout << std::flush;
+        const pid_t pid(fork());
+
+        if (pid < 0) throw std::runtime_error("Could not fork worker");
+
+        if (pid == 0)
+        {
+            close(fds[0]);
+
+            if (redirect)
+            {
+                dup2(fds[1], STDOUT_FILENO);
+                dup2(fds[1], STDERR_FILENO);
+            }
+
+            int code(0);
+
+            try
+            {
+                f(fds[1]);
+            }
+            catch (std::exception& e)
+            {
+                std::cout << "Error: " << e.what() << std::endl;
+                code = 1;
+            }
+            catch (...)
+            {
+                std::cout << "Unknown error" << std::endl;
+                code = 1;
+            }
+
+            std::cout << std::flush;
+            std::cerr << std::flush;
+            close(fds[1]);
+
+            // Skip the destructors of everything inherited from the parent.
+            _exit(code);
+        }
+
+        close(fds[1]);
+        return std::make_pair(pid, fds[0]);
+    }
+
+    bool succeeded(const pid_t pid)
+    {
+        int status(0);
+        while (waitpid(pid, &status, 0) < 0)
+        {
+            if (errno != EINTR) return false;
+        }
+
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+#endif
+}
+
+Coordinator::Coordinator(Json::Value json, const std::size_t workers)
+    : m_json(json)
+    , m_workers(workers)
+    , m_of(std::max<std::size_t>(workers * heuristics::subsetsPerWorker, 2))
+    , m_threads(0)
+    , m_splits()
+{
+    if (!m_workers) throw std::runtime_error("Invalid worker count");
+
+    if (m_json["subset"].isMember("id"))
+    {
+        throw std::runtime_error("Workers cannot be used with a subset build");
+    }
+
+    const Json::Value d(ConfigParser::defaults());
+    for (const auto& k : d.getMemberNames())
+    {
+        if (!m_json.isMember(k)) m_json[k] = d[k];
+    }
+
+    m_threads = totalThreads(m_json["threads"]);
+    m_json["threads"] = Json::UInt64(std::max<std::size_t>(
+                m_threads / m_workers, 1));
+
+    // Share a single inference among the workers through the cache.
+    if (!m_json.isMember("cache"))
+    {
+        m_json["cache"] =
+            arbiter::fs::expandTilde(m_json["tmp"].asString()) +
+            "/entwine-inference-cache";
+    }
+}
+
+Json::Value Coordinator::subsetJson(const std::size_t id) const
+{
+    Json::Value json(m_json);
+    json["subset"]["id"] = Json::UInt64(id);
+    json["subset"]["of"] = Json::UInt64(m_of);
+
+    // Until the splits are known, the builder chooses them.
+    if (m_splits.empty()) json["subset"]["balance"] = true;
+    else json["subset"]["splits"] = toJsonArray(m_splits);
+
+    return json;
+}
+
+void Coordinator::go()
+{
+#ifdef _WIN32
+    throw std::runtime_error("Worker builds are not supported on Windows");
+#else
+    const auto start(now());
+
+    std::cout << "Building " << m_of << " subsets with " << m_workers <<
+        " workers" << std::endl;
+
+    const std::vector<double> estimates(prepare());
+    const std::vector<std::size_t> failed(build(estimates));
+
+    if (failed.size())
+    {
+        std::string list;
+        for (const std::size_t id : failed)
+        {
+            list += (list.empty() ? "" : ", ") + std::to_string(id);
+        }
+
+        throw std::runtime_error("Subsets failed: " + list);
+    }
+
+    std::cout << "Subsets complete in " <<
+        commify(since<std::chrono::seconds>(start)) << " seconds" <<
+        std::endl;
+
+    merge();
+
+    std::cout << "Build complete in " <<
+        commify(since<std::chrono::seconds>(start)) << " seconds" <<
+        std::endl;
+#endif
+}
+
+std::vector<double> Coordinator::prepare()
+{
+    std::vector<double> estimates(m_of, 0);
+
+#ifndef _WIN32
+    // Inference runs in a child process as well, so that the coordinator
+    // never forks while it has threads of its own.  The child also chooses
+    // the subset splits, which every worker then shares.
+    const Json::Value json(subsetJson(1));
+    const std::size_t of(m_of);
+
+    const auto child(spawn([&json, of](int fd)
+    {
+        auto arbiter(std::make_shared<arbiter::Arbiter>(json["arbiter"]));
+        auto builder(ConfigParser::getBuilder(json, arbiter));
+        if (!builder) throw std::runtime_error("Could not create builder");
+
+        const Metadata& metadata(builder->metadata());
+        const Bounds& cube(metadata.boundsNativeCubic());
+        const std::vector<std::size_t>& splits(metadata.subset()->splits());
+
+        Json::Value result;
+        result["splits"] = toJsonArray(splits);
+        Json::Value& estimates(result["estimates"]);
+
+        for (std::size_t id(1); id <= of; ++id)
+        {
+            const Bounds bounds(Subset(cube, id, splits).bounds());
+
+            double n(0);
+            for (const auto& f : metadata.manifest().fileInfo())
+            {
+                if (const Bounds* b = f.bounds())
+                {
+                    n += f.numPoints() * overlap(*b, bounds);
+                }
+            }
+
+            estimates.append(n);
+        }
+
+        const std::string s(toFastString(result));
+        if (write(fd, s.data(), s.size()) != static_cast<ssize_t>(s.size()))
+        {
+            throw std::runtime_error("Could not write subset estimates");
+        }
+    }, false));
+
+    std::string s;
+    char buffer[4096];
+    ssize_t n(0);
+    while ((n = read(child.second, buffer, sizeof(buffer))) > 0)
+    {
+        s.append(buffer, n);
+    }
+    close(child.second);
+
+    if (!succeeded(child.first) || s.empty())
+    {
+        throw std::runtime_error("Inference failed");
+    }
+
+    const Json::Value result(parse(s));
+    m_splits = extract<std::size_t>(result["splits"]);
+
+    const Json::Value& list(result["estimates"]);
+    for (std::size_t i(0); i < m_of && i < list.size(); ++i)
+    {
+        estimates[i] = list[static_cast<Json::ArrayIndex>(i)].asDouble();
+    }
+#endif
+
+    return estimates;
+}
+
+std::vector<std::size_t> Coordinator::build(const std::vector<double>& est)
+{
+    std::vector<std::size_t> failed;
+
+#ifndef _WIN32
+    // Largest first.
+    std::deque<std::size_t> queue(m_of);
+    std::iota(queue.begin(), queue.end(), 1);
+    std::stable_sort(
+            queue.begin(),
+            queue.end(),
+            [&est](std::size_t a, std::size_t b)
+            {
+                return est[a - 1] > est[b - 1];
+            });
+
+    struct Worker
+    {
+        pid_t pid;
+        std::size_t id;
+        std::string line;
+    };
+
+    std::map<int, Worker> running;
+    std::map<std::size_t, std::size_t> tries;
+    std::size_t done(0);
+
+    const std::size_t run(m_json["run"].asUInt64());
+
+    while (queue.size() || running.size())
+    {
+        while (queue.size() && running.size() < m_workers)
+        {
+            const std::size_t id(queue.front());
+            queue.pop_front();
+
+            const Json::Value json(subsetJson(id));
+            const auto child(spawn([&json, run](int)
+            {
+                auto arbiter(
+                        std::make_shared<arbiter::Arbiter>(json["arbiter"]));
+                auto builder(ConfigParser::getBuilder(json, arbiter));
+                if (!builder) throw std::runtime_error("No builder");
+                builder->go(run);
+            }, true));
+
+            running[child.second] = Worker { child.first, id, std::string() };
+
+            std::cout << "Started subset " << id << " of " << m_of <<
+                " (estimated " <<
+                commify(static_cast<std::size_t>(est[id - 1])) <<
+                " points)" << std::endl;
+        }
+
+        std::vector<pollfd> fds;
+        for (const auto& p : running)
+        {
+            fds.push_back(pollfd { p.first, POLLIN, 0 });
+        }
+
+        if (poll(fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Could not poll workers");
+        }
+
+        for (const pollfd& p : fds)
+        {
+            if (!p.revents) continue;
+
+            Worker& worker(running.at(p.fd));
+
+            char buffer[4096];
+            const ssize_t n(read(p.fd, buffer, sizeof(buffer)));
+
+            if (n > 0)
+            {
+                worker.line.append(buffer, n);
+
+                std::size_t end(0);
+                while ((end = worker.line.find('\n')) != std::string::npos)
+                {
+                    std::cout << "[" << worker.id << "] " <<
+                        worker.line.substr(0, end) << "\n";
+                    worker.line.erase(0, end + 1);
+                }
+
+                std::cout << std::flush;
+                continue;
+            }
+
+            if (n < 0 && errno == EINTR) continue;
+
+            // End of output - the worker has exited.
+            close(p.fd);
+            const std::size_t id(worker.id);
+            const bool ok(succeeded(worker.pid));
+            running.erase(p.fd);
+
+            if (ok)
+            {
+                std::cout << "Subset " << id << " complete (" << ++done <<
+                    " / " << m_of << ")" << std::endl;
+            }
+            else if (tries[id]++ < heuristics::workerRetries)
+            {
+                std::cout << "Subset " << id << " failed - retrying" <<
+                    std::endl;
+                queue.push_front(id);
+            }
+            else
+            {
+                std::cout << "Subset " << id << " failed" << std::endl;
+                failed.push_back(id);
+            }
+        }
+    }
+#endif
+
+    return failed;
+}
+
+void Coordinator::merge()
+{
+    auto arbiter(std::make_shared<arbiter::Arbiter>(m_json["arbiter"]));
+
+    std::cout << "Merging " << m_of << " subsets..." << std::endl;
+    Merger merger(m_json["output"].asString(), m_threads, true, arbiter);
+    merger.go();
+}
+
+} // namespace entwine
+
@@ -0,0 +1,64 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+namespace entwine
+{
+
+// Runs a build as a set of subset builds in local worker processes, and then
+// merges them.  Each worker has its own address space, so workers don't
+// contend on a single point pool or set of thread pools.
+//
+// Dataset inference is performed once up front and shared with the workers
+// through the inference cache, which also gives us an estimate of the number
+// of points in each subset so the largest may be scheduled first.  Subsets are
+// split by point count rather than uniformly by area, so the subset count
+// need not be a power of 2.  Worker output is forwarded through a pipe per
+// worker, prefixed by its subset ID.
+class Coordinator
+{
+public:
+    // The configuration is that of a normal build, and must not specify a
+    // subset ID.
+    Coordinator(Json::Value json, std::size_t workers);
+
+    void go();
+
+    std::size_t workers() const { return m_workers; }
+    std::size_t subsets() const { return m_of; }
+
+private:
+    // Chooses the subset splits and returns the estimated number of points in
+    // each subset.
+    std::vector<double> prepare();
+
+    // Returns the subset IDs that could not be built.
+    std::vector<std::size_t> build(const std::vector<double>& estimates);
+
+    void merge();
+
+    Json::Value subsetJson(std::size_t id) const;
+
+    Json::Value m_json;
+    const std::size_t m_workers;
+    std::size_t m_of;
+    std::size_t m_threads;
+    std::vector<std::size_t> m_splits;
+};
+
+} // namespace entwine
+
@@ -29,8 +29,8 @@ const std::size_t clipCacheSize(64);
 // work threads to clip threads.
 const float defaultWorkToClipRatio(0.33);
 
-// Pooled point cells, data, and hierarchy nodes come from the splice pool,
-// which allocates them in blocks.  This sets the block size.
+// Pooled point cells and data come from the splice pool, which allocates them
+// in blocks.  This sets the block size.
 const std::size_t poolBlockSize(1024 * 1024);
 
 // Since hierarchy blocks simply count bucketed points, after the sparse depth
@@ -39,6 +39,34 @@ const std::size_t poolBlockSize(1024 * 1024);
 // blocks well past the point after which we expect the data to get sparse.
 const float hierarchySparseFactor(1.25);
 
+// Header previews during inference are dominated by I/O latency rather than
+// CPU, so we can run many more of them than we have threads.
+const std::size_t headerThreadsFactor(8);
+
+// When inferring bounds by sampling, points are read in this many evenly
+// spaced runs of contiguous records, with at least sampleMin points in total
+// when the file has that many.  Since the sampled extents can only be smaller
+// than the actual extents, they are grown by sampleMargin of their size.
+const std::size_t sampleRuns(64);
+const std::size_t sampleMin(4096);
+const double sampleMargin(0.05);
+
+// When building with local worker processes, we split the build into this
+// many subsets per worker so the largest subsets can be scheduled first,
+// which keeps workers busy even when the data isn't evenly distributed.
+// Failed subsets are retried this many times before the build is abandoned.
+const std::size_t subsetsPerWorker(2);
+const std::size_t workerRetries(2);
+
+// Balanced subset splits are chosen from a grid this many quadtree levels
+// deeper than a uniform split would need, which gives each split boundary a
+// resolution of 1/16th of an average subset.
+const std::size_t subsetBalanceDepth(2);
+
+// While exporting tiles, stop scheduling new tiles while the decoded data of
+// outstanding tiles exceeds this many bytes.
+const std::size_t tilerMemory(1024 * 1024 * 1024);
+
 } // namespace heuristics
 } // namespace entwine
 
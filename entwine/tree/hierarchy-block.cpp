@@ -30,15 +30,101 @@ namespace
 
 std::size_t HierarchyBlock::count() { return chunkCount; }
 
+HierarchyTube::HierarchyTube(HierarchyTube&& other) noexcept
+    : m_slots()
+    , m_next(nullptr)
+{
+    *this = std::move(other);
+}
+
+HierarchyTube& HierarchyTube::operator=(HierarchyTube&& other) noexcept
+{
+    clear();
+
+    for (std::size_t i(0); i < inlineSlots; ++i)
+    {
+        m_slots[i].key = other.m_slots[i].key.load();
+        m_slots[i].cell = other.m_slots[i].cell;
+        other.m_slots[i].key = 0;
+    }
+
+    m_next = other.m_next.exchange(nullptr);
+    return *this;
+}
+
+void HierarchyTube::clear()
+{
+    Table* table(m_next.exchange(nullptr));
+
+    while (table)
+    {
+        Table* next(table->next.load());
+        delete table;
+        table = next;
+    }
+}
+
+HierarchyCell& HierarchyTube::find(const uint64_t tick)
+{
+    const uint64_t key(tick + 1);
+
+    if (HierarchyCell* cell = claim(m_slots, m_slots + inlineSlots, key))
+    {
+        return *cell;
+    }
+
+    std::atomic<Table*>* link(&m_next);
+    std::size_t size(firstTableSize);
+
+    while (true)
+    {
+        Table* table(link->load(std::memory_order_acquire));
+
+        if (!table)
+        {
+            std::unique_ptr<Table> created(makeUnique<Table>(size));
+            if (link->compare_exchange_strong(table, created.get()))
+            {
+                table = created.release();
+            }
+        }
+
+        Slot* begin(table->slots.data() + probeStart(*table, key));
+        Slot* end(begin + maxProbes);
+
+        if (HierarchyCell* cell = claim(begin, end, key)) return *cell;
+
+        link = &table->next;
+        size *= 4;
+    }
+}
+
+uint64_t HierarchyTube::get(const uint64_t tick) const
+{
+    const uint64_t key(tick + 1);
+
+    const Slot* slot(seek(m_slots, m_slots + inlineSlots, key));
+    if (slot != m_slots + inlineSlots) return slot ? slot->cell.val() : 0;
+
+    for (const Table* t(m_next.load()); t; t = t->next.load())
+    {
+        const Slot* begin(t->slots.data() + probeStart(*t, key));
+        const Slot* end(begin + maxProbes);
+
+        slot = seek(begin, end, key);
+        if (slot != end) return slot ? slot->cell.val() : 0;
+    }
+
+    return 0;
+}
+
 HierarchyBlock::HierarchyBlock(
-        HierarchyCell::Pool& pool,
         const Metadata& metadata,
         const Id& id,
         const arbiter::Endpoint* ep,
         const Id& maxPoints,
         const std::size_t size)
-    : m_pool(pool)
-    , m_metadata(metadata)
+    : m_metadata(metadata)
     , m_id(id)
     , m_ep(ep)
     , m_maxPoints(maxPoints)
@@ -53,7 +139,6 @@ HierarchyBlock::~HierarchyBlock()
 }
 
 std::unique_ptr<HierarchyBlock> HierarchyBlock::create(
-        HierarchyCell::Pool& pool,
         const Metadata& metadata,
         const Id& id,
         const arbiter::Endpoint* outEndpoint,
@@ -61,12 +146,11 @@ std::unique_ptr<HierarchyBlock> HierarchyBlock::create(
 {
     if (!id)
     {
-        return makeUnique<BaseBlock>(pool, metadata, outEndpoint);
+        return makeUnique<BaseBlock>(metadata, outEndpoint);
     }
     if (id < metadata.hierarchyStructure().mappedIndexBegin())
     {
         return makeUnique<ContiguousBlock>(
-                pool,
                 metadata,
                 id,
                 outEndpoint,
@@ -75,7 +159,6 @@ std::unique_ptr<HierarchyBlock> HierarchyBlock::create(
     else
     {
         return makeUnique<SparseBlock>(
-                pool,
                 metadata,
                 id,
                 outEndpoint,
@@ -84,7 +167,6 @@ std::unique_ptr<HierarchyBlock> HierarchyBlock::create(
 }
 
 std::unique_ptr<HierarchyBlock> HierarchyBlock::create(
-        HierarchyCell::Pool& pool,
         const Metadata& metadata,
         const Id& id,
         const arbiter::Endpoint* outEndpoint,
@@ -104,7 +186,6 @@ std::unique_ptr<HierarchyBlock> HierarchyBlock::create(
     if (!id)
     {
         return makeUnique<BaseBlock>(
-                pool,
                 metadata,
                 outEndpoint,
                 decompressed ? *decompressed : data);
@@ -112,7 +193,6 @@ std::unique_ptr<HierarchyBlock> HierarchyBlock::create(
     else if (id < metadata.hierarchyStructure().mappedIndexBegin())
     {
         return makeUnique<ContiguousBlock>(
-                pool,
                 metadata,
                 id,
                 outEndpoint,
@@ -122,7 +202,6 @@ std::unique_ptr<HierarchyBlock> HierarchyBlock::create(
     else if (!readOnly)
     {
         return makeUnique<SparseBlock>(
-                pool,
                 metadata,
                 id,
                 outEndpoint,
@@ -132,7 +211,6 @@ std::unique_ptr<HierarchyBlock> HierarchyBlock::create(
     else
     {
         return makeUnique<ReadOnlySparseBlock>(
-                pool,
                 metadata,
                 id,
                 outEndpoint,
@@ -155,15 +233,13 @@ void HierarchyBlock::save(const arbiter::Endpoint& ep, const std::string pf)
 }
 
 ContiguousBlock::ContiguousBlock(
-        HierarchyCell::Pool& pool,
         const Metadata& metadata,
         const Id& id,
         const arbiter::Endpoint* outEndpoint,
         const std::size_t maxPoints,
         const std::vector<char>& data)
-    : HierarchyBlock(pool, metadata, id, outEndpoint, maxPoints, data.size())
+    : HierarchyBlock(metadata, id, outEndpoint, maxPoints, data.size())
     , m_tubes(maxPoints)
-    , m_spinners(maxPoints)
 {
     const char* pos(data.data());
     const char* end(data.data() + data.size());
@@ -176,7 +252,7 @@ ContiguousBlock::ContiguousBlock(
         tick = extract(pos, end);
         cell = extract(pos, end);
 
-        m_tubes.at(tube).insert(std::make_pair(tick, m_pool.acquireOne(cell)));
+        m_tubes.at(tube).add(tick, cell);
     }
 }
 
@@ -186,12 +262,12 @@ std::vector<char> ContiguousBlock::combine()
 
     for (uint64_t tube(0); tube < m_tubes.size(); ++tube)
     {
-        for (const auto& cell : m_tubes[tube])
+        m_tubes[tube].forEach([this, &data, tube](uint64_t tick, uint64_t val)
         {
             push(data, tube);
-            push(data, cell.first);
-            push(data, cell.second->val());
-        }
+            push(data, tick);
+            push(data, val);
+        });
     }
 
     return data;
@@ -208,46 +284,69 @@ bool ContiguousBlock::empty() const
 }
 
 SparseBlock::SparseBlock(
-        HierarchyCell::Pool& pool,
         const Metadata& metadata,
         const Id& id,
         const arbiter::Endpoint* outEndpoint,
         const Id& maxPoints,
         const std::vector<char>& data)
-    : HierarchyBlock(pool, metadata, id, outEndpoint, maxPoints, data.size())
-    , m_spinner()
-    , m_tubes()
+    : HierarchyBlock(metadata, id, outEndpoint, maxPoints, data.size())
+    , m_shards()
 {
     parse(data.data(), data.data() + data.size());
 }
 
 std::vector<char> SparseBlock::combine()
 {
+    // Readers binary-search these entries, so they must be written in Id
+    // order regardless of how they are spread across our shards.
+    using Entry = std::pair<const Id, HierarchyTube>;
+    std::vector<const Entry*> entries;
+
+    for (const auto& shard : m_shards)
+    {
+        for (const auto& entry : shard.tubes) entries.push_back(&entry);
+    }
+
+    std::sort(
+            entries.begin(),
+            entries.end(),
+            [](const Entry* a, const Entry* b) { return a->first < b->first; });
+
     std::vector<char> data;
 
-    for (const auto& pair : m_tubes)
+    for (const Entry* entry : entries)
     {
-        const Id& id(pair.first);
-        const auto& tube(pair.second);
+        const Id& id(entry->first);
 
-        for (const auto& cell : tube)
+        entry->second.forEach([this, &data, &id](uint64_t tick, uint64_t val)
         {
             push(data, id.data().size());
             for (const Id::Block block : id.data()) push(data, block);
-            push(data, cell.first);
-            push(data, cell.second->val());
-        }
+            push(data, tick);
+            push(data, val);
+        });
     }
 
     return data;
 }
 
+bool SparseBlock::empty() const
+{
+    for (const auto& shard : m_shards)
+    {
+        for (const auto& entry : shard.tubes)
+        {
+            if (!entry.second.empty()) return false;
+        }
+    }
+
+    return true;
+}
+
 BaseBlock::BaseBlock(
-        HierarchyCell::Pool& pool,
         const Metadata& metadata,
         const arbiter::Endpoint* outEndpoint)
     : HierarchyBlock(
-            pool,
             metadata,
             0,
             outEndpoint,
@@ -280,7 +379,6 @@ BaseBlock::BaseBlock(
                         spans[d].end() - spans[d].begin());
 
             m_blocks.emplace_back(
-                    pool,
                     metadata,
                     index,
                     outEndpoint,
@@ -292,7 +390,6 @@ BaseBlock::BaseBlock(
         for (std::size_t d(s.baseDepthBegin()); d < s.baseDepthEnd(); ++d)
         {
             m_blocks.emplace_back(
-                    pool,
                     metadata,
                     ChunkInfo::calcLevelIndex(2, d),
                     outEndpoint,
@@ -302,11 +399,10 @@ BaseBlock::BaseBlock(
 }
 
 BaseBlock::BaseBlock(
-        HierarchyCell::Pool& pool,
         const Metadata& metadata,
         const arbiter::Endpoint* outEndpoint,
         const std::vector<char>& data)
-    : BaseBlock(pool, metadata, outEndpoint)
+    : BaseBlock(metadata, outEndpoint)
 {
     const char* pos(data.data());
     const char* end(data.data() + data.size());
@@ -323,7 +419,7 @@ BaseBlock::BaseBlock(
 
         const std::size_t depth(ChunkInfo::calcDepth(factor, m_id + tube));
 
-        m_blocks.at(depth).count(m_id + tube, tick, cell);
+        m_blocks.at(depth).add(m_id + tube, tick, cell);
     }
 }
 
@@ -339,12 +435,14 @@ std::vector<char> BaseBlock::combine()
 
         for (std::size_t tube(0); tube < tubes.size(); ++tube)
         {
-            for (const auto& cell : tubes[tube])
+            const uint64_t id((block.id() + tube).getSimple());
+
+            tubes[tube].forEach([this, &data, id](uint64_t tick, uint64_t val)
             {
-                push(data, (block.id() + tube).getSimple());
-                push(data, cell.first);
-                push(data, cell.second->val());
-            }
+                push(data, id);
+                push(data, tick);
+                push(data, val);
+            });
         }
     }
 
@@ -376,17 +474,17 @@ std::set<Id> BaseBlock::merge(BaseBlock& other)
             if (block.maxPoints() == ppc)
             {
                 const Id id(block.id());
-                SparseBlock write(m_pool, m_metadata, id, m_ep, ppc);
+                SparseBlock write(m_metadata, id, m_ep, ppc);
 
                 for (std::size_t i(0); i < block.tubes().size(); ++i)
                 {
-                    for (const auto& c : block.tubes().at(i))
+                    block.tubes()[i].forEach([&](uint64_t tick, uint64_t val)
                     {
-                        write.count(id + i, c.first, c.second->val());
-                    }
+                        write.add(id + i, tick, val);
+                    });
                 }
 
-                if (!write.tubes().empty())
+                if (!write.empty())
                 {
                     if (!m_ep)
                     {
@@ -406,13 +504,12 @@ std::set<Id> BaseBlock::merge(BaseBlock& other)
 }
 
 ReadOnlySparseBlock::ReadOnlySparseBlock(
-        HierarchyCell::Pool& pool,
         const Metadata& metadata,
         const Id& id,
         const arbiter::Endpoint* outEndpoint,
         const Id& maxPoints,
         const std::vector<char>& data)
-    : HierarchyBlock(pool, metadata, id, outEndpoint, maxPoints, data.size())
+    : HierarchyBlock(metadata, id, outEndpoint, maxPoints, data.size())
 {
     // Assuming that all the Id values are within a 64-bit range, then we have
     // four uint64 values per cell.
@@ -11,13 +11,17 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <map>
 #include <set>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
-#include <entwine/third/splice-pool/splice-pool.hpp>
 #include <entwine/types/defs.hpp>
 #include <entwine/types/storage-types.hpp>
 #include <entwine/types/structure.hpp>
@@ -29,14 +33,9 @@ namespace entwine
 class HierarchyCell
 {
 public:
-    using Pool = splicer::ObjectPool<HierarchyCell>;
-    using RawNode = Pool::NodeType;
-    using RawStack = Pool::StackType;
-    using PooledNode = Pool::UniqueNodeType;
-    using PooledStack = Pool::UniqueStackType;
-
-    HierarchyCell() : m_val(0), m_spinner() { }
-    HierarchyCell(uint64_t val) : m_val(val), m_spinner() { }
+    HierarchyCell() : m_val(0) { }
+    explicit HierarchyCell(uint64_t val) : m_val(val) { }
+    HierarchyCell(const HierarchyCell& other) : m_val(other.val()) { }
 
     HierarchyCell& operator=(const HierarchyCell& other)
     {
@@ -46,19 +45,140 @@ public:
 
     HierarchyCell& count(int delta)
     {
-        SpinGuard lock(m_spinner);
-        m_val = static_cast<int>(m_val) + delta;
+        return add(static_cast<uint64_t>(static_cast<int64_t>(delta)));
+    }
+
+    HierarchyCell& add(uint64_t val)
+    {
+        m_val.fetch_add(val, std::memory_order_relaxed);
         return *this;
     }
 
-    uint64_t val() const { return m_val; }
+    uint64_t val() const { return m_val.load(std::memory_order_relaxed); }
 
 private:
-    uint64_t m_val;
-    SpinLock m_spinner;
+    std::atomic<uint64_t> m_val;
+};
+
+// A lock-free, insert-only mapping of tick to HierarchyCell.  Entries never
+// move once inserted, so a reference returned from count() remains valid for
+// the lifetime of the tube.  Most tubes only ever see a handful of ticks, so
+// those are stored inline - additional ticks spill into a chain of
+// progressively larger overflow tables.
+//
+// Only count(), add(), and get() are thread-safe.
+class HierarchyTube
+{
+public:
+    HierarchyTube() : m_slots(), m_next(nullptr) { }
+    HierarchyTube(HierarchyTube&& other) noexcept;
+    HierarchyTube& operator=(HierarchyTube&& other) noexcept;
+    ~HierarchyTube() { clear(); }
+
+    HierarchyCell& count(uint64_t tick, int delta)
+    {
+        return find(tick).count(delta);
+    }
+
+    void add(uint64_t tick, uint64_t val) { find(tick).add(val); }
+
+    uint64_t get(uint64_t tick) const;
+    bool empty() const { return !m_slots[0].used(); }
+
+    // Calls f(tick, value) for each entry in ascending tick order.
+    template<typename F> void forEach(F f) const;
+
+private:
+    struct Slot
+    {
+        Slot() : key(0), cell() { }
+
+        bool used() const { return key.load(std::memory_order_acquire); }
+        uint64_t tick() const { return key.load() - 1; }
+
+        std::atomic<uint64_t> key; // Tick plus one, or zero if empty.
+        HierarchyCell cell;
+    };
+
+    struct Table
+    {
+        explicit Table(std::size_t size) : slots(size), next(nullptr) { }
+
+        std::vector<Slot> slots;
+        std::atomic<Table*> next;
+    };
+
+    static constexpr std::size_t inlineSlots = 2;
+    static constexpr std::size_t firstTableSize = 8;
+    static constexpr std::size_t maxProbes = 8;
+
+    HierarchyCell& find(uint64_t tick);
+    void clear();
+
+    // Since slots are never vacated, and every inserter for a given key walks
+    // the same slots in the same order, the first empty slot we reach is
+    // either claimed for our key or claimed concurrently for the same key.
+    static HierarchyCell* claim(Slot* begin, Slot* end, uint64_t key)
+    {
+        for (Slot* s(begin); s != end; ++s)
+        {
+            uint64_t current(s->key.load(std::memory_order_acquire));
+
+            if (!current && s->key.compare_exchange_strong(current, key))
+            {
+                return &s->cell;
+            }
+
+            if (current == key) return &s->cell;
+        }
+
+        return nullptr;
+    }
+
+    // Returns the matching slot, nullptr if the key does not exist, or end if
+    // the search must continue into the next table.
+    static const Slot* seek(const Slot* begin, const Slot* end, uint64_t key)
+    {
+        for (const Slot* s(begin); s != end; ++s)
+        {
+            const uint64_t current(s->key.load(std::memory_order_acquire));
+            if (current == key) return s;
+            if (!current) return nullptr;
+        }
+
+        return end;
+    }
+
+    static std::size_t probeStart(const Table& table, uint64_t key)
+    {
+        const std::size_t span(table.slots.size() - maxProbes + 1);
+        return ((key * 0x9E3779B97F4A7C15ULL) >> 32) % span;
+    }
+
+    Slot m_slots[inlineSlots];
+    std::atomic<Table*> m_next;
 };
 
-using HierarchyTube = std::map<uint64_t, HierarchyCell::PooledNode>;
+template<typename F>
+void HierarchyTube::forEach(F f) const
+{
+    std::vector<std::pair<uint64_t, uint64_t>> entries;
+
+    auto add([&entries](const Slot& s)
+    {
+        if (s.used()) entries.emplace_back(s.tick(), s.cell.val());
+    });
+
+    for (const Slot& s : m_slots) add(s);
+
+    for (const Table* t(m_next.load()); t; t = t->next.load())
+    {
+        for (const Slot& s : t->slots) add(s);
+    }
+
+    std::sort(entries.begin(), entries.end());
+    for (const auto& e : entries) f(e.first, e.second);
+}
 
 namespace arbiter { class Endpoint; }
 
@@ -70,7 +190,6 @@ public:
     static std::size_t count();
 
     HierarchyBlock(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const Id& id,
             const arbiter::Endpoint* outEndpoint,
@@ -80,14 +199,12 @@ public:
     virtual ~HierarchyBlock();
 
     static std::unique_ptr<HierarchyBlock> create(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const Id& id,
             const arbiter::Endpoint* outEndpoint,
             const Id& maxPoints);
 
     static std::unique_ptr<HierarchyBlock> create(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const Id& id,
             const arbiter::Endpoint* outEndpoint,
@@ -163,7 +280,6 @@ protected:
 
     virtual std::vector<char> combine() = 0;
 
-    HierarchyCell::Pool& m_pool;
     const Metadata& m_metadata;
     Id m_id;
     const arbiter::Endpoint* m_ep;
@@ -171,6 +287,8 @@ protected:
     const std::size_t m_size;
 };
 
+// Contiguous blocks are dense arrays of tubes, so locating a tube requires no
+// synchronization and counting within it is lock-free.
 class ContiguousBlock : public HierarchyBlock
 {
     friend class BaseBlock;
@@ -179,18 +297,15 @@ public:
     using HierarchyBlock::get;
 
     ContiguousBlock(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const Id& id,
             const arbiter::Endpoint* outEndpoint,
             std::size_t maxPoints)
-        : HierarchyBlock(pool, metadata, id, outEndpoint, maxPoints, 0)
+        : HierarchyBlock(metadata, id, outEndpoint, maxPoints, 0)
         , m_tubes(maxPoints)
-        , m_spinners(maxPoints)
     { }
 
     ContiguousBlock(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const Id& id,
             const arbiter::Endpoint* outEndpoint,
@@ -204,36 +319,28 @@ public:
             uint64_t tick,
             int delta) override
     {
-        assert(global >= m_id && global < m_id + m_maxPoints);
-
-        const std::size_t id(normalize(global).getSimple());
-
-        SpinGuard lock(m_spinners.at(id));
-        auto& tube(m_tubes.at(id));
-        auto it(tube.find(tick));
-        if (it == tube.end())
-        {
-            it = tube.insert(std::make_pair(tick, m_pool.acquireOne())).first;
-        }
-        return it->second->count(delta);
+        return tube(global).count(tick, delta);
     }
 
     virtual uint64_t get(const Id& id, uint64_t tick) const override
     {
-        const HierarchyTube& tube(m_tubes.at(normalize(id).getSimple()));
-        const auto it(tube.find(tick));
-        if (it != tube.end()) return it->second->val();
-        else return 0;
+        return m_tubes.at(normalize(id).getSimple()).get(tick);
+    }
+
+    void add(const Id& global, uint64_t tick, uint64_t val)
+    {
+        tube(global).add(tick, val);
     }
 
     void merge(const ContiguousBlock& other)
     {
-        for (std::size_t tube(0); tube < other.m_tubes.size(); ++tube)
+        for (std::size_t i(0); i < other.m_tubes.size(); ++i)
         {
-            for (const auto& cell : other.m_tubes[tube])
+            const Id global(other.id() + i);
+            other.m_tubes[i].forEach([this, &global](uint64_t t, uint64_t v)
             {
-                count(other.id() + tube, cell.first, cell.second->val());
-            }
+                add(global, t, v);
+            });
         }
     }
 
@@ -247,11 +354,11 @@ protected:
             throw std::runtime_error("Hierarchy merge must be consecutive");
         }
 
-        m_maxPoints += other.tubes().size();
+        m_maxPoints += other.m_tubes.size();
         m_tubes.insert(
                 m_tubes.end(),
-                std::make_move_iterator(other.tubes().begin()),
-                std::make_move_iterator(other.tubes().end()));
+                std::make_move_iterator(other.m_tubes.begin()),
+                std::make_move_iterator(other.m_tubes.end()));
     }
 
     void clear()
@@ -264,11 +371,15 @@ protected:
 private:
     virtual std::vector<char> combine() override;
 
+    HierarchyTube& tube(const Id& global)
+    {
+        assert(global >= m_id && global < m_id + m_maxPoints);
+        return m_tubes.at(normalize(global).getSimple());
+    }
+
     bool empty() const;
-    std::vector<HierarchyTube>& tubes() { return m_tubes; }
 
     std::vector<HierarchyTube> m_tubes;
-    std::vector<SpinLock> m_spinners;
 };
 
 
@@ -278,12 +389,10 @@ public:
     using HierarchyBlock::get;
 
     BaseBlock(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const arbiter::Endpoint* outEndpoint);
 
     BaseBlock(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const arbiter::Endpoint* outEndpoint,
             const std::vector<char>& data);
@@ -314,24 +423,23 @@ private:
     std::vector<ContiguousBlock> m_blocks;
 };
 
+// Sparse tubes are spread over independently locked shards, which only guard
+// the lookup of a tube - counting within a tube is lock-free.
 class SparseBlock : public HierarchyBlock
 {
 public:
     using HierarchyBlock::get;
 
     SparseBlock(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const Id& id,
             const arbiter::Endpoint* outEndpoint,
             const Id& maxPoints)
-        : HierarchyBlock(pool, metadata, id, outEndpoint, maxPoints, 0)
-        , m_spinner()
-        , m_tubes()
+        : HierarchyBlock(metadata, id, outEndpoint, maxPoints, 0)
+        , m_shards()
     { }
 
     SparseBlock(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const Id& id,
             const arbiter::Endpoint* outEndpoint,
@@ -344,45 +452,56 @@ public:
             int delta) override
     {
         assert(id >= m_id && id < m_id + m_maxPoints);
-
-        SpinGuard lock(m_spinner);
-        auto& tube(m_tubes[normalize(id)]);
-        auto it(tube.find(tick));
-        if (it == tube.end())
-        {
-            it = tube.insert(std::make_pair(tick, m_pool.acquireOne())).first;
-        }
-        return it->second->count(delta);
+        return tube(normalize(id)).count(tick, delta);
     }
 
     virtual uint64_t get(const Id& id, uint64_t tick) const override
     {
-        const auto tubeIt(m_tubes.find(normalize(id)));
-        if (tubeIt != m_tubes.end())
-        {
-            const HierarchyTube& tube(tubeIt->second);
-            const auto cellIt(tube.find(tick));
-            if (cellIt != tube.end())
-            {
-                return cellIt->second->val();
-            }
-        }
+        const Id norm(normalize(id));
+        const auto& tubes(m_shards[shardIndex(norm)].tubes);
+        const auto it(tubes.find(norm));
+        if (it != tubes.end()) return it->second.get(tick);
+        else return 0;
+    }
 
-        return 0;
+    void add(const Id& id, uint64_t tick, uint64_t val)
+    {
+        assert(id >= m_id && id < m_id + m_maxPoints);
+        tube(normalize(id)).add(tick, val);
     }
 
-    const std::map<Id, HierarchyTube>& tubes() const { return m_tubes; }
+    bool empty() const;
 
 private:
+    struct Shard
+    {
+        SpinLock spinner;
+        std::map<Id, HierarchyTube> tubes;
+    };
+
+    static constexpr std::size_t shardBits = 6;
+
+    static std::size_t shardIndex(const Id& norm)
+    {
+        return
+            (norm.data().front() * 0x9E3779B97F4A7C15ULL) >> (64 - shardBits);
+    }
+
+    HierarchyTube& tube(const Id& norm)
+    {
+        Shard& shard(m_shards[shardIndex(norm)]);
+        SpinGuard lock(shard.spinner);
+        return shard.tubes[norm];
+    }
+
     virtual void insertCold(const Id& id, uint64_t tick, uint64_t cell) override
     {
-        m_tubes[id].emplace(tick, m_pool.acquireOne(cell));
+        tube(id).add(tick, cell);
     }
 
     virtual std::vector<char> combine() override;
 
-    SpinLock m_spinner;
-    std::map<Id, HierarchyTube> m_tubes;
+    std::array<Shard, 1 << shardBits> m_shards;
 };
 
 class ReadOnlySparseBlock : public HierarchyBlock
@@ -412,7 +531,6 @@ public:
     };
 
     ReadOnlySparseBlock(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const Id& id,
             const arbiter::Endpoint* outEndpoint,
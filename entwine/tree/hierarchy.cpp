@@ -29,14 +29,12 @@ namespace
 }
 
 Hierarchy::Hierarchy(
-        HierarchyCell::Pool& pool,
         const Metadata& metadata,
         const arbiter::Endpoint& ep,
         const arbiter::Endpoint* out,
         const bool exists,
         const bool readOnly)
     : Splitter(metadata.hierarchyStructure(), 64)
-    , m_pool(pool)
     , m_metadata(metadata)
     , m_bounds(metadata.boundsNativeCubic())
     , m_structure(metadata.hierarchyStructure())
@@ -51,7 +49,6 @@ Hierarchy::Hierarchy(
     if (!exists)
     {
         m_base.t = HierarchyBlock::create(
-                m_pool,
                 m_metadata,
                 0,
                 m_outpoint.get(),
@@ -60,7 +57,6 @@ Hierarchy::Hierarchy(
     else
     {
         m_base.t = HierarchyBlock::create(
-                m_pool,
                 m_metadata,
                 0,
                 m_outpoint.get(),
@@ -101,7 +97,6 @@ HierarchyCell& Hierarchy::count(const PointState& pointState, const int delta)
             if (slot.exists)
             {
                 block = HierarchyBlock::create(
-                        m_pool,
                         m_metadata,
                         pointState.chunkId(),
                         m_outpoint.get(),
@@ -114,7 +109,6 @@ HierarchyCell& Hierarchy::count(const PointState& pointState, const int delta)
             {
                 slot.exists = true;
                 block = HierarchyBlock::create(
-                        m_pool,
                         m_metadata,
                         pointState.chunkId(),
                         m_outpoint.get(),
@@ -146,7 +140,6 @@ HierarchyCell& Hierarchy::count(
             if (slot.exists)
             {
                 block = HierarchyBlock::create(
-                        m_pool,
                         m_metadata,
                         chunkInfo.chunkId(),
                         m_outpoint.get(),
@@ -159,7 +152,6 @@ HierarchyCell& Hierarchy::count(
             {
                 slot.exists = true;
                 block = HierarchyBlock::create(
-                        m_pool,
                         m_metadata,
                         chunkInfo.chunkId(),
                         m_outpoint.get(),
@@ -189,7 +181,6 @@ uint64_t Hierarchy::tryGet(const PointState& s) const
                 ", fast? " << (s.chunkNum() < m_fast.size()) << std::endl;
 
             block = HierarchyBlock::create(
-                    m_pool,
                     m_metadata,
                     s.chunkId(),
                     m_outpoint.get(),
@@ -240,7 +231,6 @@ void Hierarchy::awakenAll(Pool& pool) const
     iterateCold([this](const Id chunkId, std::size_t num, const Slot& slot)
     {
         slot.t = HierarchyBlock::create(
-                m_pool,
                 m_metadata,
                 chunkId,
                 m_outpoint.get(),
@@ -267,7 +257,6 @@ void Hierarchy::rebase(const arbiter::Endpoint& ep, std::size_t depth)
     m["hierarchyStructure"]["baseDepth"] = Json::UInt64(depth);
     Metadata outMeta(m);
     Hierarchy outHier(
-            m_pool,
             outMeta,
             ep,
             &ep,
@@ -295,21 +284,18 @@ void Hierarchy::rebase(const arbiter::Endpoint& ep, std::size_t depth)
         const auto id(block.id());
         for (std::size_t i(0); i < block.tubes().size(); ++i)
         {
-            for (const auto& entry : block.tubes().at(i))
+            block.tubes()[i].forEach([&](uint64_t tick, uint64_t val)
             {
                 if (curDepth < outMeta.hierarchyStructure().coldDepthBegin())
                 {
-                    outHier.countBase(
-                            id.getSimple() + i,
-                            entry.first,
-                            entry.second->val());
+                    outHier.countBase(id.getSimple() + i, tick, val);
                 }
                 else
                 {
                     ChunkInfo c(outMeta.hierarchyStructure(), id + i);
-                    outHier.count(c, entry.first, entry.second->val());
+                    outHier.count(c, tick, val);
                 }
-            }
+            });
         }
 
         ++curDepth;
@@ -36,7 +36,6 @@ class Hierarchy : public Splitter<HierarchyBlock>
 {
 public:
     Hierarchy(
-            HierarchyCell::Pool& pool,
             const Metadata& metadata,
             const arbiter::Endpoint& top,
             const arbiter::Endpoint* topOut,
@@ -49,8 +48,6 @@ public:
 
         iterateCold([this](const Id& chunkId, std::size_t num, const Slot& slot)
         {
-            // We need to release our pooled block nodes back into our pool
-            // so the parent destructor doesn't release them into a stale pool.
             slot.t.reset();
         });
     }
@@ -83,7 +80,6 @@ public:
     using Slots = std::set<const Slot*>;
 
 protected:
-    HierarchyCell::Pool& m_pool;
     const Metadata& m_metadata;
     const Bounds& m_bounds;
     const Structure& m_structure;
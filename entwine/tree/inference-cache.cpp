@@ -0,0 +1,136 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/tree/inference-cache.hpp>
+
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+
+#include <entwine/util/executor.hpp>
+#include <entwine/util/json.hpp>
+#include <entwine/util/unique.hpp>
+
+namespace entwine
+{
+
+namespace
+{
+    // FNV-1a, which is stable across platforms and runs unlike std::hash.
+    uint64_t fnv(const std::string& s)
+    {
+        uint64_t h(14695981039346656037ULL);
+        for (const char c : s)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    std::string modified(const std::string& path)
+    {
+        struct stat s;
+        if (stat(path.c_str(), &s) != 0) return std::string();
+        return std::to_string(static_cast<int64_t>(s.st_mtime));
+    }
+}
+
+InferenceCache::InferenceCache(
+        arbiter::Arbiter& arbiter,
+        const std::string path,
+        const Json::Value& settings)
+    : m_arbiter(arbiter)
+    , m_endpoint(arbiter.getEndpoint(path))
+    , m_settings(toFastString(settings))
+    , m_hits(0)
+    , m_misses(0)
+{
+    if (m_endpoint.isLocal()) arbiter::fs::mkdirp(m_endpoint.root());
+}
+
+std::string InferenceCache::identify(const std::string& path) const
+{
+    std::unique_ptr<std::size_t> size;
+    try { size = m_arbiter.tryGetSize(path); }
+    catch (...) { }
+
+    if (!size) return std::string();
+
+    std::string identity(path + '\n' + std::to_string(*size) + '\n');
+
+    if (m_arbiter.isLocal(path))
+    {
+        const std::string mtime(modified(arbiter::fs::expandTilde(path)));
+        if (mtime.empty()) return std::string();
+        identity += mtime + '\n';
+    }
+
+    return identity + m_settings;
+}
+
+std::string InferenceCache::filename(const std::string& identity) const
+{
+    std::ostringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << fnv(identity) <<
+        ".json";
+    return ss.str();
+}
+
+std::unique_ptr<Preview> InferenceCache::get(const std::string& identity)
+{
+    std::unique_ptr<Preview> preview;
+
+    if (auto data = m_endpoint.tryGetBinary(filename(identity)))
+    {
+        try
+        {
+            const Json::Value json(
+                    parse(std::string(data->begin(), data->end())));
+
+            // Guard against hash collisions.
+            if (json["identity"].asString() == identity)
+            {
+                preview = makeUnique<Preview>(json["preview"]);
+            }
+        }
+        catch (...) { }
+    }
+
+    ++(preview ? m_hits : m_misses);
+    return preview;
+}
+
+void InferenceCache::put(const std::string& identity, const Preview& preview)
+{
+    Json::Value json;
+    json["identity"] = identity;
+    json["preview"] = preview.toJson();
+
+    // The cache is best-effort - a failed write only costs a future miss.
+    try { m_endpoint.put(filename(identity), toFastString(json)); }
+    catch (...) { }
+}
+
+Json::Value InferenceCache::toJson() const
+{
+    const std::size_t total(m_hits + m_misses);
+
+    Json::Value json;
+    json["hits"] = static_cast<Json::UInt64>(m_hits);
+    json["misses"] = static_cast<Json::UInt64>(m_misses);
+    json["hitRate"] = total ? static_cast<double>(m_hits) / total : 0.0;
+    return json;
+}
+
+} // namespace entwine
+
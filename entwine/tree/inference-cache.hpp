@@ -0,0 +1,68 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <json/json.h>
+
+#include <entwine/third/arbiter/arbiter.hpp>
+
+namespace entwine
+{
+
+class Preview;
+
+// A persistent cache of per-file inference results, so rebuilding the same
+// source data with different settings doesn't need to re-read every input.
+//
+// Entries are content-addressed by file identity: the path, its size, and
+// its modification time when the file is local.  Remote drivers only expose
+// sizes, so for those the path and size identify the file.
+class InferenceCache
+{
+public:
+    // The settings should capture anything, like the reprojection, that
+    // changes the inference results for an otherwise identical file.
+    InferenceCache(
+            arbiter::Arbiter& arbiter,
+            std::string path,
+            const Json::Value& settings);
+
+    // Returns an empty string if the identity of this file can't be
+    // determined, in which case it can't be cached.
+    std::string identify(const std::string& path) const;
+
+    // Returns null on a miss.
+    std::unique_ptr<Preview> get(const std::string& identity);
+    void put(const std::string& identity, const Preview& preview);
+
+    std::size_t hits() const { return m_hits; }
+    std::size_t misses() const { return m_misses; }
+
+    Json::Value toJson() const;
+
+private:
+    std::string filename(const std::string& identity) const;
+
+    arbiter::Arbiter& m_arbiter;
+    arbiter::Endpoint m_endpoint;
+    const std::string m_settings;
+
+    std::atomic_size_t m_hits;
+    std::atomic_size_t m_misses;
+};
+
+} // namespace entwine
+
@@ -10,14 +10,18 @@
 
 #include <entwine/tree/inference.hpp>
 
+#include <cmath>
+#include <fstream>
 #include <limits>
 
 #include <entwine/tree/builder.hpp>
 #include <entwine/tree/config-parser.hpp>
+#include <entwine/tree/heuristics.hpp>
 #include <entwine/tree/thread-pools.hpp>
 #include <entwine/types/reprojection.hpp>
 #include <entwine/types/pooled-point-table.hpp>
 #include <entwine/util/executor.hpp>
+#include <entwine/util/las.hpp>
 #include <entwine/util/matrix.hpp>
 #include <entwine/util/unique.hpp>
 
@@ -26,12 +30,13 @@ namespace entwine
 
 namespace
 {
-    const arbiter::http::Headers range(([]()
+    arbiter::http::Headers range(const uint64_t begin, const uint64_t end)
     {
         arbiter::http::Headers h;
-        h["Range"] = "bytes=0-16384";
+        h["Range"] =
+            "bytes=" + std::to_string(begin) + "-" + std::to_string(end - 1);
         return h;
-    })());
+    }
 
     const Schema xyzSchema({
         { pdal::Dimension::Id::X },
@@ -77,7 +82,12 @@ Inference::Inference(Builder& builder, const FileInfoList& fileInfo)
             builder.verbose(),
             false,  // Adding to existing index isn't allowed for Cesium.
             &builder.arbiter())
-{ }
+{
+    if (const Transformation* t = builder.metadata().transformation())
+    {
+        m_transformation = makeUnique<Transformation>(*t);
+    }
+}
 
 Inference::Inference(
         const Paths& paths,
@@ -149,7 +159,18 @@ void Inference::go()
         throw std::runtime_error("Cannot call Inference::go twice");
     }
 
-    m_pool = makeUnique<Pool>(m_threads);
+    if (m_cachePath.size())
+    {
+        m_cache = makeUnique<InferenceCache>(
+                *m_arbiter,
+                m_cachePath,
+                cacheSettings());
+    }
+
+    const bool headersOnly(m_trustHeaders || m_sample);
+    m_pool = makeUnique<Pool>(
+            headersOnly ?
+                m_threads * heuristics::headerThreadsFactor : m_threads);
     const std::size_t size(m_fileInfo.size());
 
     for (std::size_t i(0); i < size; ++i)
@@ -165,33 +186,7 @@ void Inference::go()
 
         if (Executor::get().good(f.path()))
         {
-            if (m_trustHeaders && m_arbiter->isHttpDerived(f.path()))
-            {
-                m_pool->add([this, &f]()
-                {
-                    const auto data(m_arbiter->getBinary(f.path(), range));
-
-                    std::string name(f.path());
-                    std::replace(name.begin(), name.end(), '/', '-');
-                    std::replace(name.begin(), name.end(), '\\', '-');
-
-                    m_tmp.put(name, data);
-
-                    add(m_tmp.fullPath(name), f);
-
-                    arbiter::fs::remove(m_tmp.fullPath(name));
-                });
-            }
-            else
-            {
-                m_pool->add([&f, this]()
-                {
-                    auto localHandle(
-                        m_arbiter->getLocalHandle(f.path(), m_tmp));
-
-                    add(localHandle->localPath(), f);
-                });
-            }
+            m_pool->add([this, &f]() { add(f); });
         }
         else
         {
@@ -201,6 +196,15 @@ void Inference::go()
 
     m_pool->join();
 
+    if (m_cache)
+    {
+        const auto json(m_cache->toJson());
+        std::cout << "Inference cache: " << json["hits"].asUInt64() <<
+            " hits, " << json["misses"].asUInt64() << " misses (" <<
+            std::round(json["hitRate"].asDouble() * 100.0) << "%)" <<
+            std::endl;
+    }
+
     if (!m_valid)
     {
         throw std::runtime_error("No point cloud files found");
@@ -209,13 +213,12 @@ void Inference::go()
     aggregate();
     makeSchema();
 
+    // A transformation given up front has been applied to each file as it
+    // was previewed, so only one calculated from those results remains.
     if (m_cesiumify && !m_transformation)
     {
         m_transformation = makeUnique<Transformation>(calcTransformation());
-    }
 
-    if (m_transformation)
-    {
         std::cout << "Transforming inference" << std::endl;
         for (auto& f : m_fileInfo)
         {
@@ -322,69 +325,352 @@ Transformation Inference::calcTransformation()
     return matrix::multiply(translation, rotation);
 }
 
-void Inference::add(const std::string localPath, FileInfo& fileInfo)
+void Inference::sample(const double fraction)
 {
-    std::unique_ptr<Preview> preview(
-            Executor::get().preview(localPath, m_reproj.get()));
+    if (fraction <= 0 || fraction > 1)
+    {
+        throw std::runtime_error(
+                "Invalid sample fraction: " + std::to_string(fraction));
+    }
+
+    m_sample = fraction;
+}
 
-    auto update([this, &fileInfo](
-                std::size_t numPoints,
-                const Bounds& bounds,
-                const Json::Value* metadata)
+Json::Value Inference::cacheSettings() const
+{
+    Json::Value settings;
+    settings["trustHeaders"] = m_trustHeaders;
+    if (!m_trustHeaders && m_sample) settings["sample"] = m_sample;
+    if (m_reproj) settings["reprojection"] = m_reproj->toJson();
+    if (m_transformation)
     {
-        m_valid = true;
+        settings["transformation"] = toJsonArray(*m_transformation);
+    }
+    return settings;
+}
 
-        fileInfo.numPoints(numPoints);
-        fileInfo.bounds(bounds);
-        if (metadata) fileInfo.metadata(*metadata);
-    });
+void Inference::add(FileInfo& fileInfo)
+{
+    const std::string& path(fileInfo.path());
+    std::string identity;
+
+    if (m_cache)
+    {
+        identity = m_cache->identify(path);
+
+        if (!identity.empty())
+        {
+            if (auto preview = m_cache->get(identity))
+            {
+                add(*preview, fileInfo);
+                return;
+            }
+        }
+    }
+
+    std::unique_ptr<Preview> preview;
+
+    if ((m_trustHeaders || m_sample) && las::good(path))
+    {
+        preview = previewHeader(fileInfo);
+    }
+    else if (m_trustHeaders && m_arbiter->isHttpDerived(path))
+    {
+        preview = previewRemote(
+                fileInfo,
+                m_arbiter->getBinary(path, range(0, las::initialHeaderBytes)));
+    }
+    else
+    {
+        auto localHandle(m_arbiter->getLocalHandle(path, m_tmp));
+        preview = previewLocal(localHandle->localPath());
+    }
 
     if (preview)
     {
+        add(*preview, fileInfo);
+        if (!identity.empty()) m_cache->put(identity, *preview);
+    }
+}
+
+std::vector<char> Inference::fetch(
+        const std::string& path,
+        const uint64_t begin,
+        const uint64_t end) const
+{
+    if (m_arbiter->isHttpDerived(path))
+    {
+        return m_arbiter->getBinary(path, range(begin, end));
+    }
+    else if (m_arbiter->isLocal(path))
+    {
+        std::ifstream stream(
+                arbiter::fs::expandTilde(path),
+                std::ifstream::in | std::ifstream::binary);
+        stream.seekg(begin);
+
+        std::vector<char> data(end - begin);
+        stream.read(data.data(), data.size());
+        data.resize(stream.gcount());
+        return data;
+    }
+    else
+    {
+        const auto data(m_arbiter->getBinary(path));
+        if (begin >= data.size()) return std::vector<char>();
+        return std::vector<char>(
+                data.begin() + begin,
+                data.begin() + std::min<uint64_t>(end, data.size()));
+    }
+}
+
+std::unique_ptr<Preview> Inference::previewHeader(const FileInfo& fileInfo)
+{
+    const std::string& path(fileInfo.path());
+
+    std::vector<char> data(fetch(path, 0, las::initialHeaderBytes));
+    std::unique_ptr<las::Header> header;
+
+    try
+    {
+        header = makeUnique<las::Header>(data);
+
+        if (header->size() > data.size())
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            fileInfo.srs(preview->srs);
+            data = fetch(path, 0, header->size());
+            header = makeUnique<las::Header>(data);
+        }
+    }
+    catch (std::exception&)
+    {
+        header.reset();
+    }
 
-            if (preview->numPoints)
-            {
-                if (preview->scale)
-                {
-                    const auto& scale(*preview->scale);
-
-                    if (!scale.x || !scale.y || !scale.z)
-                    {
-                        std::cout << "Scale: " << scale << std::endl;
-                        throw std::runtime_error(
-                                "Invalid scale at " + fileInfo.path());
-                    }
-
-                    if (m_delta)
-                    {
-                        m_delta->scale() = Point::min(m_delta->scale(), scale);
-                    }
-                    else if (m_allowDelta)
-                    {
-                        m_delta = makeUnique<Delta>(scale, Offset(0));
-                    }
-                }
+    std::unique_ptr<Preview> preview(header ? header->preview() : nullptr);
 
-                for (const auto& d : preview->dimNames)
-                {
-                    if (!m_dimSet.count(d))
-                    {
-                        m_dimSet.insert(d);
-                        m_dimVec.push_back(d);
-                    }
-                }
-            }
+    if (preview && !m_trustHeaders)
+    {
+        if (!previewSample(fileInfo, *header, *preview)) preview.reset();
+    }
+
+    // Not something we can interpret without PDAL.  If we trust the headers,
+    // then our data covers the entire header so a remote file won't need to
+    // be fetched again.  Otherwise we'll need to read the whole thing.
+    if (!preview)
+    {
+        if (m_arbiter->isLocal(path))
+        {
+            return previewLocal(arbiter::fs::expandTilde(path));
+        }
+        else if (m_trustHeaders)
+        {
+            return previewRemote(fileInfo, data);
+        }
+        else
+        {
+            auto localHandle(m_arbiter->getLocalHandle(path, m_tmp));
+            return previewLocal(localHandle->localPath());
         }
+    }
+
+    if (preview->srs.empty() && !header->geotiff().empty())
+    {
+        preview->srs = geotiffSrs(fileInfo, *header, data);
+    }
+
+    if (m_reproj && preview->numPoints)
+    {
+        preview->bounds = Executor::get().reproject(
+                preview->bounds,
+                preview->srs,
+                *m_reproj);
+        preview->srs = Executor::get().getSrsString(m_reproj->out());
+    }
+
+    // Sampled points have already been transformed, unless they needed to be
+    // reprojected first.
+    if (
+            m_transformation &&
+            preview->numPoints &&
+            (m_trustHeaders || m_reproj))
+    {
+        preview->bounds = Executor::get().transform(
+                preview->bounds,
+                *m_transformation);
+    }
+
+    return preview;
+}
+
+bool Inference::previewSample(
+        const FileInfo& fileInfo,
+        const las::Header& header,
+        Preview& preview) const
+{
+    const std::string& path(fileInfo.path());
+
+    const auto size(m_arbiter->tryGetSize(path));
+    if (!size) return false;
+
+    // This count comes from the file size, so it doesn't trust the header.
+    const uint64_t records(header.numRecords(*size));
+    if (!records) return false;
+
+    const uint64_t target(
+            std::min<uint64_t>(
+                records,
+                std::max<uint64_t>(
+                    std::ceil(records * m_sample),
+                    heuristics::sampleMin)));
+    const uint64_t runs(std::min<uint64_t>(heuristics::sampleRuns, target));
+    const uint64_t perRun((target + runs - 1) / runs);
+
+    // A reprojection comes before the transformation, and may only be applied
+    // to the resulting bounds.  Otherwise, transform each sampled point.
+    const Transformation* transformation(
+            m_reproj ? nullptr : m_transformation.get());
+
+    Bounds bounds(Bounds::expander());
+
+    for (uint64_t run(0); run < runs; ++run)
+    {
+        const uint64_t begin(run * records / runs);
+        const uint64_t end(std::min(begin + perRun, records));
+
+        header.grow(
+                bounds,
+                fetch(
+                    path,
+                    header.recordOffset(begin),
+                    header.recordOffset(end)),
+                transformation);
+    }
+
+    preview.numPoints = records;
+    preview.sampled = target < records;
+    preview.bounds = preview.sampled ?
+        bounds.growBy(heuristics::sampleMargin) : bounds;
+
+    return true;
+}
+
+std::string Inference::geotiffSrs(
+        const FileInfo& fileInfo,
+        const las::Header& header,
+        const std::vector<char>& data)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it(m_geotiffSrs.find(header.geotiff()));
+        if (it != m_geotiffSrs.end()) return it->second;
+    }
+
+    // Translating GeoTIFF keys to WKT requires PDAL, but a set of inputs
+    // typically shares a single SRS so we only need to do this once.
+    std::unique_ptr<Preview> preview;
+
+    if (m_arbiter->isLocal(fileInfo.path()))
+    {
+        preview = Executor::get().preview(
+                arbiter::fs::expandTilde(fileInfo.path()));
+    }
+    else
+    {
+        const std::string name(tmpName(fileInfo.path()));
+        m_tmp.put(name, data);
+        preview = Executor::get().preview(m_tmp.fullPath(name));
+        arbiter::fs::remove(m_tmp.fullPath(name));
+    }
+
+    const std::string srs(preview ? preview->srs : std::string());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_geotiffSrs[header.geotiff()] = srs;
+    return srs;
+}
+
+std::unique_ptr<Preview> Inference::previewRemote(
+        const FileInfo& fileInfo,
+        const std::vector<char>& data)
+{
+    const std::string name(tmpName(fileInfo.path()));
+
+    m_tmp.put(name, data);
+
+    auto preview(previewLocal(m_tmp.fullPath(name)));
+
+    arbiter::fs::remove(m_tmp.fullPath(name));
 
-        if (m_trustHeaders)
+    return preview;
+}
+
+std::string Inference::tmpName(std::string path) const
+{
+    std::replace(path.begin(), path.end(), '/', '-');
+    std::replace(path.begin(), path.end(), '\\', '-');
+    return path;
+}
+
+void Inference::add(const Preview& preview, FileInfo& fileInfo)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_valid = true;
+
+    fileInfo.srs(preview.srs);
+    fileInfo.numPoints(preview.numPoints);
+    fileInfo.bounds(preview.bounds);
+    fileInfo.sampled(preview.sampled);
+    if (!preview.metadata.isNull()) fileInfo.metadata(preview.metadata);
+
+    if (!preview.numPoints) return;
+
+    if (preview.scale)
+    {
+        const auto& scale(*preview.scale);
+
+        if (!scale.x || !scale.y || !scale.z)
+        {
+            std::cout << "Scale: " << scale << std::endl;
+            throw std::runtime_error("Invalid scale at " + fileInfo.path());
+        }
+
+        if (m_delta)
+        {
+            m_delta->scale() = Point::min(m_delta->scale(), scale);
+        }
+        else if (m_allowDelta)
+        {
+            m_delta = makeUnique<Delta>(scale, Offset(0));
+        }
+    }
+
+    for (const auto& d : preview.dimNames)
+    {
+        if (!m_dimSet.count(d))
         {
-            update(preview->numPoints, preview->bounds, &preview->metadata);
-            return;
+            m_dimSet.insert(d);
+            m_dimVec.push_back(d);
         }
     }
+}
+
+std::unique_ptr<Preview> Inference::previewLocal(const std::string localPath)
+{
+    std::unique_ptr<Preview> preview(
+            Executor::get().preview(localPath, m_reproj.get()));
+
+    if (preview && m_trustHeaders)
+    {
+        if (m_transformation && preview->numPoints)
+        {
+            preview->bounds = Executor::get().transform(
+                    preview->bounds,
+                    *m_transformation);
+        }
+
+        return preview;
+    }
 
     Bounds curBounds(Bounds::expander());
     std::size_t curNumPoints(0);
@@ -400,28 +686,28 @@ void Inference::add(const std::string localPath, FileInfo& fileInfo)
 
     PooledPointTable table(m_pointPool, tracker, invalidOrigin);
 
-    if (Executor::get().run(
+    if (!Executor::get().run(
                 table,
                 localPath,
                 m_reproj.get(),
                 m_transformation.get()))
     {
-        if (!curNumPoints) curBounds = Bounds();
+        return nullptr;
+    }
 
-        update(curNumPoints, curBounds, nullptr);
+    auto result(makeUnique<Preview>());
+    result->numPoints = curNumPoints;
+    if (curNumPoints) result->bounds = curBounds;
 
-        if (curNumPoints)
-        {
-            for (const auto& d : Executor::get().dims(localPath))
-            {
-                if (!m_dimSet.count(d))
-                {
-                    m_dimSet.insert(d);
-                    m_dimVec.push_back(d);
-                }
-            }
-        }
+    if (preview)
+    {
+        result->srs = preview->srs;
+        result->scale = std::move(preview->scale);
     }
+
+    if (curNumPoints) result->dimNames = Executor::get().dims(localPath);
+
+    return result;
 }
 
 void Inference::aggregate()
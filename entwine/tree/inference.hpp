@@ -11,6 +11,7 @@
 #pragma once
 
 #include <cstddef>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -19,6 +20,7 @@
 #include <pdal/SpatialReference.hpp>
 
 #include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/tree/inference-cache.hpp>
 #include <entwine/types/bounds.hpp>
 #include <entwine/types/delta.hpp>
 #include <entwine/types/file-info.hpp>
@@ -31,8 +33,11 @@ namespace entwine
 {
 
 class Builder;
+class Preview;
 class Reprojection;
 
+namespace las { class Header; }
+
 class Inference
 {
 public:
@@ -100,6 +105,17 @@ public:
         m_transformation = makeUnique<std::vector<double>>(t);
     }
 
+    // Consult and populate a persistent cache of per-file results at this
+    // path.
+    void cache(std::string path) { m_cachePath = path; }
+    const InferenceCache* cache() const { return m_cache.get(); }
+
+    // When headers aren't trusted, estimate the bounds of each file from this
+    // fraction of its points rather than reading all of them.  This is only
+    // possible for uncompressed LAS - other files are still read in full.
+    void sample(double fraction);
+    double sample() const { return m_sample; }
+
     Json::Value toJson() const;
 
 private:
@@ -107,7 +123,40 @@ private:
     void makeSchema();  // Figure out schema and delta.
     void check() const; // Verify that our inference is valid - otherwise throw.
 
-    void add(std::string localPath, FileInfo& fileInfo);
+    // Infer a single file, consulting the cache first if there is one.
+    void add(FileInfo& fileInfo);
+    void add(const Preview& preview, FileInfo& fileInfo);
+
+    // Preview a LAS/LAZ file from a range read of its header, without PDAL.
+    std::unique_ptr<Preview> previewHeader(const FileInfo& fileInfo);
+
+    // Preview a remote file from a local copy of its leading bytes.
+    std::unique_ptr<Preview> previewRemote(
+            const FileInfo& fileInfo,
+            const std::vector<char>& data);
+
+    // Preview from the file header if we trust it, or else by reading every
+    // point.
+    std::unique_ptr<Preview> previewLocal(std::string localPath);
+
+    // Sample the point records of an uncompressed LAS file to estimate its
+    // bounds.  Returns false if its records can't be addressed directly.
+    bool previewSample(
+            const FileInfo& fileInfo,
+            const las::Header& header,
+            Preview& preview) const;
+
+    std::vector<char> fetch(
+            const std::string& path,
+            uint64_t begin,
+            uint64_t end) const;
+    std::string geotiffSrs(
+            const FileInfo& fileInfo,
+            const las::Header& header,
+            const std::vector<char>& data);
+    std::string tmpName(std::string path) const;
+    Json::Value cacheSettings() const;
+
     Transformation calcTransformation();
 
     std::string m_tmpPath;
@@ -117,6 +166,7 @@ private:
     std::size_t m_threads = 4;
     bool m_verbose = true;
     bool m_trustHeaders = true;
+    double m_sample = 0;
     bool m_allowDelta = true;
     bool m_valid = false;
     bool m_done = false;
@@ -137,6 +187,9 @@ private:
     std::unique_ptr<Schema> m_schema;
     std::unique_ptr<Delta> m_delta;
     std::vector<std::string> m_srsList;
+    std::map<std::string, std::string> m_geotiffSrs;
+    std::string m_cachePath;
+    std::unique_ptr<InferenceCache> m_cache;
 
     FileInfoList m_fileInfo;
 
@@ -8,6 +8,8 @@
 *
 ******************************************************************************/
 
+#include <algorithm>
+
 #include <entwine/tree/builder.hpp>
 #include <entwine/tree/merger.hpp>
 #include <entwine/tree/thread-pools.hpp>
@@ -15,6 +17,7 @@
 #include <entwine/types/metadata.hpp>
 #include <entwine/types/subset.hpp>
 #include <entwine/util/pool.hpp>
+#include <entwine/util/time.hpp>
 #include <entwine/util/unique.hpp>
 
 namespace entwine
@@ -54,7 +57,6 @@ Merger::Merger(
 
     m_builder->verbose(m_verbose);
     m_outerScope->setPointPool(m_builder->sharedPointPool());
-    m_outerScope->setHierarchyPool(m_builder->sharedHierarchyPool());
 
     if (const Subset* subset = m_builder->metadata().subset())
     {
@@ -78,21 +80,25 @@ void Merger::go()
     m_builder->unbump();
 
     Pool pool(m_threads);
-    std::size_t fetches(static_cast<float>(pool.size()) * 1.2);
+    const std::size_t fetches(
+            std::max<std::size_t>(static_cast<float>(pool.size()) * 1.2, 2));
+
+    const auto begin(now());
+    std::size_t loadMs(0);
+    std::size_t reduceMs(0);
+    std::size_t mergeMs(0);
 
     while (m_pos < total())
     {
         const std::size_t n(std::min(fetches, total() - m_pos));
         std::vector<std::unique_ptr<Builder>> builders(n);
 
-        for (auto& b : builders)
+        auto start(now());
+
+        for (std::size_t i(0); i < n; ++i)
         {
-            const std::size_t id(m_pos++);
-            if (m_verbose)
-            {
-                std::cout << "Merging " << m_pos << " / " << total() <<
-                    std::endl;
-            }
+            const std::size_t id(m_pos + i);
+            auto& b(builders[i]);
 
             pool.add([this, &b, id]()
             {
@@ -105,6 +111,7 @@ void Merger::go()
                         *m_outerScope);
 
                 if (!b) std::cout << "Create failed: " << id << std::endl;
+                else b->unbump();
             });
         }
 
@@ -114,16 +121,75 @@ void Merger::go()
         {
             if (!b) throw std::runtime_error("Couldn't create subset");
             b->verbose(m_verbose);
-            m_builder->merge(*b);
+        }
+
+        loadMs += since<std::chrono::milliseconds>(start);
+        start = now();
+
+        reduce(builders, pool);
+
+        reduceMs += since<std::chrono::milliseconds>(start);
+        start = now();
+
+        m_builder->merge(*builders.front());
+        m_pos += n;
+
+        mergeMs += since<std::chrono::milliseconds>(start);
+
+        if (m_verbose)
+        {
+            std::cout << "Merged " << m_pos << " / " << total() <<
+                " - load: " << loadMs / 1000.0 << "s" <<
+                ", reduce: " << reduceMs / 1000.0 << "s" <<
+                ", merge: " << mergeMs / 1000.0 << "s" << std::endl;
         }
     }
 
     m_builder->makeWhole();
 
     if (m_verbose) std::cout << "Merge complete.  Saving..." << std::endl;
+
+    const auto start(now());
     m_builder->save();
     m_builder.reset();
-    if (m_verbose) std::cout << "\tFinal save complete." << std::endl;
+
+    if (m_verbose)
+    {
+        std::cout << "\tFinal save complete - save: " <<
+            since<std::chrono::milliseconds>(start) / 1000.0 << "s" <<
+            ", total: " << since<std::chrono::milliseconds>(begin) / 1000.0 <<
+            "s" << std::endl;
+    }
+}
+
+void Merger::reduce(
+        std::vector<std::unique_ptr<Builder>>& builders,
+        Pool& pool)
+{
+    // Base chunks may only be appended to the subset immediately preceding
+    // them, so we reduce adjacent pairs, doubling the stride each round.
+    // Within a round, every merge is independent.
+    for (std::size_t stride(1); stride < builders.size(); stride *= 2)
+    {
+        for (std::size_t i(0); i + stride < builders.size(); i += stride * 2)
+        {
+            pool.add([&builders, i, stride]()
+            {
+                builders[i]->merge(*builders[i + stride]);
+                builders[i + stride].reset();
+            });
+        }
+
+        pool.cycle();
+
+        for (std::size_t i(0); i + stride < builders.size(); i += stride * 2)
+        {
+            if (builders[i + stride])
+            {
+                throw std::runtime_error("Subset merge failed");
+            }
+        }
+    }
 }
 
 } // namespace entwine
@@ -21,6 +21,7 @@ namespace arbiter { class Arbiter; }
 
 class Builder;
 class OuterScope;
+class Pool;
 
 class Merger
 {
@@ -39,6 +40,9 @@ public:
     std::size_t total() const { return m_of; }
 
 private:
+    // Merge a run of consecutive subsets into the first of them.
+    void reduce(std::vector<std::unique_ptr<Builder>>& builders, Pool& pool);
+
     std::unique_ptr<Builder> m_builder;
     std::string m_path;
     std::vector<std::size_t> m_others;
@@ -0,0 +1,139 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/tree/resolver.hpp>
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+#include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/tree/config-parser.hpp>
+
+namespace entwine
+{
+
+namespace
+{
+    std::size_t countEntries(const Json::Value& input)
+    {
+        if (input.isArray()) return input.size();
+        else if (input.isString()) return 1;
+        else return 0;
+    }
+}
+
+Resolver::Resolver(
+        const arbiter::Arbiter& arbiter,
+        const Json::Value& input,
+        const std::size_t threads,
+        const bool verbose)
+    : m_arbiter(arbiter)
+    , m_verbose(verbose)
+    , m_slots(countEntries(input))
+    , m_pool(
+            std::max<std::size_t>(
+                std::min<std::size_t>(threads, m_slots.size()), 1),
+            std::max<std::size_t>(m_slots.size(), 1))
+{
+    if (input.isString())
+    {
+        m_pool.add([this, input]() { resolve(0, input.asString()); });
+        return;
+    }
+
+    for (std::size_t i(0); i < m_slots.size(); ++i)
+    {
+        const Json::Value& entry(input[Json::ArrayIndex(i)]);
+
+        if (entry.isString())
+        {
+            const std::string path(entry.asString());
+            m_pool.add([this, i, path]() { resolve(i, path); });
+        }
+        else
+        {
+            Slot& slot(m_slots[i]);
+            slot.fileInfo.emplace_back(entry);
+            slot.done = true;
+        }
+    }
+}
+
+Resolver::~Resolver()
+{
+    m_pool.join();
+}
+
+void Resolver::resolve(const std::size_t index, const std::string path)
+{
+    FileInfoList fileInfo;
+    std::string error;
+
+    try
+    {
+        Paths current(
+                m_arbiter.resolve(ConfigParser::directorify(path), m_verbose));
+        std::sort(current.begin(), current.end());
+
+        fileInfo.reserve(current.size());
+        for (const auto& c : current) fileInfo.emplace_back(c);
+    }
+    catch (const std::exception& e)
+    {
+        error = "Could not resolve " + path + ": " + e.what();
+    }
+    catch (...)
+    {
+        error = "Could not resolve " + path;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Slot& slot(m_slots[index]);
+        slot.fileInfo = std::move(fileInfo);
+        slot.error = error;
+        slot.done = true;
+    }
+
+    m_cv.notify_all();
+}
+
+bool Resolver::next(FileInfoList& fileInfo)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_index >= m_slots.size()) return false;
+
+    Slot& slot(m_slots[m_index++]);
+    m_cv.wait(lock, [&slot]() { return slot.done; });
+
+    if (!slot.error.empty()) throw std::runtime_error(slot.error);
+
+    fileInfo.insert(fileInfo.end(), slot.fileInfo.begin(), slot.fileInfo.end());
+    FileInfoList().swap(slot.fileInfo);
+    return true;
+}
+
+FileInfoList Resolver::all()
+{
+    FileInfoList fileInfo;
+    while (next(fileInfo)) { }
+
+    if (m_verbose)
+    {
+        std::cout << "Resolved " << fileInfo.size() << " paths from " <<
+            m_slots.size() << " inputs" << std::endl;
+    }
+
+    return fileInfo;
+}
+
+} // namespace entwine
+
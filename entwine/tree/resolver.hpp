@@ -0,0 +1,83 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include <entwine/types/file-info.hpp>
+#include <entwine/util/pool.hpp>
+
+namespace entwine
+{
+
+namespace arbiter { class Arbiter; }
+
+// Expands the entries of an input list into files.  String entries are paths,
+// directories, or globs, which are listed concurrently - one listing per
+// entry - as soon as the Resolver is constructed.  Object entries are
+// FileInfo and are passed through as they are.
+//
+// Results are delivered in input order, and the files of each entry are
+// sorted, so the resolved list is the same as if the entries had been listed
+// serially.  A consumer may start on the files of the first entries while
+// later ones are still being listed.
+class Resolver
+{
+public:
+    Resolver(
+            const arbiter::Arbiter& arbiter,
+            const Json::Value& input,
+            std::size_t threads,
+            bool verbose = false);
+
+    // Waits for any outstanding listings.
+    ~Resolver();
+
+    // Blocks until the next entry has been resolved and appends its files to
+    // the list.  Returns false, leaving the list untouched, once every entry
+    // has been consumed.  Throws if the listing of that entry failed.
+    bool next(FileInfoList& fileInfo);
+
+    // Everything not yet consumed by next().
+    FileInfoList all();
+
+    std::size_t size() const { return m_slots.size(); }
+
+private:
+    struct Slot
+    {
+        bool done = false;
+        FileInfoList fileInfo;
+        std::string error;
+    };
+
+    void resolve(std::size_t index, std::string path);
+
+    const arbiter::Arbiter& m_arbiter;
+    const bool m_verbose;
+
+    std::vector<Slot> m_slots;
+    std::size_t m_index = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+
+    Pool m_pool;
+};
+
+} // namespace entwine
+
@@ -32,27 +32,56 @@ Sequence::Sequence(Builder& builder)
 {
     if (!m_manifest) return;
 
+    scan(m_origin, m_end);
+
+    if (builder.verbose() && m_metadata.subset())
+    {
+        std::cout << "Overlaps: " << m_overlaps.size() << std::endl;
+    }
+
+    m_origin = m_overlaps.empty() ? m_end : m_overlaps.front();
+}
+
+void Sequence::extend()
+{
+    auto lock(getLock());
+    if (!m_manifest || m_stopped) return;
+
+    const Origin begin(m_end);
+    const Origin end(m_manifest->size());
+    if (end <= begin) return;
+
+    const std::size_t overlaps(m_overlaps.size());
+    scan(begin, end);
+
+    // If we had already run off the end, skip ahead to the first new file
+    // that we'll want.
+    if (m_origin >= begin)
+    {
+        m_origin = overlaps < m_overlaps.size() ? m_overlaps[overlaps] : end;
+    }
+
+    m_end = end;
+}
+
+void Sequence::scan(const Origin begin, const Origin end)
+{
     const Bounds activeBounds(
             m_metadata.subset() ?
                 *m_metadata.boundsNativeSubset() :
                 m_metadata.boundsNativeCubic());
 
-    for (Origin i(m_origin); i < m_end; ++i)
+    const Manifest& manifest(*m_manifest);
+
+    for (Origin i(begin); i < end; ++i)
     {
-        const FileInfo& f(m_manifest->get(i));
+        const FileInfo& f(manifest.get(i));
 
         if (!f.boundsEpsilon() || activeBounds.overlaps(*f.boundsEpsilon()))
         {
             m_overlaps.push_back(i);
         }
     }
-
-    if (builder.verbose() && m_metadata.subset())
-    {
-        std::cout << "Overlaps: " << m_overlaps.size() << std::endl;
-    }
-
-    m_origin = m_overlaps.empty() ? m_end : m_overlaps.front();
 }
 
 std::unique_ptr<Origin> Sequence::next(std::size_t max)
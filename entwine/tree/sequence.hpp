@@ -32,6 +32,18 @@ public:
     std::unique_ptr<Origin> next(std::size_t max);
     bool done() const { auto l(getLock()); return m_origin < m_end; }
 
+    // Pick up any files appended to the manifest since we last looked,
+    // without restarting the sequence.
+    void extend();
+
+    // True if further files could still be returned by next(max), i.e. we
+    // haven't been stopped or reached our maximum.
+    bool accepting(std::size_t max) const
+    {
+        auto l(getLock());
+        return !m_stopped && (!max || m_added < max);
+    }
+
     // Stop this build as soon as possible.  All partially inserted paths will
     // be completed, and non-inserted paths can be added by continuing this
     // build later.
@@ -39,6 +51,7 @@ public:
     {
         auto l(getLock());
         m_end = std::min(m_end, m_origin + 1);
+        m_stopped = true;
         std::cout << "Stopping - setting end at " << m_end << std::endl;
     }
 
@@ -48,6 +61,9 @@ private:
         return std::unique_lock<std::mutex>(m_mutex);
     }
 
+    // Note the files in [begin, end) which overlap our active bounds.
+    void scan(Origin begin, Origin end);
+
     bool checkInfo(Origin origin);
 
     bool checkBounds(
@@ -62,6 +78,7 @@ private:
     Origin m_origin;
     Origin m_end;
     std::size_t m_added;
+    bool m_stopped = false;
 
     std::vector<Origin> m_overlaps;
 };
@@ -10,15 +10,16 @@
 
 #include <entwine/tree/tiler.hpp>
 
-#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
 
-#include <entwine/tree/chunk.hpp>
+#include <entwine/reader/chunk-reader.hpp>
+#include <entwine/tree/chunk-index.hpp>
 #include <entwine/tree/traverser.hpp>
 #include <entwine/types/binary-point-table.hpp>
 #include <entwine/types/storage.hpp>
 #include <entwine/types/vector-point-table.hpp>
-#include <entwine/util/compression.hpp>
-#include <entwine/util/io.hpp>
 #include <entwine/util/json.hpp>
 
 namespace entwine
@@ -27,218 +28,91 @@ namespace entwine
 namespace
 {
 
-std::set<Id> fetchIds(const arbiter::Endpoint& ep)
+std::set<Id> fetchIds(const arbiter::Endpoint& ep, const Metadata& metadata)
 {
-    std::set<Id> s;
-
-    const Json::Value json(parse(ep.get("entwine-ids")));
-    for (Json::ArrayIndex i(0); i < json.size(); ++i)
-    {
-        s.emplace(json[i].asString());
-    }
-
-    return s;
+    return ChunkIndex::create(metadata.structure(), ep)->ids();
 }
 
-} // unnamed namespace
-
-void Above::populate(std::unique_ptr<std::vector<char>> data)
-{
-    const std::size_t pointSize(m_schema.pointSize());
-    const std::size_t numPoints(data->size() / pointSize);
-
-    VectorPointTable table(m_schema, *data);
-    pdal::PointRef pointRef(table, 0);
-
-    Point p(0, 0, m_bounds.mid().z);
-    Bounds b;
-
-    char* pos(data->data());
-
-    for (std::size_t i(0); i < numPoints; ++i)
-    {
-        pointRef.setPointId(i);
-
-        p.x = pointRef.getFieldAs<double>(pdal::Dimension::Id::X);
-        p.y = pointRef.getFieldAs<double>(pdal::Dimension::Id::Y);
-
-        // It's likely that the points will arrive in an order such that
-        // many points in a row will belong to the same sub-bounds.
-        if (!b.contains(p))
-        {
-            b = m_bounds;
-
-            for (std::size_t d(0); d < m_delta; ++d)
-            {
-                b.go(getDirection(p, b.mid()), true);
-            }
-        }
-
-        auto& segment(m_segments[b]);
-        segment.insert(segment.end(), pos, pos + pointSize);
-    }
-
-    m_here = true;
-}
+const std::size_t maxSplitDepth(32);
 
-void Base::populate(std::unique_ptr<std::vector<char>> data)
+void checkErrors(const Pool& pool)
 {
-    const std::size_t pointSize(m_schema.pointSize());
-    const std::size_t numPoints(data->size() / pointSize);
-
-    VectorPointTable table(m_schema, *data);
-    pdal::PointRef pointRef(table, 0);
-
-    Point p(0, 0, m_bounds.mid().z);
-    Bounds b;
-    ChunkState s(m_metadata);
-
-    char* pos(data->data());
-
-    for (std::size_t i(0); i < numPoints; ++i)
+    if (pool.errors().size())
     {
-        pointRef.setPointId(i);
-
-        p.x = pointRef.getFieldAs<double>(pdal::Dimension::Id::X);
-        p.y = pointRef.getFieldAs<double>(pdal::Dimension::Id::Y);
-
-        // It's likely that the points will arrive in an order such that
-        // many points in a row will belong to the same sub-bounds.
-        if (!b.contains(p))
-        {
-            s.reset();
-            s.climbTo(p, m_delta);  // For the Base, delta = sliceDepth.
-            b = s.chunkBounds();
-        }
-
-        auto& segment(m_segments[b]);
-        segment.insert(segment.end(), pos, pos + pointSize);
+        throw std::runtime_error(
+                "Tile export failed: " + pool.errors().front());
     }
-
-    m_here = true;
 }
 
-Base::Base(const Tiler& tiler)
-    : Above(
-            tiler.metadata().structure().baseIndexBegin(),
-            tiler.metadata().boundsScaledCubic(),
-            tiler.activeSchema(),
-            tiler.sliceDepth())
-    , m_metadata(tiler.metadata())
-    , m_structure(tiler.metadata().structure())
-{
-    const Metadata& metadata(tiler.metadata());
-    // const Schema celledSchema(Schema::makeCelled(metadata.schema()));
-
-    const std::string path(metadata.structure().maybePrefix(m_chunkId));
-    auto data(io::ensureGet(tiler.inEndpoint(), path));
-
-    if (!data)
-    {
-        throw std::runtime_error("Could not acquire base: " + m_chunkId.str());
-    }
-
-    /*
-    std::unique_ptr<Schema> celledWantedSchema;
-
-    if (const Schema* wantedSchema = tiler.wantedSchema())
-    {
-        celledWantedSchema.reset(
-                new Schema(
-                    BaseChunk::makeCelled(*wantedSchema)));
-    }
-    */
-
-    // TODO.
-    /*
-    auto unpacker(tiler.metadata().format().unpack(std::move(data)));
-    data = unpacker.acquireRawBytes();
-    const std::size_t numPoints(unpacker.numPoints());
-
-    std::cout << "Base points: " << numPoints << std::endl;
-    const auto compression(tiler.metadata().format().compression());
-
-    if (compression == ChunkCompression::LasZip)
-    {
-        throw std::runtime_error("No LasZip in Tiler's Base");
-    }
-    else if (compression == ChunkCompression::LazPerf)
-    {
-        data =
-                Compression::decompress(
-                    *data,
-                    celledSchema,
-                    // TODO We're tossing information by not using the celled
-                    // version, so currently this is read-only - no
-                    // transformations.
-                    // celledWantedSchema.get(),
-                    // tiler.wantedSchema(),
-                    &tiler.activeSchema(),
-                    numPoints);
-    }
-
-    populate(std::move(data));
-    */
-}
+} // unnamed namespace
 
 Tiler::Tiler(
         const arbiter::Endpoint& inEndpoint,
         const std::size_t threads,
-        const double tileWidth,
+        const double maxTileWidth,
         const Schema* wantedSchema,
-        const std::size_t maxPointsPerTile)
+        const std::size_t maxPointsPerTile,
+        const std::size_t maxMemory)
     : m_inEndpoint(inEndpoint)
+    , m_arbiter()
+    , m_tmp(m_arbiter.getEndpoint(arbiter::fs::getTempPath()))
     , m_metadata(m_inEndpoint)
-    , m_ids(fetchIds(m_inEndpoint))
-    , m_maxPointsPerTile(maxPointsPerTile)
-    , m_traverser(new Traverser(m_metadata, m_ids))
+    , m_wantedSchema(wantedSchema)
+    , m_maxPointsPerTile(std::max<std::size_t>(maxPointsPerTile, 1))
+    , m_maxMemory(maxMemory)
+    , m_traverser(
+            new Traverser(m_metadata, fetchIds(m_inEndpoint, m_metadata)))
+    , m_pointPool(m_metadata.schema(), m_metadata.delta())
     , m_pool(threads)
-    , m_mutex()
     , m_sliceDepth(0)
-    , m_wantedSchema(wantedSchema)
-    , m_aboves()
-    , m_tiles()
-    , m_current()
-    , m_processing()
+    , m_tilesPerSide(1)
+    , m_dims()
+    , m_above()
+    , m_bytes(0)
+    , m_mutex()
+    , m_cv()
 {
-    init(tileWidth);
+    init(maxTileWidth);
 }
 
 Tiler::~Tiler() { }
 
-void Tiler::init(const double tileWidth)
+void Tiler::init(const double maxTileWidth)
 {
     if (!activeSchema().contains("X") || !activeSchema().contains("Y"))
     {
         throw std::runtime_error("Schema must contain X and Y");
     }
 
-    const double fullWidth(m_metadata.boundsScaledCubic().width());
-    const Structure& structure(m_metadata.structure());
+    if (m_wantedSchema)
+    {
+        const Schema& native(m_metadata.schema());
+        for (const DimInfo& dim : m_wantedSchema->dims())
+        {
+            m_dims.emplace_back(native.find(dim.name()).id(), dim.type());
+        }
+    }
 
-    m_sliceDepth = structure.coldDepthBegin();
-    double div(structure.numChunksAtDepth(m_sliceDepth) / 2.0);
+    // Non-sparse chunks split their parents in X and Y, so tiles at the slice
+    // depth are laid out as a square grid.  Sparse chunks no longer split, so
+    // there's no use in slicing any deeper.
+    const Structure& structure(m_metadata.structure());
+    const double fullWidth(m_metadata.boundsScaledCubic().width());
 
-    std::cout << "Full bounds width: " << fullWidth << std::endl;
-    std::cout << "Max tile width requested:  " << tileWidth  << std::endl;
+    m_sliceDepth = structure.nominalChunkDepth();
+    m_tilesPerSide = 1;
 
     while (
-            fullWidth / div > tileWidth &&
+            fullWidth / m_tilesPerSide > maxTileWidth &&
             m_sliceDepth < structure.sparseDepthBegin())
     {
-        std::cout << fullWidth / div << " : " << tileWidth << std::endl;
-        div = structure.numChunksAtDepth(++m_sliceDepth) / 2.0;
+        ++m_sliceDepth;
+        m_tilesPerSide *= 2;
     }
 
-    std::cout << "Slice depth: " << m_sliceDepth << std::endl;
-    std::cout << "Nominal number of tiles: " << (div * 2) << std::endl;
-    std::cout << "Actual tile width to use: " <<
-        fullWidth / static_cast<double>(div) << std::endl;
-
-    if (structure.hasBase())
-    {
-        m_aboves[m_metadata.boundsScaledCubic()].reset(new Base(*this));
-    }
+    std::cout << "Slice depth: " << m_sliceDepth << "\n" <<
+        "Tiles: " << m_tilesPerSide << " x " << m_tilesPerSide << "\n" <<
+        "Tile width: " << fullWidth / m_tilesPerSide << std::endl;
 }
 
 const Schema& Tiler::activeSchema() const
@@ -246,300 +120,220 @@ const Schema& Tiler::activeSchema() const
     return m_wantedSchema ? *m_wantedSchema : m_metadata.schema();
 }
 
-void Tiler::go(const TileFunction& f, const arbiter::Endpoint* ep)
+void Tiler::go(const TileFunction& f)
 {
-    std::size_t i(0);
+    loadAbove();
 
-    m_traverser->go([this, &f, &i](const ChunkState& chunkState, bool exists)
+    // Chunks at or below the slice depth belong to exactly one tile, and since
+    // the traversal is depth-first, all of the chunks of a tile are visited
+    // consecutively.
+    bool active(false);
+    std::size_t current(0);
+    std::vector<Id> ids;
+
+    m_traverser->go([&](const ChunkState& chunkState, bool exists)
     {
-        const Id& chunkId(chunkState.chunkId());
-        const std::size_t depth(chunkState.depth());
-        const Bounds& bounds(chunkState.chunkBounds());
+        if (!exists) return false;
+        if (chunkState.depth() < m_sliceDepth) return true;
 
-        if (depth < m_sliceDepth)
-        {
-            if (exists) insertAbove(f, chunkId, depth, bounds);
-            return true;    // We always need to get to at least m_sliceDepth.
-        }
-        else if (depth == m_sliceDepth)
-        {
-            spawnTile(f, chunkId, bounds, exists);
-            return exists;
-        }
-        else
+        const std::size_t index(tileIndex(chunkState.chunkBounds().mid()));
+
+        if (active && index != current)
         {
-            if (exists) buildTile(f, chunkId, depth, bounds);
-            return exists;
+            spawn(f, current, std::move(ids));
+            ids.clear();
         }
-    });
-
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_current.reset();
-    }
-
-    m_pool.join();
-    m_pool.go();
 
-    if (!ep) return;
+        active = true;
+        current = index;
+        ids.push_back(chunkState.chunkId());
+        return true;
+    });
 
-    // TODO
-    /*
-    const auto props(m_builder.propsToSave());
-    for (const auto& p : props)
-    {
-        ep->putSubpath(p.first, p.second);
-    }
+    if (active) spawn(f, current, std::move(ids));
 
-    const std::string inHierPath(
-            m_builder.outEndpoint().getSubEndpoint("h").type() + "://" +
-            m_builder.outEndpoint().getSubEndpoint("h").root() + "*");
+    m_pool.cycle();
+    checkErrors(m_pool);
 
-    if (!ep->isRemote())
+    // Whatever remains lies within tiles that have no chunks of their own.
+    std::vector<std::size_t> remaining;
+    for (const auto& p : m_above) remaining.push_back(p.first);
+    for (const std::size_t index : remaining)
     {
-        arbiter::fs::mkdirp(ep->root() + "h");
+        spawn(f, index, std::vector<Id>());
     }
 
-    const std::string outHierPath(ep->getSubEndpoint("h").root());
-
-    m_builder.arbiter().copy(inHierPath, outHierPath);
-    */
+    m_pool.cycle();
+    checkErrors(m_pool);
 }
 
-void Tiler::insertAbove(
-        const TileFunction& f,
-        const Id& chunkId,
-        const std::size_t depth,
-        const Bounds& bounds)
+void Tiler::loadAbove()
 {
-    Above& above(([this, &chunkId, depth, &bounds]()->Above&
+    if (m_metadata.structure().hasBase())
     {
-        std::size_t delta(m_sliceDepth - depth);
-        const Schema& s(activeSchema());
+        const ChunkReader base(m_metadata, m_inEndpoint, m_tmp, m_pointPool);
+        route(base.cells());
+    }
 
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto result(
-                m_aboves.emplace(
-                    std::piecewise_construct,
-                    std::forward_as_tuple(bounds),
-                    std::forward_as_tuple(
-                        new Above(chunkId, bounds, s, delta))));
-        return *result.first->second;
-    })());
-
-    m_pool.add([this, &f, chunkId, &above]()
+    m_traverser->go([this](const ChunkState& chunkState, bool exists)
     {
-        auto data(acquire(chunkId));
+        if (!exists || chunkState.depth() >= m_sliceDepth) return false;
 
+        const Id id(chunkState.chunkId());
+
+        m_pool.add([this, id]()
         {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            above.populate(std::move(data));
-        }
+            Cell::PooledStack cells(
+                    m_metadata.storage().deserialize(
+                        m_inEndpoint,
+                        m_tmp,
+                        m_pointPool,
+                        id));
+
+            route(cells);
+            m_pointPool.release(std::move(cells));
+        });
 
-        maybeProcess(f);
+        return chunkState.depth() + 1 < m_sliceDepth;
     });
-}
 
-void Tiler::spawnTile(
-        const TileFunction& f,
-        const Id& chunkId,
-        const Bounds& bounds,
-        const bool exists)
-{
-    Tile& tile(([this, &chunkId, &bounds]()->Tile&
-    {
-        const Schema& s(activeSchema());
+    m_pool.cycle();
+    checkErrors(m_pool);
 
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_current.reset(new Bounds(bounds));
-
-        auto result(
-                m_tiles.emplace(
-                    std::piecewise_construct,
-                    std::forward_as_tuple(bounds),
-                    std::forward_as_tuple(
-                        new Tile(bounds, s, m_aboves, m_maxPointsPerTile))));
-        return *result.first->second;
-    })());
-
-    if (exists) awaitAndAcquire(f, chunkId, tile);
+    std::size_t bytes(0);
+    for (const auto& p : m_above) bytes += p.second.size();
+
+    std::cout << "Shallow points: " <<
+        commify(bytes / activeSchema().pointSize()) << " in " <<
+        commify(m_above.size()) << " tiles" << std::endl;
 }
 
-void Tiler::buildTile(
-        const TileFunction& f,
-        const Id& chunkId,
-        const std::size_t depth,
-        const Bounds& bounds)
+void Tiler::route(const Cell::PooledStack& cells)
 {
-    Tile& tile(([this, &bounds]()->Tile&
+    // Points within a chunk tend to be spatially clustered, so gather them
+    // locally before touching the shared segments.
+    Segments segments;
+    std::size_t index(0);
+    std::vector<char>* segment(nullptr);
+
+    BinaryPointTable table(m_metadata.schema());
+
+    for (const Cell& cell : cells)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        const std::size_t next(tileIndex(cell.point()));
 
-        // TODO Use asserts.
-        if (!m_current) throw std::runtime_error("No current");
-        if (!m_current->contains(bounds))
+        if (!segment || next != index)
         {
-            throw std::runtime_error("No encapsulating base");
+            index = next;
+            segment = &segments[index];
         }
 
-        return *m_tiles.at(*m_current);
-    })());
+        append(cell, *segment, table);
+    }
 
-    awaitAndAcquire(f, chunkId, tile);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& p : segments)
+    {
+        std::vector<char>& dst(m_above[p.first]);
+        if (dst.empty()) dst.swap(p.second);
+        else dst.insert(dst.end(), p.second.begin(), p.second.end());
+    }
 }
 
-void Tiler::awaitAndAcquire(
+void Tiler::spawn(
         const TileFunction& f,
-        const Id& chunkId,
-        Tile& tile)
+        const std::size_t index,
+        std::vector<Id> ids)
 {
-    tile.await(chunkId);
-
-    m_pool.add([this, &f, chunkId, &tile]()
     {
-        auto data(acquire(chunkId));
-
-        {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            tile.insert(chunkId, std::move(data));
-        }
-
-        maybeProcess(f);
-    });
-}
-
-void Tiler::maybeProcess(const TileFunction& f)
-{
-    using QueueMap = std::map<Bounds, TileMap::iterator>;
-    QueueMap queue;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this]() { return m_bytes < m_maxMemory; });
+    }
 
+    m_pool.add([this, &f, index, ids]()
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<char> data;
 
-        auto it(m_tiles.begin());
-        while (it != m_tiles.end())
         {
-            const Bounds& tileBounds(it->first);
-            std::unique_ptr<Tile>& tile(it->second);
-
-            if ((!m_current || *m_current != tileBounds) && tile->acquire())
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it(m_above.find(index));
+            if (it != m_above.end())
             {
-                queue[tileBounds] = it;
+                data.swap(it->second);
+                m_above.erase(it);
             }
-
-            ++it;
         }
-    }
 
-    for (auto& v : queue)
-    {
-        TileMap::iterator& it(v.second);
-        Tile& tile(*it->second);
-        tile.process(f);
-    }
+        std::size_t held(data.size());
+        hold(held);
 
-    {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        for (auto& v : queue) m_tiles.erase(v.second);
-
-        auto it(m_aboves.begin());
-
-        // Predicate to ensure that no outstanding tiles overlap this Above.
-        auto references([&it](const TileMap::value_type& v)
-        {
-            return v.second->references(*it->second);
-        });
-
-        // Predicate to ensure that we only remove Aboves that have had a child
-        // Tile erased this iteration.
-        auto isContainedBy([&it](const QueueMap::value_type& v)
+        for (const Id& id : ids)
         {
-            return it->first.contains(v.first);
-        });
-
-        while (it != m_aboves.end())
-        {
-            if (
-                    std::none_of(m_tiles.begin(), m_tiles.end(), references) &&
-                    std::any_of(queue.begin(), queue.end(), isContainedBy))
-            {
-                it = m_aboves.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
+            Cell::PooledStack cells(
+                    m_metadata.storage().deserialize(
+                        m_inEndpoint,
+                        m_tmp,
+                        m_pointPool,
+                        id));
+
+            BinaryPointTable table(m_metadata.schema());
+            for (const Cell& cell : cells) append(cell, data, table);
+            m_pointPool.release(std::move(cells));
+
+            hold(data.size() - held);
+            held = data.size();
         }
-    }
-}
-
-std::unique_ptr<std::vector<char>> Tiler::acquire(const Id& chunkId)
-{
-    const std::string path(m_metadata.structure().maybePrefix(chunkId));
-    auto compressed(io::ensureGet(m_inEndpoint, path));
 
-    if (!compressed)
-    {
-        throw std::runtime_error("Could not acquire " + chunkId.str());
-    }
+        if (data.size()) emit(f, data, tileBounds(index));
 
-    /*
-    const std::size_t numPoints(Chunk::popTail(*compressed).numPoints);
-    auto data(
-            Compression::decompress(
-                *compressed,
-                m_metadata.schema(),
-                m_wantedSchema,
-                numPoints));
-
-    return data;
-    */
-    return std::unique_ptr<std::vector<char>>();
+        std::vector<char>().swap(data);
+        release(held);
+    });
 }
 
-Above::Set Tile::getContainingFrom(
-        const Bounds& bounds,
-        Above::Map& aboves) const
+void Tiler::append(
+        const Cell& cell,
+        std::vector<char>& data,
+        BinaryPointTable& table) const
 {
-    return std::accumulate(
-            aboves.begin(),
-            aboves.end(),
-            Above::Set(),
-            [&bounds](const Above::Set& in, Above::MapVal& a)
-            {
-                if (a.first.contains(bounds))
-                {
-                    auto out(in);
-                    out.insert(a.second.get());
-                    return out;
-                }
-                else return in;
-            });
-}
+    const std::size_t pointSize(activeSchema().pointSize());
+    pdal::PointRef pointRef(table, 0);
 
-void Tile::process(const TileFunction& f)
-{
-    for (const Above* a : m_aboves)
+    for (const char* src : cell)
     {
-        if (const std::vector<char>* segment = a->data(m_bounds))
+        if (m_dims.empty())
         {
-            m_data.insert(m_data.end(), segment->begin(), segment->end());
+            data.insert(data.end(), src, src + pointSize);
         }
-    }
+        else
+        {
+            data.resize(data.size() + pointSize);
+            char* pos(data.data() + data.size() - pointSize);
 
-    if (m_data.size()) splitAndCall(f, m_data, m_bounds);
+            table.setPoint(src);
+            for (const auto& dim : m_dims)
+            {
+                pointRef.getField(pos, dim.first, dim.second);
+                pos += pdal::Dimension::size(dim.second);
+            }
+        }
+    }
 }
 
-void Tile::splitAndCall(
+void Tiler::emit(
         const TileFunction& f,
         const std::vector<char>& data,
-        const Bounds& bounds) const
+        const Bounds& bounds,
+        const std::size_t depth) const
 {
-    const std::size_t numPoints(data.size() / m_schema.pointSize());
+    const Schema& schema(activeSchema());
+    const std::size_t pointSize(schema.pointSize());
+    const std::size_t numPoints(data.size() / pointSize);
 
-    if (numPoints <= m_maxPointsPerTile)
+    // Coincident points can't be split, so give up after a while.
+    if (numPoints <= m_maxPointsPerTile || depth >= maxSplitDepth)
     {
-        VectorPointTable table(m_schema, data);
+        VectorPointTable table(schema, data);
         SizedPointView view(table);
         f(view, bounds);
     }
@@ -547,33 +341,88 @@ void Tile::splitAndCall(
     {
         std::vector<std::vector<char>> split(dirHalfEnd());
 
-        BinaryPointTable table(m_schema);
+        BinaryPointTable table(schema);
         pdal::PointRef pointRef(table, 0);
 
         const char* pos(data.data());
         Point p;
-        Dir dir;
 
         for (std::size_t i(0); i < numPoints; ++i)
         {
             table.setPoint(pos);
             p.x = pointRef.getFieldAs<double>(pdal::Dimension::Id::X);
             p.y = pointRef.getFieldAs<double>(pdal::Dimension::Id::Y);
-            p.z = pointRef.getFieldAs<double>(pdal::Dimension::Id::Z);
-            dir = getDirection(bounds.mid(), p);
 
+            const Dir dir(getDirection(bounds.mid(), p, true));
             std::vector<char>& active(split[toIntegral(dir, true)]);
-            active.insert(active.end(), pos, pos + m_schema.pointSize());
+            active.insert(active.end(), pos, pos + pointSize);
 
-            pos += m_schema.pointSize();
+            pos += pointSize;
         }
 
         for (std::size_t i(0); i < split.size(); ++i)
         {
-            splitAndCall(f, split[i], bounds.get(toDir(i), true));
+            if (split[i].size())
+            {
+                emit(f, split[i], bounds.get(toDir(i), true), depth + 1);
+            }
         }
     }
 }
 
+std::size_t Tiler::tileIndex(const Point& p) const
+{
+    const Bounds& cube(m_metadata.boundsScaledCubic());
+    const double width(cube.width() / m_tilesPerSide);
+    const double depth(cube.depth() / m_tilesPerSide);
+
+    auto clamp([this](double v)
+    {
+        return static_cast<std::size_t>(
+                std::max<double>(
+                    0,
+                    std::min<double>(std::floor(v), m_tilesPerSide - 1)));
+    });
+
+    const std::size_t x(clamp((p.x - cube.min().x) / width));
+    const std::size_t y(clamp((p.y - cube.min().y) / depth));
+
+    return y * m_tilesPerSide + x;
+}
+
+Bounds Tiler::tileBounds(const std::size_t index) const
+{
+    const Bounds& cube(m_metadata.boundsScaledCubic());
+    const double width(cube.width() / m_tilesPerSide);
+    const double depth(cube.depth() / m_tilesPerSide);
+
+    const std::size_t x(index % m_tilesPerSide);
+    const std::size_t y(index / m_tilesPerSide);
+
+    return Bounds(
+            cube.min().x + x * width,
+            cube.min().y + y * depth,
+            cube.min().z,
+            cube.min().x + (x + 1) * width,
+            cube.min().y + (y + 1) * depth,
+            cube.max().z);
+}
+
+void Tiler::hold(const std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bytes += bytes;
+}
+
+void Tiler::release(const std::size_t bytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bytes -= bytes;
+    }
+
+    m_cv.notify_all();
+}
+
 } // namespace entwine
 
@@ -10,204 +10,43 @@
 
 #pragma once
 
+#include <condition_variable>
 #include <cstddef>
 #include <limits>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 #include <pdal/PointView.hpp>
 
 #include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/tree/heuristics.hpp>
 #include <entwine/types/bounds.hpp>
-#include <entwine/types/dir.hpp>
 #include <entwine/types/defs.hpp>
 #include <entwine/types/metadata.hpp>
+#include <entwine/types/point-pool.hpp>
 #include <entwine/util/pool.hpp>
 
-namespace arbiter
-{
-    class Endpoint;
-}
-
 namespace entwine
 {
 
+class BinaryPointTable;
 class Traverser;
-class Tile;
-class Tiler;
-
-class Above
-{
-public:
-    Above(
-            const Id& chunkId,
-            const Bounds& bounds,
-            const Schema& schema,
-            std::size_t delta)
-        : m_chunkId(chunkId)
-        , m_bounds(bounds)
-        , m_schema(schema)
-        , m_delta(delta)
-        , m_segments()
-        , m_here(false)
-    { }
-
-    virtual ~Above()
-    {
-        // TODO If this is a transformation, smash the segments together and
-        // then write out this chunk.
-    }
-
-    using Map = std::map<Bounds, std::unique_ptr<Above>>;
-    using MapVal = Map::value_type;
-    using Set = std::set<Above*>;
-
-    const Id& chunkId() const { return m_chunkId; }
-    bool here() const { return m_here; }
-
-    virtual void populate(std::unique_ptr<std::vector<char>> data);
-
-    const std::vector<char>* data(const Bounds& bounds) const
-    {
-        if (m_segments.count(bounds)) return &m_segments.at(bounds);
-        else return nullptr;
-    }
-
-protected:
-    const Id m_chunkId;
-    const Bounds m_bounds;
-    const Schema& m_schema;
-    const std::size_t m_delta;
-    std::map<Bounds, std::vector<char>> m_segments;
-    bool m_here;
-};
-
-class Base : public Above
-{
-public:
-    Base(const Tiler& tiler);
-
-    virtual ~Base() override
-    {
-        // TODO Reserialize base, if this is a transformation.  Something like:
-        /*
-        const Schema celledSchema(BaseChunk::makeCelled(m_metadata.schema()));
-        auto toWrite(Compression::compress(*m_baseChunk, celledSchema));
-
-        Chunk::pushTail(
-                *toWrite,
-                Chunk::Tail(
-                    m_baseChunk->size() / celledSchema.pointSize(),
-                    Chunk::Contiguous));
-
-        m_outEndpoint->putSubpath(
-                m_metadata.structure().baseIndexBegin().str(),
-                *toWrite);
-        */
-    }
-
-private:
-    virtual void populate(std::unique_ptr<std::vector<char>> data) override;
-
-    const Metadata& m_metadata;
-    const Structure& m_structure;
-};
-
-class Tile
-{
-    using Belows = std::map<Id, std::unique_ptr<std::size_t>>;
-    using Below = Belows::value_type;
-    using Aboves = std::map<Above*, std::unique_ptr<std::size_t>>;
-
-public:
-    Tile(
-            const Bounds& bounds,
-            const Schema& schema,
-            Above::Map& aboves,
-            std::size_t maxPointsPerTile)
-        : m_bounds(bounds)
-        , m_schema(schema)
-        , m_maxPointsPerTile(maxPointsPerTile)
-        , m_aboves(getContainingFrom(m_bounds, aboves))
-        , m_belows()
-        , m_data()
-        , m_owned(false)
-    { }
-
-    ~Tile()
-    {
-        // TODO If this is a transformation, write out each of the Belows.
-        // Something like:
-        /*
-        if (m_outEndpoint)
-        {
-            auto toWrite(Compression::compress(data, schema));
-
-            Chunk::pushTail(
-                    *toWrite,
-                    Chunk::Tail(
-                        data.size() / schema.pointSize(),
-                        Chunk::Contiguous)); // TODO Get from Structure.
-
-            m_outEndpoint->putSubpath(id.str(), *toWrite);
-        }
-        */
-    }
-
-    void await(const Id& id) { m_belows[id] = nullptr; }
-    void insert(const Id& id, std::unique_ptr<std::vector<char>> data)
-    {
-        m_belows.at(id).reset(new std::size_t(m_data.size()));
-        m_data.insert(m_data.begin(), data->begin(), data->end());
-    }
-
-    // Returns true if the caller is cleared for processing this Tile.  If
-    // the result is false, the caller should not process this Tile.
-    bool acquire()
-    {
-        if (!m_owned && allHere())
-        {
-            m_owned = true;
-            return true;
-        }
-        else
-        {
-            return false;
-        }
-    }
-
-    bool allHere() const
-    {
-        auto aboveHere([](const Above* a) { return a->here(); });
-        auto belowHere([](const Below& b) { return b.second.get(); });
-        return
-            std::all_of(m_aboves.begin(), m_aboves.end(), aboveHere) &&
-            std::all_of(m_belows.begin(), m_belows.end(), belowHere);
-    }
-
-    void process(const TileFunction& f);
-
-    bool references(Above& above) const { return m_aboves.count(&above); }
-
-private:
-    Above::Set getContainingFrom(const Bounds& bounds, Above::Map& aboves) const;
-
-    void splitAndCall(
-            const TileFunction& f,
-            const std::vector<char>& data,
-            const Bounds& bounds) const;
-
-    const Bounds m_bounds;
-    const Schema& m_schema;
-    const std::size_t m_maxPointsPerTile;
-
-    Above::Set m_aboves;
-    Belows m_belows;
-
-    std::vector<char> m_data;
-    bool m_owned;
-};
 
+// Exports an existing index as a grid of fixed-size XY tiles.  Tiles are the
+// chunk bounds at the slice depth, which is the shallowest depth whose chunks
+// are no wider than the requested tile width.
+//
+// Points from the base and from any cold chunks shallower than the slice depth
+// are decoded up front and routed to their tiles.  Everything else is
+// streamed: chunks are visited in spatial order by the Traverser, and as soon
+// as the traversal leaves the subtree of a tile, that tile's chunks are decoded
+// on the thread pool, combined with its share of the shallower points, and
+// passed to the TileFunction.  Each chunk is decoded exactly once.  The
+// traversal pauses while the data held by outstanding tiles exceeds the memory
+// limit.
 class Tiler
 {
 public:
@@ -217,78 +56,80 @@ public:
             double maxTileWidth,
             const Schema* wantedSchema = nullptr,
             std::size_t maxPointsPerTile =
-                std::numeric_limits<std::size_t>::max());
-
-    /*
-    Tiler(
-            const Metadata& metadata,
-            const arbiter::Endpoint& output,
-            std::size_t threads,
-            double maxTileWidth);
-    */
+                std::numeric_limits<std::size_t>::max(),
+            std::size_t maxMemory = heuristics::tilerMemory);
 
     ~Tiler();
 
-    void go(const TileFunction& f, const arbiter::Endpoint* ep = nullptr);
+    // The function may be called concurrently from multiple threads.  Tiles
+    // with more than maxPointsPerTile points are split into quadrants, so the
+    // bounds passed to the function may be smaller than a full tile.  Point
+    // positions and bounds are in the scaled space of the index.
+    void go(const TileFunction& f);
 
     const Metadata& metadata() const { return m_metadata; }
     const Schema* wantedSchema() const { return m_wantedSchema; }
     std::size_t sliceDepth() const { return m_sliceDepth; }
+    std::size_t tilesPerSide() const { return m_tilesPerSide; }
 
     const Schema& activeSchema() const;
 
     const arbiter::Endpoint& inEndpoint() const { return m_inEndpoint; }
 
 private:
+    // Point data in the active schema, keyed by tile index.
+    using Segments = std::map<std::size_t, std::vector<char>>;
+
     void init(double maxTileWidth);
 
-    void insertAbove(
-            const TileFunction& f,
-            const Id& chunkId,
-            std::size_t depth,
-            const Bounds& bounds);
+    // Decode the base and the cold chunks above the slice depth, and route
+    // their points to the tiles.
+    void loadAbove();
+    void route(const Cell::PooledStack& cells);
 
-    void spawnTile(
-            const TileFunction& f,
-            const Id& chunkId,
-            const Bounds& bounds,
-            bool exists);
+    void spawn(const TileFunction& f, std::size_t index, std::vector<Id> ids);
 
-    void buildTile(
-            const TileFunction& f,
-            const Id& chunkId,
-            std::size_t depth,
-            const Bounds& bounds);
+    // Append the data of this cell, in the active schema.
+    void append(
+            const Cell& cell,
+            std::vector<char>& data,
+            BinaryPointTable& table) const;
 
-    void awaitAndAcquire(
+    void emit(
             const TileFunction& f,
-            const Id& chunkId,
-            Tile& tile);
+            const std::vector<char>& data,
+            const Bounds& bounds,
+            std::size_t depth = 0) const;
 
-    void maybeProcess(const TileFunction& f);
-    std::unique_ptr<std::vector<char>> acquire(const Id& chunkId);
-    using TileMap = std::map<Bounds, std::unique_ptr<Tile>>;
+    std::size_t tileIndex(const Point& p) const;
+    Bounds tileBounds(std::size_t index) const;
+
+    void hold(std::size_t bytes);
+    void release(std::size_t bytes);
 
     const arbiter::Endpoint m_inEndpoint;
+    arbiter::Arbiter m_arbiter;
+    const arbiter::Endpoint m_tmp;
 
     const Metadata m_metadata;
-    const std::set<Id> m_ids;
+    const Schema* const m_wantedSchema;
     const std::size_t m_maxPointsPerTile;
+    const std::size_t m_maxMemory;
 
     std::unique_ptr<Traverser> m_traverser;
-    mutable Pool m_pool;
-    mutable std::mutex m_mutex;
+    PointPool m_pointPool;
+    Pool m_pool;
 
-    std::unique_ptr<Base> m_baseChunk;
     std::size_t m_sliceDepth;
+    std::size_t m_tilesPerSide;
 
-    const Schema* const m_wantedSchema;
-
-    std::map<Bounds, std::unique_ptr<Above>> m_aboves;
-    TileMap m_tiles;
+    // For conversion from the native schema to the wanted schema, if any.
+    std::vector<std::pair<pdal::Dimension::Id, pdal::Dimension::Type>> m_dims;
 
-    std::unique_ptr<Bounds> m_current;
-    std::set<Bounds> m_processing;
+    Segments m_above;
+    std::size_t m_bytes;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
 };
 
 class SizedPointView : public pdal::PointView
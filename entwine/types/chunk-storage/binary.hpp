@@ -104,6 +104,28 @@ public:
     }
 
 protected:
+    // Newer storage types always record their tail, so for them a missing
+    // tail means that only options were given for a new build.
+    void defaultTail(const Json::Value& json, const TailFieldList& fields)
+    {
+        if (!json.isMember("tail")) m_tailFields = fields;
+    }
+
+    // The data of every point of these cells, in order.
+    static std::vector<const char*> gatherPoints(
+            const Cell::PooledStack& cellStack)
+    {
+        std::vector<const char*> points;
+        points.reserve(cellStack.size());
+
+        for (const Cell& cell : cellStack)
+        {
+            for (const char* data : cell) points.push_back(data);
+        }
+
+        return points;
+    }
+
     std::vector<char> buildData(Chunk& chunk) const
     {
         Cell::PooledStack cellStack(chunk.acquire());
@@ -115,8 +137,7 @@ protected:
 
         std::vector<char> data;
         data.reserve(
-                dataStack.size() * pointSize +
-                buildTail(chunk, dataStack.size()).size());
+                dataStack.size() * pointSize + tailSize());
 
         for (const char* d : dataStack)
         {
@@ -126,31 +147,41 @@ protected:
         return data;
     }
 
-    std::vector<char> buildTail(
-            const Chunk& chunk,
-            const std::size_t numPoints,
-            std::size_t numBytes = 0) const
+    // The size of the tail built by buildTail, which depends only on the
+    // tail fields and the number of segments.
+    std::size_t tailSize(const std::size_t numSegments = 0) const
     {
-        using Data = std::vector<char>;
-        Data tail;
-
-        std::size_t tailSize(0);
+        std::size_t size(0);
         for (TailField field : m_tailFields)
         {
             switch (field)
             {
                 case TailField::ChunkType:
-                    ++tailSize;
+                    ++size;
                     break;
                 case TailField::NumPoints:
                 case TailField::NumBytes:
-                    tailSize += 8;
+                    size += 8;
+                    break;
+                case TailField::Segments:
+                    size += 8 + numSegments * 16;
                     break;
             }
         }
+        return size;
+    }
+
+    std::vector<char> buildTail(
+            const Chunk& chunk,
+            const std::size_t numPoints,
+            std::size_t numBytes = 0,
+            const TailSegments& segments = TailSegments()) const
+    {
+        using Data = std::vector<char>;
+        Data tail;
 
         if (!numBytes) numBytes = numPoints * chunk.schema().pointSize();
-        numBytes += tailSize;
+        numBytes += tailSize(segments.size());
 
         for (TailField field : m_tailFields)
         {
@@ -165,6 +196,14 @@ protected:
                 case TailField::NumBytes:
                     append(tail, numBytes);
                     break;
+                case TailField::Segments:
+                    for (const TailSegment& segment : segments)
+                    {
+                        append(tail, segment.numPoints);
+                        append(tail, segment.numBytes);
+                    }
+                    append(tail, segments.size());
+                    break;
             }
         }
 
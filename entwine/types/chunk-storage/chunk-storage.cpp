@@ -12,7 +12,9 @@
 
 #include <entwine/types/chunk-storage/binary.hpp>
 #include <entwine/types/chunk-storage/lazperf.hpp>
+#include <entwine/types/chunk-storage/lazperf-segmented.hpp>
 #include <entwine/types/chunk-storage/laszip.hpp>
+#include <entwine/types/chunk-storage/zstd.hpp>
 #include <entwine/util/unique.hpp>
 
 namespace entwine
@@ -28,6 +30,9 @@ std::unique_ptr<ChunkStorage> ChunkStorage::create(
         case ChunkStorageType::LazPerf: return makeUnique<LazPerfStorage>(m, j);
         case ChunkStorageType::LasZip: return makeUnique<LasZipStorage>(m, j);
         case ChunkStorageType::Binary: return makeUnique<BinaryStorage>(m, j);
+        case ChunkStorageType::LazPerfSegmented:
+            return makeUnique<LazPerfSegmentedStorage>(m, j);
+        case ChunkStorageType::Zstandard: return makeUnique<ZstdStorage>(m, j);
         default: throw std::runtime_error("Invalid chunk compression type");
     }
 }
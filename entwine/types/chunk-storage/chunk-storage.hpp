@@ -10,11 +10,15 @@
 
 #pragma once
 
+#include <cstdint>
+#include <mutex>
+
 #include <json/json.h>
 
 #include <entwine/tree/builder.hpp>
 #include <entwine/tree/chunk.hpp>
 #include <entwine/types/point-pool.hpp>
+#include <entwine/types/storage.hpp>
 #include <entwine/types/storage-types.hpp>
 #include <entwine/util/io.hpp>
 
@@ -40,6 +44,12 @@ public:
             const Id& id) const = 0;
 
     virtual Json::Value toJson() const { return Json::nullValue; }
+
+    StorageStats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        return m_stats;
+    }
     virtual std::string filename(const Id& id) const
     {
         return m_metadata.basename(id);
@@ -51,7 +61,32 @@ protected:
             const std::string& path,
             const std::vector<char>& data) const
     {
+        const uint64_t replaced(replacedBytes(chunk, path));
         io::ensurePut(chunk.builder().outEndpoint(), path, data);
+        record(data.size(), replaced);
+    }
+
+    // Size of the existing data at this path which will be overwritten by
+    // this chunk, which must be checked before writing.
+    uint64_t replacedBytes(const Chunk& chunk, const std::string& path) const
+    {
+        if (!chunk.exists()) return 0;
+
+        const auto size(chunk.builder().outEndpoint().tryGetSize(path));
+        return size ? *size : 0;
+    }
+
+    void record(uint64_t bytes, uint64_t replaced) const
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        ++m_stats.chunks;
+        m_stats.bytes += bytes;
+
+        if (replaced)
+        {
+            ++m_stats.rewrites;
+            m_stats.replacedBytes += replaced;
+        }
     }
 
     std::unique_ptr<std::vector<char>> ensureGet(
@@ -62,6 +97,10 @@ protected:
     }
 
     const Metadata& m_metadata;
+
+private:
+    mutable StorageStats m_stats;
+    mutable std::mutex m_statsMutex;
 };
 
 } // namespace entwine
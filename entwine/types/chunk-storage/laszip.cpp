@@ -10,6 +10,8 @@
 
 #include <entwine/types/chunk-storage/laszip.hpp>
 
+#include <sstream>
+
 #include <pdal/io/LasWriter.hpp>
 
 #include <entwine/types/pooled-point-table.hpp>
@@ -19,6 +21,61 @@
 namespace entwine
 {
 
+namespace
+{
+    // Encodes into memory rather than to a file.  The LasWriter rewrites its
+    // header once all points are written, so this must be a seekable stream.
+    class MemoryLasWriter : public pdal::LasWriter
+    {
+    public:
+        // Moves the encoded data out in a single copy.
+        std::vector<char> data()
+        {
+            m_stream.seekg(0, std::ios::end);
+            std::vector<char> result(m_stream.tellg());
+            m_stream.seekg(0);
+            m_stream.read(result.data(), result.size());
+            m_stream.str(std::string());
+            return result;
+        }
+
+    private:
+        virtual void readyFile(
+                const std::string& filename,
+                const pdal::SpatialReference& srs) override
+        {
+            // The header and its GeoTIFF and WKT VLRs are created from the
+            // SRS here, which goes through GDAL, so it must hold the executor
+            // lock.  Only the point encoding that follows runs unlocked.
+            auto lock(Executor::getLock());
+            prepOutput(&m_stream, srs);
+        }
+
+        virtual void doneFile() override
+        {
+            finishOutput();
+        }
+
+        std::stringstream m_stream;
+    };
+}
+
+const pdal::SpatialReference& LasZipStorage::srs() const
+{
+    // Parsing a spatial reference is not thread-safe, so do it once here
+    // rather than passing a string to each writer.
+    std::call_once(m_srsFlag, [this]()
+    {
+        std::string s(m_metadata.srs());
+        if (auto r = m_metadata.reprojection()) s = r->out();
+
+        auto lock(Executor::getLock());
+        if (s.size()) m_srs = pdal::SpatialReference(s);
+    });
+
+    return m_srs;
+}
+
 void LasZipStorage::write(Chunk& chunk) const
 {
     Cell::PooledStack cellStack(chunk.acquire());
@@ -38,12 +95,6 @@ void LasZipStorage::write(Chunk& chunk) const
 
     StreamReader reader(cellTable);
 
-    const auto& outEndpoint(chunk.builder().outEndpoint());
-    const auto& tmpEndpoint(chunk.builder().tmpEndpoint());
-
-    const std::string localDir = outEndpoint.isLocal() ?
-        outEndpoint.prefixedRoot() : tmpEndpoint.prefixedRoot();
-
     const std::string filename(m_metadata.basename(chunk.id()) + ".laz");
 
     const auto offset = Point::unscale(
@@ -57,7 +108,7 @@ void LasZipStorage::write(Chunk& chunk) const
     uint64_t colorMask(schema.hasColor() ? 2 : 0);
 
     pdal::Options options;
-    options.add("filename", localDir + filename);
+    options.add("filename", filename);
     options.add("minor_version", 4);
     options.add("extra_dims", "all");
     options.add("software_id", "Entwine " + currentVersion().toString());
@@ -72,26 +123,17 @@ void LasZipStorage::write(Chunk& chunk) const
     options.add("offset_y", offset.y);
     options.add("offset_z", offset.z);
 
-    if (auto r = m_metadata.reprojection()) options.add("a_srs", r->out());
-    else if (m_metadata.srs().size()) options.add("a_srs", m_metadata.srs());
-
-    auto lock(Executor::getLock());
-
-    pdal::LasWriter writer;
+    // Like every other stage, this writer is prepared under the executor
+    // lock, as is the creation of its header from the SRS.  Encoding the
+    // points, which is the bulk of the work, runs without it.
+    MemoryLasWriter writer;
     writer.setOptions(options);
+    writer.setSpatialReference(srs());
     writer.setInput(reader);
-    writer.prepare(cellTable);
-
-    lock.unlock();
-
+    { auto lock(Executor::getLock()); writer.prepare(cellTable); }
     writer.execute(cellTable);
 
-    if (!outEndpoint.isLocal())
-    {
-        io::ensurePut(outEndpoint, filename, tmpEndpoint.getBinary(filename));
-
-        arbiter::fs::remove(tmpEndpoint.prefixedRoot() + filename);
-    }
+    ensurePut(chunk, filename, writer.data());
 }
 
 Cell::PooledStack LasZipStorage::read(
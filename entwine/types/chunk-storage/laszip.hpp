@@ -10,6 +10,10 @@
 
 #pragma once
 
+#include <mutex>
+
+#include <pdal/SpatialReference.hpp>
+
 #include <entwine/types/chunk-storage/chunk-storage.hpp>
 
 namespace entwine
@@ -34,6 +38,12 @@ public:
     {
         return m_metadata.basename(id) + ".laz";
     }
+
+private:
+    const pdal::SpatialReference& srs() const;
+
+    mutable std::once_flag m_srsFlag;
+    mutable pdal::SpatialReference m_srs;
 };
 
 } // namespace entwine
@@ -0,0 +1,188 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/types/chunk-storage/lazperf-segmented.hpp>
+
+#include <algorithm>
+#include <functional>
+
+#include <entwine/util/pool.hpp>
+#include <entwine/util/unique.hpp>
+
+namespace entwine
+{
+
+namespace
+{
+    const std::size_t defaultSegmentPoints(65536);
+
+    // Chunk saves and loads are already spread over many threads, so only
+    // large chunks spread further, and only by a little.
+    const std::size_t maxThreads(4);
+
+    void runAll(
+            const std::size_t n,
+            const std::function<void(std::size_t)>& f)
+    {
+        if (n < 2)
+        {
+            for (std::size_t i(0); i < n; ++i) f(i);
+            return;
+        }
+
+        Pool pool(std::min(n, maxThreads));
+        for (std::size_t i(0); i < n; ++i) pool.add([&f, i]() { f(i); });
+        pool.join();
+
+        if (pool.errors().size())
+        {
+            throw std::runtime_error(pool.errors().front());
+        }
+    }
+}
+
+LazPerfSegmentedStorage::LazPerfSegmentedStorage(
+        const Metadata& m,
+        const Json::Value& json)
+    : LazPerfStorage(m, json)
+    , m_segmentPoints(
+            json.isMember("segmentPoints") ?
+                json["segmentPoints"].asUInt64() : defaultSegmentPoints)
+{
+    defaultTail(
+            json,
+            TailFieldList{
+                TailField::Segments,
+                TailField::NumPoints,
+                TailField::NumBytes
+            });
+
+    if (
+            std::find(
+                m_tailFields.begin(),
+                m_tailFields.end(),
+                TailField::Segments) == m_tailFields.end())
+    {
+        throw std::runtime_error("Segmented storage requires a segment tail");
+    }
+
+    if (!m_segmentPoints) throw std::runtime_error("Invalid segmentPoints");
+}
+
+void LazPerfSegmentedStorage::write(Chunk& chunk) const
+{
+    const Schema& schema(chunk.schema());
+    Cell::PooledStack cellStack(chunk.acquire());
+    const std::vector<const char*> points(gatherPoints(cellStack));
+
+    const std::size_t numPoints(points.size());
+    const std::size_t numSegments(
+            std::max<std::size_t>(
+                (numPoints + m_segmentPoints - 1) / m_segmentPoints,
+                1));
+
+    std::vector<std::unique_ptr<std::vector<char>>> compressed(numSegments);
+    TailSegments segments(numSegments);
+
+    runAll(numSegments, [&](const std::size_t i)
+    {
+        const std::size_t begin(i * m_segmentPoints);
+        const std::size_t end(std::min(begin + m_segmentPoints, numPoints));
+
+        Compressor compressor(schema, end - begin, 0);
+        for (std::size_t p(begin); p < end; ++p) compressor.push(points[p]);
+
+        compressed[i] = compressor.data();
+        segments[i] = TailSegment(end - begin, compressed[i]->size());
+    });
+
+    chunk.pool().release(std::move(cellStack));
+
+    std::size_t numBytes(0);
+    for (const auto& c : compressed) numBytes += c->size();
+
+    std::vector<char> data;
+    data.reserve(numBytes + tailSize(segments.size()));
+    for (const auto& c : compressed) append(data, *c);
+
+    append(data, buildTail(chunk, numPoints, numBytes, segments));
+    ensurePut(chunk, m_metadata.basename(chunk.id()), data);
+}
+
+Cell::PooledStack LazPerfSegmentedStorage::read(
+        const arbiter::Endpoint& out,
+        const arbiter::Endpoint& tmp,
+        PointPool& pool,
+        const Id& id) const
+{
+    auto compressed(io::ensureGet(out, m_metadata.basename(id)));
+    const Tail tail(*compressed, m_tailFields);
+    const TailSegments& segments(tail.segments());
+
+    const std::size_t numBytes(compressed->size() + tail.size());
+
+    if (tail.numBytes() && tail.numBytes() != numBytes)
+    {
+        throw std::runtime_error("Invalid segmented chunk numBytes");
+    }
+
+    std::vector<const char*> positions;
+    positions.reserve(segments.size());
+
+    std::size_t offset(0);
+    std::size_t numPoints(0);
+
+    for (const TailSegment& segment : segments)
+    {
+        positions.push_back(compressed->data() + offset);
+        offset += segment.numBytes;
+        numPoints += segment.numPoints;
+    }
+
+    if (offset != compressed->size())
+    {
+        throw std::runtime_error("Invalid segmented chunk segment sizes");
+    }
+    if (tail.numPoints() && tail.numPoints() != numPoints)
+    {
+        throw std::runtime_error("Invalid segmented chunk numPoints");
+    }
+    if (id >= m_metadata.structure().coldIndexBegin() && !numPoints)
+    {
+        throw std::runtime_error("Invalid segmented chunk - no numPoints");
+    }
+
+    std::vector<std::unique_ptr<Cell::PooledStack>> decoded(segments.size());
+
+    runAll(segments.size(), [&](const std::size_t i)
+    {
+        decoded[i] = makeUnique<Cell::PooledStack>(
+                Compression::decompress(
+                    positions[i],
+                    segments[i].numBytes,
+                    segments[i].numPoints,
+                    pool));
+    });
+
+    Cell::PooledStack cellStack(pool.cellPool());
+    for (auto& d : decoded) cellStack.pushBack(std::move(*d));
+
+    return cellStack;
+}
+
+Json::Value LazPerfSegmentedStorage::toJson() const
+{
+    Json::Value json(LazPerfStorage::toJson());
+    json["segmentPoints"] = Json::UInt64(m_segmentPoints);
+    return json;
+}
+
+} // namespace entwine
+
@@ -0,0 +1,44 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <entwine/types/chunk-storage/lazperf.hpp>
+
+namespace entwine
+{
+
+// Lazperf storage where each chunk is split into segments of a fixed number
+// of points, each compressed independently.  The points and bytes of each
+// segment are listed in the tail, so large chunks may be encoded and decoded
+// across threads, and any segment may be decoded on its own.
+class LazPerfSegmentedStorage : public LazPerfStorage
+{
+public:
+    LazPerfSegmentedStorage(
+            const Metadata& m,
+            const Json::Value& json = Json::nullValue);
+
+    virtual void write(Chunk& chunk) const override;
+
+    virtual Cell::PooledStack read(
+            const arbiter::Endpoint& out,
+            const arbiter::Endpoint& tmp,
+            PointPool& pool,
+            const Id& id) const override;
+
+    virtual Json::Value toJson() const override;
+
+private:
+    const std::size_t m_segmentPoints;
+};
+
+} // namespace entwine
+
@@ -15,12 +15,23 @@ namespace entwine
 
 void LazPerfStorage::write(Chunk& chunk) const
 {
-    const std::vector<char> data(buildData(chunk));
-    const auto& schema(chunk.schema());
+    Cell::PooledStack cellStack(chunk.acquire());
 
-    auto comp(Compression::compress(data.data(), data.size(), schema));
+    // Points are compressed straight from their pooled nodes.  Coincident
+    // points are rare, so the cell count is a close estimate of the point
+    // count for sizing the output.
+    Compressor compressor(chunk.schema(), cellStack.size(), tailSize());
+
+    for (const Cell& cell : cellStack)
+    {
+        for (const char* data : cell) compressor.push(data);
+    }
+
+    chunk.pool().release(std::move(cellStack));
+
+    const std::size_t numPoints(compressor.numPoints());
+    auto comp(compressor.data());
 
-    const std::size_t numPoints(data.size() / schema.pointSize());
     append(*comp, buildTail(chunk, numPoints, comp->size()));
     ensurePut(chunk, m_metadata.basename(chunk.id()), *comp);
 }
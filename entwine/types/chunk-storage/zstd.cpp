@@ -0,0 +1,80 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/types/chunk-storage/zstd.hpp>
+
+namespace entwine
+{
+
+namespace
+{
+    const int defaultLevel(3);
+}
+
+ZstdStorage::ZstdStorage(const Metadata& m, const Json::Value& json)
+    : BinaryStorage(m, json)
+    , m_level(
+            json.isMember("zstdLevel") ?
+                json["zstdLevel"].asInt() : defaultLevel)
+{
+    defaultTail(
+            json,
+            TailFieldList{ TailField::NumPoints, TailField::NumBytes });
+}
+
+void ZstdStorage::write(Chunk& chunk) const
+{
+    Cell::PooledStack cellStack(chunk.acquire());
+    const std::vector<const char*> points(gatherPoints(cellStack));
+
+    auto comp(Compression::compressZstd(points, chunk.schema(), m_level));
+    chunk.pool().release(std::move(cellStack));
+
+    append(*comp, buildTail(chunk, points.size(), comp->size()));
+    ensurePut(chunk, m_metadata.basename(chunk.id()), *comp);
+}
+
+Cell::PooledStack ZstdStorage::read(
+        const arbiter::Endpoint& out,
+        const arbiter::Endpoint& tmp,
+        PointPool& pool,
+        const Id& id) const
+{
+    auto compressed(io::ensureGet(out, m_metadata.basename(id)));
+    const Tail tail(*compressed, m_tailFields);
+
+    const std::size_t numPoints(tail.numPoints());
+    const std::size_t numBytes(compressed->size() + tail.size());
+
+    if (id >= m_metadata.structure().coldIndexBegin() && !numPoints)
+    {
+        throw std::runtime_error("Invalid zstd chunk - no numPoints");
+    }
+    if (tail.numBytes() && tail.numBytes() != numBytes)
+    {
+        throw std::runtime_error("Invalid zstd chunk numBytes");
+    }
+
+    return Compression::decompressZstd(
+            compressed->data(),
+            compressed->size(),
+            numPoints,
+            pool);
+}
+
+Json::Value ZstdStorage::toJson() const
+{
+    Json::Value json(BinaryStorage::toJson());
+    json["zstdLevel"] = m_level;
+    return json;
+}
+
+} // namespace entwine
+
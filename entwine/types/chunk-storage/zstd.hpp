@@ -0,0 +1,42 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <entwine/types/chunk-storage/binary.hpp>
+#include <entwine/util/compression.hpp>
+
+namespace entwine
+{
+
+// Byte-shuffled points compressed with Zstandard.  Compresses less tightly
+// than the LAZ codecs, but decodes many times faster.  The compression level
+// is given by "zstdLevel".
+class ZstdStorage : public BinaryStorage
+{
+public:
+    ZstdStorage(const Metadata& m, const Json::Value& json = Json::nullValue);
+
+    virtual void write(Chunk& chunk) const override;
+
+    virtual Cell::PooledStack read(
+            const arbiter::Endpoint& out,
+            const arbiter::Endpoint& tmp,
+            PointPool& pool,
+            const Id& id) const override;
+
+    virtual Json::Value toJson() const override;
+
+private:
+    const int m_level;
+};
+
+} // namespace entwine
+
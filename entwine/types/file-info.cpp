@@ -71,6 +71,7 @@ FileInfo::FileInfo(const Json::Value& json)
         }
 
         if (json.isMember("origin")) m_origin = json["origin"].asUInt64();
+        m_sampled = json["sampled"].asBool();
     }
 }
 
@@ -87,6 +88,7 @@ Json::Value FileInfo::toJson(const bool everything) const
 
     if (m_bounds.exists()) json["bounds"] = m_bounds.toJson();
     if (m_numPoints) json["numPoints"] = (Json::UInt64)m_numPoints;
+    if (m_sampled) json["sampled"] = true;
     if (!m_srs.empty()) json["srs"] = m_srs.getWKT();
 
     if (everything)
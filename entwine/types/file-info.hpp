@@ -54,6 +54,7 @@ public:
     const PointStats& pointStats() const        { return m_pointStats; }
     const Json::Value& metadata() const         { return m_metadata; }
     Origin origin() const { return m_origin; }
+    bool sampled() const { return m_sampled; }
     const Bounds* bounds() const
     {
         return m_bounds.exists() ? &m_bounds : nullptr;
@@ -73,6 +74,7 @@ public:
     void srs(const pdal::SpatialReference& s) { m_srs = s; }
     void metadata(const Json::Value& json) { m_metadata = json; }
     void origin(Origin o) { m_origin = o; }
+    void sampled(bool s) { m_sampled = s; }
 
     void add(const PointStats& stats) { m_pointStats.add(stats); }
 
@@ -96,6 +98,10 @@ private:
     Json::Value m_metadata;
     Origin m_origin = invalidOrigin;
 
+    // If set, our bounds were estimated by sampling rather than by reading
+    // every point, so out-of-bounds points are possible during the build.
+    bool m_sampled = false;
+
     PointStats m_pointStats;
     std::string m_message;
 };
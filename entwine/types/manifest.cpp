@@ -11,8 +11,13 @@
 #include <entwine/types/manifest.hpp>
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <limits>
+#include <string>
+#include <unordered_set>
+#include <utility>
 
 #include <entwine/types/bounds.hpp>
 #include <entwine/util/json.hpp>
@@ -33,8 +38,172 @@ namespace
 
     const std::size_t denseSize(50);
     const std::size_t chunkSize(100);
+
+    const std::string indexName("index");
+    const std::size_t fanout(16);
+
+    template<typename T>
+    void put(std::vector<char>& data, const T v)
+    {
+        const char* pos(reinterpret_cast<const char*>(&v));
+        data.insert(data.end(), pos, pos + sizeof(T));
+    }
+
+    template<typename T>
+    T take(const std::vector<char>& data, std::size_t& pos)
+    {
+        if (pos + sizeof(T) > data.size()) error("Invalid manifest index");
+
+        T v;
+        std::memcpy(&v, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return v;
+    }
+
+    // Position along a Hilbert curve of order 16.
+    uint64_t hilbert(uint32_t x, uint32_t y)
+    {
+        const uint32_t n(1u << 16);
+        uint64_t d(0);
+
+        for (uint32_t s(n / 2); s > 0; s /= 2)
+        {
+            const uint32_t rx((x & s) ? 1 : 0);
+            const uint32_t ry((y & s) ? 1 : 0);
+            d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+
+            if (!ry)
+            {
+                if (rx)
+                {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+
+                std::swap(x, y);
+            }
+        }
+
+        return d;
+    }
 }
 
+class Manifest::SpatialIndex
+{
+public:
+    SpatialIndex(const std::vector<FileInfo>& fileInfo)
+    {
+        Bounds extents;
+        std::vector<Origin> origins;
+
+        for (Origin i(0); i < fileInfo.size(); ++i)
+        {
+            if (const Bounds* b = fileInfo[i].bounds())
+            {
+                if (origins.empty()) extents = *b;
+                else extents.grow(*b);
+                origins.push_back(i);
+            }
+        }
+
+        if (origins.empty()) return;
+
+        const double max(std::numeric_limits<uint16_t>::max());
+        auto scaled([max](double v, double min, double width)
+        {
+            return width > 0 ?
+                static_cast<uint32_t>((v - min) / width * max) : 0;
+        });
+
+        std::vector<std::pair<uint64_t, Origin>> keyed;
+        keyed.reserve(origins.size());
+
+        for (const Origin o : origins)
+        {
+            const Point mid(fileInfo[o].bounds()->mid());
+            keyed.emplace_back(
+                    hilbert(
+                        scaled(mid.x, extents.min().x, extents.width()),
+                        scaled(mid.y, extents.min().y, extents.depth())),
+                    o);
+        }
+
+        std::sort(keyed.begin(), keyed.end());
+
+        m_origins.reserve(keyed.size());
+        m_levels.emplace_back();
+        m_levels.back().reserve(keyed.size());
+
+        for (const auto& k : keyed)
+        {
+            m_origins.push_back(k.second);
+            m_levels.back().push_back(*fileInfo[k.second].bounds());
+        }
+
+        // Each node covers a run of consecutive nodes from the level below.
+        while (m_levels.back().size() > 1)
+        {
+            const std::vector<Bounds>& below(m_levels.back());
+            std::vector<Bounds> level;
+            level.reserve(below.size() / fanout + 1);
+
+            for (std::size_t i(0); i < below.size(); i += fanout)
+            {
+                Bounds b(below[i]);
+                const std::size_t end(std::min(i + fanout, below.size()));
+                for (std::size_t j(i + 1); j < end; ++j) b.grow(below[j]);
+                level.push_back(b);
+            }
+
+            m_levels.push_back(std::move(level));
+        }
+    }
+
+    OriginList find(const Bounds& bounds) const
+    {
+        OriginList origins;
+        if (m_levels.empty()) return origins;
+
+        find(bounds, m_levels.size() - 1, 0, m_levels.back().size(), origins);
+        std::sort(origins.begin(), origins.end());
+        return origins;
+    }
+
+private:
+    void find(
+            const Bounds& bounds,
+            const std::size_t depth,
+            const std::size_t begin,
+            const std::size_t end,
+            OriginList& origins) const
+    {
+        const std::vector<Bounds>& level(m_levels[depth]);
+
+        for (std::size_t i(begin); i < end; ++i)
+        {
+            if (!level[i].overlaps(bounds)) continue;
+
+            if (!depth)
+            {
+                origins.push_back(m_origins[i]);
+            }
+            else
+            {
+                const std::size_t below(m_levels[depth - 1].size());
+                find(
+                        bounds,
+                        depth - 1,
+                        i * fanout,
+                        std::min((i + 1) * fanout, below),
+                        origins);
+            }
+        }
+    }
+
+    std::vector<Origin> m_origins;
+    std::vector<std::vector<Bounds>> m_levels;
+};
+
 Manifest::Manifest(
         const FileInfoList& fileInfo,
         const arbiter::Endpoint& endpoint)
@@ -42,7 +211,9 @@ Manifest::Manifest(
     , m_remote(m_fileInfo.size(), false)
     , m_endpoint(endpoint)
     , m_chunkSize(chunkSize)
-{ }
+{
+    touchFrom(0);
+}
 
 Manifest::Manifest(
         const Json::Value& json,
@@ -51,8 +222,21 @@ Manifest::Manifest(
 {
     if (!json.isObject()) throw std::runtime_error("Invalid manifest JSON");
 
+    m_chunkSize = json["chunkSize"].asUInt64();
+    if (!m_chunkSize) m_chunkSize = chunkSize;
+
     const Json::Value& fileInfo(json["fileInfo"]);
-    if (fileInfo.isArray() && fileInfo.size())
+    if (json["index"].asString() == "binary")
+    {
+        const auto m(m_endpoint.getSubEndpoint("m"));
+        loadIndex(*io::ensureGet(m, indexName));
+
+        if (m_fileInfo.size() != json["size"].asUInt64())
+        {
+            error("Invalid manifest index size");
+        }
+    }
+    else if (fileInfo.isArray() && fileInfo.size())
     {
         m_fileInfo.reserve(fileInfo.size());
         for (Json::ArrayIndex i(0); i < fileInfo.size(); ++i)
@@ -63,12 +247,14 @@ Manifest::Manifest(
         }
     }
 
-    m_chunkSize = json["chunkSize"].asUInt64();
-    if (!m_chunkSize) m_chunkSize = chunkSize;
-
     const bool remote(json["remote"].asBool());
     m_remote.resize(m_fileInfo.size(), remote);
 
+    // Remote shards have already been written.  Otherwise everything will be
+    // written out in pieces on the first save.
+    m_dirty.resize(m_fileInfo.size() / m_chunkSize + 1, !remote);
+    m_indexDirty = json["index"].asString() != "binary";
+
     // If we have fileStats and pointStats, then we're dealing with a full
     // manifest from Manifest::toJson (a previous build).  Otherwise, we have
     // a simplified manifest from Manifest::toInferenceJson.
@@ -83,12 +269,16 @@ Manifest::Manifest(
 Manifest::Manifest(const Manifest& other)
     : m_fileInfo(other.m_fileInfo)
     , m_remote(other.m_remote)
+    , m_dirty(other.m_dirty)
+    , m_indexDirty(other.m_indexDirty)
     , m_fileStats(other.m_fileStats)
     , m_pointStats(other.m_pointStats)
     , m_endpoint(other.m_endpoint)
     , m_chunkSize(other.m_chunkSize)
 { }
 
+Manifest::~Manifest() { }
+
 Origin Manifest::find(const std::string& search) const
 {
     for (std::size_t i(0); i < size(); ++i)
@@ -101,41 +291,57 @@ Origin Manifest::find(const std::string& search) const
 
 OriginList Manifest::find(const Bounds& bounds) const
 {
-    OriginList origins;
-
-    for (std::size_t i(0); i < size(); ++i)
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_spatialIndex)
     {
-        if (const auto b = m_fileInfo[i].bounds())
-        {
-            if (b->overlaps(bounds)) origins.push_back(i);
-        }
+        m_spatialIndex = makeUnique<SpatialIndex>(m_fileInfo);
     }
 
-    return origins;
+    return m_spatialIndex->find(bounds);
 }
 
 void Manifest::append(const FileInfoList& fileInfo)
 {
     FileInfoList adding(diff(fileInfo));
 
+    if (adding.empty()) return;
+
+    const Origin begin(m_fileInfo.size());
     for (const auto& f : adding)
     {
         m_fileInfo.emplace_back(f);
         m_remote.push_back(false);
     }
+
+    touchFrom(begin);
+}
+
+void Manifest::touchFrom(const Origin begin)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_dirty.resize(m_fileInfo.size() / m_chunkSize + 1, true);
+    for (std::size_t i(begin / m_chunkSize); i < m_dirty.size(); ++i)
+    {
+        m_dirty[i] = true;
+    }
+
+    m_indexDirty = true;
+    m_spatialIndex.reset();
 }
 
 FileInfoList Manifest::diff(const FileInfoList& in) const
 {
+    // Inputs may number in the hundreds of thousands, so don't compare every
+    // pair.  Duplicates within the input itself are also dropped.
+    std::unordered_set<std::string> paths;
+    paths.reserve(m_fileInfo.size() + in.size());
+    for (const auto& f : m_fileInfo) paths.insert(f.path());
+
     FileInfoList out;
     for (const auto& f : in)
     {
-        auto matches([&f](const FileInfo& x) { return f.path() == x.path(); });
-
-        if (std::none_of(m_fileInfo.begin(), m_fileInfo.end(), matches))
-        {
-            out.emplace_back(f);
-        }
+        if (paths.insert(f.path()).second) out.emplace_back(f);
     }
 
     return out;
@@ -174,6 +380,8 @@ void Manifest::merge(const Manifest& other)
 
     m_pointStats.add(other.pointStats());
     m_fileStats.add(fileStats);
+
+    touchFrom(0);
 }
 
 Json::Value Manifest::toJson() const
@@ -253,7 +461,6 @@ void Manifest::save(const bool primary, const std::string postfix) const
     Json::Value json;
     json["fileStats"] = m_fileStats.toJson();
     json["pointStats"] = m_pointStats.toJson();
-    Json::Value& fileInfo(json["fileInfo"]);
 
     // If we have a postfix (and therefore we're a subset), we'll just write
     // everything out together even if it's huge.  The split-up metadata is a
@@ -261,10 +468,12 @@ void Manifest::save(const bool primary, const std::string postfix) const
     // build time anyway.
     const auto n(size());
     const bool dense(n <= denseSize || postfix.size());
-    fileInfo.resize(n);
 
     if (dense || (m.isLocal() && !arbiter::fs::mkdirp(m.root())))
     {
+        Json::Value& fileInfo(json["fileInfo"]);
+        fileInfo.resize(n);
+
         for (Json::ArrayIndex i(0); i < n; ++i)
         {
             fileInfo[i] = m_fileInfo[i].toJson(primary);
@@ -274,25 +483,29 @@ void Manifest::save(const bool primary, const std::string postfix) const
     {
         assert(postfix.empty());
 
-        for (Json::ArrayIndex i(0); i < n; ++i)
-        {
-            // We're storing the file info separately, so the "fileInfo" key
-            // will just contain path/bounds instead of the full info object.
-            json["remote"] = true;
-            json["chunkSize"] = static_cast<Json::UInt64>(chunkSize);
-            fileInfo[i]["path"] = m_fileInfo[i].path();
+        // We're storing the file info separately, so the top-level manifest
+        // will just contain our statistics.
+        json["remote"] = true;
+        json["chunkSize"] = static_cast<Json::UInt64>(m_chunkSize);
+        json["size"] = static_cast<Json::UInt64>(n);
+        json["index"] = "binary";
 
-            if (const auto b = m_fileInfo[i].bounds())
-            {
-                fileInfo[i]["bounds"] = b->toJson();
-            }
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_indexDirty)
+        {
+            io::ensurePut(m, indexName, indexData());
+            m_indexDirty = false;
         }
 
         // TODO Could pool these.
-        for (Json::ArrayIndex i(0); i < n; i += chunkSize)
+        for (std::size_t i(0); i < n; i += m_chunkSize)
         {
+            std::vector<bool>::reference dirty(m_dirty.at(i / m_chunkSize));
+            if (!dirty) continue;
+
             Json::Value chunk;
-            chunk.resize(std::min(chunkSize, n - i));
+            chunk.resize(std::min(m_chunkSize, n - i));
 
             for (Json::ArrayIndex c(0); c < chunk.size(); ++c)
             {
@@ -300,6 +513,7 @@ void Manifest::save(const bool primary, const std::string postfix) const
             }
 
             io::ensurePut(m, std::to_string(i), chunk.toStyledString());
+            dirty = false;
         }
     }
 
@@ -309,5 +523,60 @@ void Manifest::save(const bool primary, const std::string postfix) const
             primary ? json.toStyledString() : toFastString(json));
 }
 
+std::vector<char> Manifest::indexData() const
+{
+    // Per file: the length of its path, the path, a flag for the presence of
+    // bounds, and if present, the bounds as min and max points.
+    std::vector<char> data;
+    put<uint64_t>(data, m_fileInfo.size());
+
+    for (const FileInfo& f : m_fileInfo)
+    {
+        put<uint32_t>(data, f.path().size());
+        data.insert(data.end(), f.path().begin(), f.path().end());
+
+        const Bounds* b(f.bounds());
+        put<uint8_t>(data, b ? 1 : 0);
+
+        if (b)
+        {
+            for (const Point& p : { b->min(), b->max() })
+            {
+                put<double>(data, p.x);
+                put<double>(data, p.y);
+                put<double>(data, p.z);
+            }
+        }
+    }
+
+    return data;
+}
+
+void Manifest::loadIndex(const std::vector<char>& data)
+{
+    std::size_t pos(0);
+    const uint64_t n(take<uint64_t>(data, pos));
+    m_fileInfo.reserve(n);
+
+    for (uint64_t i(0); i < n; ++i)
+    {
+        const uint32_t size(take<uint32_t>(data, pos));
+        if (pos + size > data.size()) error("Invalid manifest index");
+
+        m_fileInfo.emplace_back(std::string(data.data() + pos, size));
+        pos += size;
+
+        FileInfo& f(m_fileInfo.back());
+        f.origin(i);
+
+        if (take<uint8_t>(data, pos))
+        {
+            double v[6];
+            for (double& d : v) d = take<double>(data, pos);
+            f.bounds(Bounds(Point(v[0], v[1], v[2]), Point(v[3], v[4], v[5])));
+        }
+    }
+}
+
 } // namespace entwine
 
@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -31,6 +32,13 @@ namespace entwine
 class Bounds;
 class Pool;
 
+// The list of input files of a build, indexed by Origin.
+//
+// Large manifests are stored in pieces.  The top-level manifest holds only
+// the aggregate statistics, and the path and bounds of every file are stored
+// in a compact binary index at m/index.  The full info of each file lives in
+// JSON shards of chunkSize files at m/<first-origin>, which are loaded lazily
+// and only rewritten on save if one of their files has changed.
 class Manifest
 {
 public:
@@ -41,6 +49,7 @@ public:
     Manifest(const Json::Value& json, const arbiter::Endpoint& endpoint);
 
     Manifest(const Manifest& other);
+    ~Manifest();
 
     FileInfoList diff(const FileInfoList& fileInfo) const;
     void append(const FileInfoList& fileInfo);
@@ -53,16 +62,17 @@ public:
     OriginList find(const Filter& filter) const;
 
     FileInfo& get(Origin o) { awaken(o); return m_fileInfo.at(o); }
+
     const FileInfo& get(Origin o) const { awaken(o); return m_fileInfo.at(o); }
     void set(Origin origin, FileInfo::Status status, std::string message = "")
     {
         countStatus(status);
-        get(origin).status(status, message);
+        mutate(origin).status(status, message);
     }
 
     void add(Origin origin, const PointStats& stats)
     {
-        get(origin).add(stats);
+        mutate(origin).add(stats);
 
         std::lock_guard<std::mutex> lock(m_mutex);
         m_pointStats.add(stats);
@@ -81,7 +91,7 @@ public:
 
     void addOutOfBounds(Origin origin, std::size_t count, bool primary)
     {
-        get(origin).pointStats().addOutOfBounds(count);
+        mutate(origin).pointStats().addOutOfBounds(count);
         if (primary) m_pointStats.addOutOfBounds(count);
     }
 
@@ -117,8 +127,33 @@ public:
     const std::vector<FileInfo>& fileInfo() const { return m_fileInfo; }
 
 private:
+    // A packed R-tree over the bounds of our files, in Hilbert order.
+    class SpatialIndex;
+
     void awaken(Origin origin) const;
 
+    // Note that the shard containing this origin needs to be rewritten.
+    void touch(Origin origin)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dirty.at(origin / m_chunkSize) = true;
+    }
+
+    // Access for modification, so the containing shard is rewritten on save.
+    // Lookups alone never dirty a shard.
+    FileInfo& mutate(Origin origin)
+    {
+        awaken(origin);
+        touch(origin);
+        return m_fileInfo.at(origin);
+    }
+
+    // Note that the shards from this origin onward have been added to.
+    void touchFrom(Origin begin);
+
+    std::vector<char> indexData() const;
+    void loadIndex(const std::vector<char>& data);
+
     void countStatus(FileInfo::Status status)
     {
         switch (status)
@@ -134,6 +169,12 @@ private:
     mutable std::vector<FileInfo> m_fileInfo;
     mutable std::vector<bool> m_remote;
 
+    // Per-shard, whether the shard differs from what has been saved.  The
+    // index is rewritten only when files are added.
+    mutable std::vector<bool> m_dirty;
+    mutable bool m_indexDirty = true;
+    mutable std::unique_ptr<SpatialIndex> m_spatialIndex;
+
     FileStats m_fileStats;
     PointStats m_pointStats;
 
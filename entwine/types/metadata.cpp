@@ -46,7 +46,8 @@ Metadata::Metadata(
         const Delta* delta,
         const Transformation* transformation,
         const cesium::Settings* cesiumSettings,
-        const std::vector<std::string> preserveSpatial)
+        const std::vector<std::string> preserveSpatial,
+        const Json::Value& storageOptions)
     : m_delta(maybeClone(delta))
     , m_boundsNativeConforming(clone(boundsNativeConforming))
     , m_boundsNativeCubic(clone(makeNativeCube(boundsNativeConforming, delta)))
@@ -60,7 +61,12 @@ Metadata::Metadata(
     , m_structure(makeUnique<Structure>(structure))
     , m_hierarchyStructure(makeUnique<Structure>(hierarchyStructure))
     , m_manifest(makeUnique<Manifest>(manifest))
-    , m_storage(makeUnique<Storage>(*this, chunkStorage, hierarchyCompress))
+    , m_storage(
+            makeUnique<Storage>(
+                *this,
+                chunkStorage,
+                hierarchyCompress,
+                storageOptions))
     , m_reprojection(maybeClone(reprojection))
     , m_subset(maybeClone(subset))
     , m_transformation(maybeClone(transformation))
@@ -269,6 +275,7 @@ void Metadata::merge(const Metadata& other)
 {
     if (m_srs.empty()) m_srs = other.srs();
     m_manifest->merge(other.manifest());
+    m_storage->merge(other.storage());
 }
 
 std::string Metadata::basename(const Id& chunkId) const
@@ -59,7 +59,8 @@ public:
             const std::vector<double>* transformation = nullptr,
             const cesium::Settings* cesiumSettings = nullptr,
             std::vector<std::string> preserveSpatial =
-                std::vector<std::string>());
+                std::vector<std::string>(),
+            const Json::Value& storageOptions = Json::nullValue);
 
     Metadata(const arbiter::Endpoint& endpoint);
 
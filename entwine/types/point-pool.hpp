@@ -129,6 +129,24 @@ public:
     const Delta* delta() const { return m_delta; }
     Data::Pool& dataPool() { return m_dataPool; }
     Cell::Pool& cellPool() { return m_cellPool; }
+    const Data::Pool& dataPool() const { return m_dataPool; }
+    const Cell::Pool& cellPool() const { return m_cellPool; }
+
+    // Pooled bytes per point in use, including the bookkeeping of cells and
+    // data nodes as well as the point data itself.
+    double bytesPerPoint() const
+    {
+        const std::size_t cells(
+                m_cellPool.allocated() - m_cellPool.available());
+        const std::size_t points(
+                m_dataPool.allocated() - m_dataPool.available());
+        if (!points) return 0;
+
+        return (
+                cells * sizeof(Cell::RawNode) +
+                points * (sizeof(Data::RawNode) + m_schema.pointSize())) /
+            static_cast<double>(points);
+    }
 
     void release(Cell::PooledStack cells)
     {
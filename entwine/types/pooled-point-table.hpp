@@ -10,8 +10,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <utility>
+#include <vector>
 
 #include <pdal/Dimension.hpp>
 #include <pdal/PointTable.hpp>
@@ -259,20 +262,7 @@ public:
             }
         }
 
-        using DimId = pdal::Dimension::Id;
-        BinaryPointTable ta(m_schema), tb(m_schema);
-
-        std::sort(
-                m_refs.begin(),
-                m_refs.end(),
-                [&ta, &tb](const Ref& a, const Ref& b)
-                {
-                    ta.setPoint(a.data());
-                    tb.setPoint(b.data());
-                    return
-                        ta.ref().getFieldAs<double>(DimId::GpsTime) <
-                        tb.ref().getFieldAs<double>(DimId::GpsTime);
-                });
+        if (m_schema.hasTime()) sortByTime();
     }
 
     ~CellTable() { m_pool.release(acquire()); }
@@ -381,6 +371,31 @@ private:
         }
     }
 
+    // Extract each sort key once up front, rather than on every comparison.
+    // Ties keep their original order.
+    void sortByTime()
+    {
+        std::vector<std::pair<double, std::size_t>> keys;
+        keys.reserve(m_refs.size());
+
+        BinaryPointTable table(m_schema);
+        for (std::size_t i(0); i < m_refs.size(); ++i)
+        {
+            table.setPoint(m_refs[i].data());
+            keys.emplace_back(
+                    table.ref().getFieldAs<double>(
+                        pdal::Dimension::Id::GpsTime),
+                    i);
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<Ref> sorted;
+        sorted.reserve(m_refs.size());
+        for (const auto& k : keys) sorted.push_back(m_refs[k.second]);
+        m_refs = std::move(sorted);
+    }
+
     class Ref
     {
     public:
@@ -24,12 +24,34 @@ namespace entwine
 {
 
 enum class ChunkType : char { Sparse = 0, Contiguous, Invalid };
-enum class TailField { ChunkType, NumPoints, NumBytes };
-enum class ChunkStorageType { Binary, LasZip, LazPerf };
+enum class TailField { ChunkType, NumPoints, NumBytes, Segments };
+enum class ChunkStorageType
+{
+    Binary,
+    LasZip,
+    LazPerf,
+    LazPerfSegmented,
+    Zstandard
+};
 enum class HierarchyCompression { None, Lzma };
 
 using TailFieldList = std::vector<TailField>;
 
+// An independently decodable run of points within a chunk.  Segments are
+// stored back to back, in order, ahead of the tail.
+struct TailSegment
+{
+    TailSegment(uint64_t numPoints = 0, uint64_t numBytes = 0)
+        : numPoints(numPoints)
+        , numBytes(numBytes)
+    { }
+
+    uint64_t numPoints;
+    uint64_t numBytes;
+};
+
+using TailSegments = std::vector<TailSegment>;
+
 class Tail
 {
 public:
@@ -49,6 +71,9 @@ public:
                 case TailField::NumBytes:
                     m_numBytes = extract<uint64_t>(data);
                     break;
+                case TailField::Segments:
+                    extractSegments(data);
+                    break;
                 default:
                     throw std::runtime_error("Invalid tail field value");
             }
@@ -59,8 +84,41 @@ public:
     ChunkType type() const { return m_type; }
     std::size_t numPoints() const { return m_numPoints; }
     std::size_t numBytes() const { return m_numBytes; }
+    const TailSegments& segments() const { return m_segments; }
 
 private:
+    // Stored as a numPoints/numBytes pair per segment, followed by the number
+    // of segments.
+    void extractSegments(std::vector<char>& data)
+    {
+        const uint64_t count(extract<uint64_t>(data));
+        const std::size_t pairSize(2 * sizeof(uint64_t));
+        if (count > data.size() / pairSize)
+        {
+            throw std::runtime_error("Invalid chunk segments");
+        }
+
+        const std::size_t size(count * pairSize);
+        const char* pos(data.data() + data.size() - size);
+
+        auto next([&pos]()
+        {
+            uint64_t v(0);
+            std::copy(pos, pos + sizeof(v), reinterpret_cast<char*>(&v));
+            pos += sizeof(v);
+            return v;
+        });
+
+        for (uint64_t i(0); i < count; ++i)
+        {
+            const uint64_t numPoints(next());
+            m_segments.emplace_back(numPoints, next());
+        }
+
+        data.resize(data.size() - size);
+        m_size += size;
+    }
+
     template<typename T>
     T extract(std::vector<char>& data)
     {
@@ -81,6 +139,7 @@ private:
     ChunkType m_type = ChunkType::Invalid;
     std::size_t m_numPoints = 0;
     std::size_t m_numBytes = 0;
+    TailSegments m_segments;
 };
 
 inline std::string toString(ChunkStorageType c)
@@ -90,6 +149,8 @@ inline std::string toString(ChunkStorageType c)
         case ChunkStorageType::LasZip: return "laszip";
         case ChunkStorageType::LazPerf: return "lazperf";
         case ChunkStorageType::Binary: return "binary";
+        case ChunkStorageType::LazPerfSegmented: return "lazperf-segmented";
+        case ChunkStorageType::Zstandard: return "zstd";
         default: throw std::runtime_error("Invalid ChunkStorageType value");
     }
 }
@@ -104,6 +165,8 @@ inline ChunkStorageType toChunkStorageType(const Json::Value& j)
     const std::string s(j.asString());
     if (s == "laszip") return ChunkStorageType::LasZip;
     if (s == "lazperf") return ChunkStorageType::LazPerf;
+    if (s == "lazperf-segmented") return ChunkStorageType::LazPerfSegmented;
+    if (s == "zstd") return ChunkStorageType::Zstandard;
     throw std::runtime_error("Invalid compression: " + j.toStyledString());
 }
 
@@ -114,6 +177,7 @@ inline std::string toString(TailField t)
         case TailField::ChunkType: return "chunkType";
         case TailField::NumPoints: return "numPoints";
         case TailField::NumBytes: return "numBytes";
+        case TailField::Segments: return "segments";
         default: throw std::runtime_error("Invalid TailField value");
     }
 }
@@ -123,6 +187,7 @@ inline TailField toTailField(const std::string& s)
     if (s == "chunkType") return TailField::ChunkType;
     if (s == "numPoints") return TailField::NumPoints;
     if (s == "numBytes") return TailField::NumBytes;
+    if (s == "segments") return TailField::Segments;
     throw std::runtime_error("Invalid tail field: " + s);
 }
 
@@ -10,6 +10,7 @@
 
 #include <entwine/types/storage.hpp>
 
+#include <algorithm>
 #include <numeric>
 
 #include <entwine/third/arbiter/arbiter.hpp>
@@ -30,12 +31,16 @@ namespace entwine
 Storage::Storage(
         const Metadata& metadata,
         const ChunkStorageType chunkStorageType,
-        const HierarchyCompression hierarchyCompression)
+        const HierarchyCompression hierarchyCompression,
+        const Json::Value& options)
     : m_metadata(metadata)
+    , m_json(options)
     , m_chunkStorageType(chunkStorageType)
     , m_hierarchyCompression(hierarchyCompression)
+    , m_baseBytes(makeUnique<uint64_t>(0))
+    , m_reads(0)
 {
-    m_storage = ChunkStorage::create(m_metadata, m_chunkStorageType);
+    m_storage = ChunkStorage::create(m_metadata, m_chunkStorageType, m_json);
 }
 
 Storage::Storage(const Metadata& metadata, const Json::Value& json)
@@ -43,6 +48,11 @@ Storage::Storage(const Metadata& metadata, const Json::Value& json)
     , m_json(json)
     , m_chunkStorageType(toChunkStorageType(json["storage"]))
     , m_hierarchyCompression(toHierarchyCompression(json["compressHierarchy"]))
+    , m_baseBytes(
+            json.isMember("chunkBytes") ?
+                makeUnique<uint64_t>(json["chunkBytes"].asUInt64()) :
+                nullptr)
+    , m_reads(0)
 {
     m_storage = ChunkStorage::create(m_metadata, m_chunkStorageType, m_json);
 }
@@ -52,6 +62,11 @@ Storage::Storage(const Metadata& metadata, const Storage& other)
     , m_json(other.m_json)
     , m_chunkStorageType(other.m_chunkStorageType)
     , m_hierarchyCompression(other.m_hierarchyCompression)
+    , m_baseBytes(
+            other.m_baseBytes ?
+                makeUnique<uint64_t>(other.totalBytes()) :
+                nullptr)
+    , m_reads(0)
 {
     m_storage = ChunkStorage::create(m_metadata, m_chunkStorageType, m_json);
 }
@@ -67,6 +82,8 @@ Json::Value Storage::toJson() const
     const auto s(m_storage->toJson());
     for (const auto f : s.getMemberNames()) json[f] = s[f];
 
+    if (m_baseBytes) json["chunkBytes"] = Json::UInt64(totalBytes());
+
     return json;
 }
 
@@ -82,6 +99,7 @@ Cell::PooledStack Storage::deserialize(
         PointPool& pool,
         const Id& chunkId) const
 {
+    ++m_reads;
     return m_storage->read(out, tmp, pool, chunkId);
 }
 
@@ -92,5 +110,37 @@ std::string Storage::filename(const Id& id) const
     return m_storage->filename(id);
 }
 
+StorageStats Storage::stats() const
+{
+    StorageStats s(m_storage->stats());
+    s.reads = m_reads;
+    return s;
+}
+
+uint64_t Storage::totalBytes() const
+{
+    if (!m_baseBytes) return 0;
+
+    // Only chunks loaded from our output are checked for replaced data, and
+    // those were written either by a previous run, so they count toward our
+    // base, or by this one, so they count toward our written bytes.  So this
+    // holds even if a chunk is written more than once by a single run.
+    const StorageStats s(stats());
+    const uint64_t total(*m_baseBytes + s.bytes);
+    return total - std::min(s.replacedBytes, total);
+}
+
+void Storage::merge(const Storage& other)
+{
+    if (m_baseBytes && other.m_baseBytes)
+    {
+        *m_baseBytes += other.totalBytes();
+    }
+    else
+    {
+        m_baseBytes.reset();
+    }
+}
+
 } // namespace entwine
 
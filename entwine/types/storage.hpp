@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <set>
@@ -34,13 +36,28 @@ class Chunk;
 class ChunkStorage;
 class Metadata;
 
+// Chunk data read and written by this process.  When continuing an existing
+// index, only chunks that received new points are loaded and rewritten, and the
+// size of the data they replace is tracked as well.
+struct StorageStats
+{
+    std::size_t reads = 0;
+    std::size_t chunks = 0;
+    std::size_t rewrites = 0;
+    uint64_t bytes = 0;
+    uint64_t replacedBytes = 0;
+};
+
 class Storage
 {
 public:
+    // For new builds.  The options are passed along to the chunk storage, for
+    // example the "zstdLevel" of zstd storage.
     Storage(
             const Metadata& metadata,
             ChunkStorageType compression = ChunkStorageType::LasZip,
-            HierarchyCompression hc = HierarchyCompression::Lzma);
+            HierarchyCompression hc = HierarchyCompression::Lzma,
+            const Json::Value& options = Json::nullValue);
     Storage(const Metadata& metadata, const Storage& other);
     Storage(const Metadata& metadata, const Json::Value& json);
     Storage(const Storage&) = delete;
@@ -65,6 +82,15 @@ public:
     const Schema& schema() const;
     std::string filename(const Id& id) const;
 
+    StorageStats stats() const;
+
+    // Total size of the stored chunk data of this index, including that of
+    // previous runs.  Zero if the index was created before this was tracked.
+    uint64_t totalBytes() const;
+
+    // Account for the chunk data of a subset merged into this one.
+    void merge(const Storage& other);
+
 private:
     const Metadata& m_metadata;
     const Json::Value m_json;
@@ -72,7 +98,11 @@ private:
     ChunkStorageType m_chunkStorageType;
     HierarchyCompression m_hierarchyCompression;
 
+    // Total chunk bytes as of the start of this run, if known.
+    std::unique_ptr<uint64_t> m_baseBytes;
+
     std::unique_ptr<ChunkStorage> m_storage;
+    mutable std::atomic<std::size_t> m_reads;
 };
 
 } // namespace entwine
@@ -10,22 +10,91 @@
 
 #include <entwine/types/subset.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+
 #include <entwine/tree/climber.hpp>
+#include <entwine/tree/heuristics.hpp>
 #include <entwine/tree/hierarchy.hpp>
+#include <entwine/types/file-info.hpp>
 #include <entwine/types/metadata.hpp>
 #include <entwine/types/structure.hpp>
+#include <entwine/util/json.hpp>
 
 namespace entwine
 {
 
+namespace
+{
+    const std::size_t dimensions(2);
+    const std::size_t factor(4);
+    const std::size_t mask(0x3);
+
+    // Number of quadtree levels below the cube needed to produce at least
+    // this many nodes.
+    std::size_t levels(std::size_t n)
+    {
+        std::size_t depth(1);
+        std::size_t cap(factor);
+
+        while (cap < n)
+        {
+            ++depth;
+            cap *= factor;
+        }
+
+        return depth;
+    }
+
+    // Index, in the order that nodes are laid out within a depth of the tree,
+    // of the node at this grid position.
+    std::size_t interleave(std::size_t x, std::size_t y, std::size_t depth)
+    {
+        std::size_t index(0);
+        for (std::size_t i(depth - 1); i < depth; --i)
+        {
+            index = (index << dimensions) |
+                (((y >> i) & 1) << 1) |
+                ((x >> i) & 1);
+        }
+        return index;
+    }
+}
+
 Subset::Subset(
         const Bounds& bounds,
         const std::size_t id,
         const std::size_t of)
+    : Subset(bounds, id, of, std::vector<std::size_t>())
+{ }
+
+Subset::Subset(
+        const Bounds& bounds,
+        const std::size_t id,
+        const std::vector<std::size_t>& splits)
+    : Subset(bounds, id, splits.empty() ? 0 : splits.size() - 1, splits)
+{ }
+
+Subset::Subset(const Bounds& bounds, const Json::Value& json)
+    : Subset(
+            bounds,
+            json["id"].asUInt64(),
+            json["of"].asUInt64(),
+            extract<std::size_t>(json["splits"]))
+{ }
+
+Subset::Subset(
+        const Bounds& bounds,
+        const std::size_t id,
+        const std::size_t of,
+        const std::vector<std::size_t>& splits)
     : m_id(id - 1)
     , m_of(of)
     , m_sub()
     , m_minimumNullDepth(1)
+    , m_splits(splits)
 {
     if (!id) throw std::runtime_error("Subset IDs should be 1-based.");
     if (id > of) throw std::runtime_error("Invalid subset ID - too large.");
@@ -37,33 +106,53 @@ Subset::Subset(
 
     // Always split only in X-Y, since data tends not to be dense throughout
     // the entire Z-range.
-    const std::size_t dimensions(2);
-    const std::size_t factor(4);
+    std::size_t begin(0);
+    std::size_t end(0);
 
-    const std::size_t log(std::log2(m_of));
-
-    if (static_cast<std::size_t>(std::pow(2, log)) != m_of)
+    if (m_splits.empty())
     {
-        throw std::runtime_error("Subset range must be a power of 2");
-    }
+        const std::size_t log(std::log2(m_of));
+
+        if (static_cast<std::size_t>(std::pow(2, log)) != m_of)
+        {
+            throw std::runtime_error("Subset range must be a power of 2");
+        }
 
-    std::size_t cap(factor);
+        m_minimumNullDepth = levels(m_of);
 
-    while (cap < m_of)
-    {
-        ++m_minimumNullDepth;
-        cap *= factor;
+        const std::size_t cap(std::pow(factor, m_minimumNullDepth));
+        const std::size_t boxes(cap / m_of);
+
+        begin = m_id * boxes;
+        end = begin + boxes;
     }
+    else
+    {
+        // Explicit splits are cumulative node counts at a single depth of the
+        // quadtree, so every subset is still a contiguous run of nodes.
+        m_minimumNullDepth = levels(m_splits.back());
+
+        if (
+                m_splits.size() != m_of + 1 ||
+                m_splits.front() != 0 ||
+                std::pow(factor, m_minimumNullDepth) != m_splits.back() ||
+                std::adjacent_find(
+                    m_splits.begin(),
+                    m_splits.end(),
+                    std::greater_equal<std::size_t>()) != m_splits.end())
+        {
+            throw std::runtime_error("Invalid subset splits");
+        }
 
-    const std::size_t boxes(cap / m_of);
-    const std::size_t startOffset(m_id * boxes);
+        begin = m_splits[m_id];
+        end = m_splits[m_id + 1];
+    }
 
-    const std::size_t iterations(ChunkInfo::logN(cap, factor));
-    const std::size_t mask(0x3);
+    const std::size_t iterations(m_minimumNullDepth);
 
     bool set(false);
 
-    for (std::size_t curId(startOffset); curId < startOffset + boxes; ++curId)
+    for (std::size_t curId(begin); curId < end; ++curId)
     {
         Bounds current(bounds);
 
@@ -87,34 +176,110 @@ Subset::Subset(
     }
 }
 
-Subset::Subset(const Bounds& bounds, const Json::Value& json)
-    : Subset(bounds, json["id"].asUInt64(), json["of"].asUInt64())
-{ }
-
 Json::Value Subset::toJson() const
 {
     Json::Value json;
 
     json["id"] = static_cast<Json::UInt64>(m_id + 1);
     json["of"] = static_cast<Json::UInt64>(m_of);
+    if (m_splits.size()) json["splits"] = toJsonArray(m_splits);
 
     return json;
 }
 
-std::size_t Subset::minimumBaseDepth(const std::size_t pointsPerChunk) const
+std::vector<std::size_t> Subset::balance(
+        const Bounds& bounds,
+        const std::size_t of,
+        const FileInfoList& fileInfo)
 {
-    const std::size_t nominalChunkDepth(ChunkInfo::logN(pointsPerChunk, 4));
-    std::size_t min(nominalChunkDepth);
+    if (of <= 1) throw std::runtime_error("Invalid subset range");
+
+    const std::size_t depth(levels(of) + heuristics::subsetBalanceDepth);
+    const std::size_t cap(std::pow(factor, depth));
+    const std::size_t n(std::size_t(1) << depth);   // Grid cells per side.
+
+    const double cw(bounds.width() / n);
+    const double ch(bounds.depth() / n);
+
+    auto cell([n](double v, double min, double size)
+    {
+        const double c(std::floor((v - min) / size));
+        return static_cast<std::size_t>(
+                std::max(0.0, std::min<double>(c, n - 1)));
+    });
+
+    // Distribute the points of each file among the nodes at this depth by
+    // their overlap with the file's bounds.
+    std::vector<double> weights(cap, 0);
 
-    std::size_t chunksAtDepth(1);
+    for (const FileInfo& f : fileInfo)
+    {
+        const Bounds* b(f.bounds());
+        if (!b || !f.numPoints()) continue;
+
+        const Point& min(bounds.min());
+        const std::size_t xb(cell(b->min().x, min.x, cw));
+        const std::size_t xe(cell(b->max().x, min.x, cw));
+        const std::size_t yb(cell(b->min().y, min.y, ch));
+        const std::size_t ye(cell(b->max().y, min.y, ch));
+
+        const double area(b->area());
+
+        for (std::size_t y(yb); y <= ye; ++y)
+        {
+            for (std::size_t x(xb); x <= xe; ++x)
+            {
+                double share(1.0 / ((xe - xb + 1) * (ye - yb + 1)));
+
+                if (area > 0)
+                {
+                    const double x0(std::max(b->min().x, min.x + x * cw));
+                    const double x1(std::min(b->max().x, min.x + (x + 1) * cw));
+                    const double y0(std::max(b->min().y, min.y + y * ch));
+                    const double y1(std::min(b->max().y, min.y + (y + 1) * ch));
+
+                    share =
+                        std::max(0.0, x1 - x0) *
+                        std::max(0.0, y1 - y0) / area;
+                }
 
-    while (chunksAtDepth < m_of)
+                weights[interleave(x, y, depth)] += f.numPoints() * share;
+            }
+        }
+    }
+
+    std::vector<double> cumulative(cap);
+    std::partial_sum(weights.begin(), weights.end(), cumulative.begin());
+    const double total(cumulative.back());
+
+    // Each subset ends at the first node which brings it to its share of the
+    // total, but every subset gets at least one node.
+    std::vector<std::size_t> splits(1, 0);
+
+    for (std::size_t i(1); i < of; ++i)
     {
-        ++min;
-        chunksAtDepth *= 4;
+        const double target(total * i / of);
+        std::size_t split(
+                total > 0 ?
+                    std::lower_bound(
+                        cumulative.begin(),
+                        cumulative.end(),
+                        target) - cumulative.begin() + 1 :
+                    cap * i / of);
+
+        split = std::max(split, splits.back() + 1);
+        split = std::min(split, cap - (of - i));
+        splits.push_back(split);
     }
 
-    return min;
+    splits.push_back(cap);
+    return splits;
+}
+
+std::size_t Subset::minimumBaseDepth(const std::size_t pointsPerChunk) const
+{
+    const std::size_t nominalChunkDepth(ChunkInfo::logN(pointsPerChunk, 4));
+    return nominalChunkDepth + m_minimumNullDepth;
 }
 
 std::vector<Subset::Span> Subset::calcSpans(
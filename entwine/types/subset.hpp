@@ -24,6 +24,7 @@ namespace Json
 namespace entwine
 {
 
+class FileInfo;
 class Metadata;
 class Structure;
 
@@ -33,11 +34,28 @@ public:
     Subset(const Bounds& boundsNativeCubic, std::size_t id, std::size_t of);
     Subset(const Bounds& boundsNativeCubic, const Json::Value& json);
 
+    // Splits are cumulative counts of quadtree nodes at a single depth,
+    // beginning at zero and ending at a power of 4, as produced by balance().
+    Subset(
+            const Bounds& boundsNativeCubic,
+            std::size_t id,
+            const std::vector<std::size_t>& splits);
+
+    // Choose splits for this many subsets so that each one contains roughly
+    // the same number of points according to the bounds and point counts of
+    // the inferred files.  Files without bounds are ignored.
+    static std::vector<std::size_t> balance(
+            const Bounds& boundsNativeCubic,
+            std::size_t of,
+            const std::vector<FileInfo>& fileInfo);
+
     Json::Value toJson() const;
 
     std::size_t id() const { return m_id; }
     std::size_t of() const { return m_of; }
     const Bounds& bounds() const { return m_sub; }
+    const std::vector<std::size_t>& splits() const { return m_splits; }
+    const std::vector<Bounds>& boxes() const { return m_boxes; }
 
     std::string postfix() const { return "-" + std::to_string(m_id); }
     static std::string postfix(const std::size_t* subsetId)
@@ -100,6 +118,12 @@ public:
             const Bounds& bounds) const;
 
 private:
+    Subset(
+            const Bounds& boundsNativeCubic,
+            std::size_t id,
+            std::size_t of,
+            const std::vector<std::size_t>& splits);
+
     std::size_t m_id;
     std::size_t m_of;
 
@@ -107,6 +131,7 @@ private:
     std::size_t m_minimumNullDepth;
 
     std::vector<Bounds> m_boxes;
+    std::vector<std::size_t> m_splits;
 };
 
 } // namespace entwine
@@ -11,9 +11,18 @@
 #include <entwine/tree/climber.hpp>
 #include <entwine/types/tube.hpp>
 
+#include <stdexcept>
+#include <utility>
+
 namespace entwine
 {
 
+namespace
+{
+    std::atomic_size_t tubeBytes(0);
+    const std::size_t pageBytes(PagedTubes::pageSize() * sizeof(Tube));
+}
+
 Tube::Insertion Tube::insert(const Climber& climber, Cell::PooledNode& cell)
 {
     Insertion result;
@@ -37,7 +46,7 @@ Tube::Insertion Tube::insert(const Climber& climber, Cell::PooledNode& cell)
             {
                 // We are inserting cell, and extracting curr.  Store our new
                 // cell, and send the previous one further down the tree.
-                result.setDelta(
+                result.setSwapped(
                         static_cast<int>(cell->size()) -
                         static_cast<int>(curr->size()));
                 std::swap(cell, curr);
@@ -59,5 +68,101 @@ Tube::Insertion Tube::insert(const Climber& climber, Cell::PooledNode& cell)
     return result;
 }
 
-} // namespace entwine
+PagedTubes::PagedTubes(const std::size_t size)
+    : m_size(size)
+    , m_pages(new std::atomic<Tube*>[numPages()])
+{
+    for (std::size_t p(0); p < numPages(); ++p) m_pages[p] = nullptr;
+}
+
+PagedTubes::PagedTubes(PagedTubes&& other) noexcept
+    : m_size(other.m_size)
+    , m_pages(std::move(other.m_pages))
+{
+    other.m_size = 0;
+}
+
+PagedTubes& PagedTubes::operator=(PagedTubes&& other) noexcept
+{
+    clear();
+    std::swap(m_size, other.m_size);
+    std::swap(m_pages, other.m_pages);
+    return *this;
+}
+
+PagedTubes::~PagedTubes()
+{
+    clear();
+}
+
+Tube& PagedTubes::at(const std::size_t i)
+{
+    if (i >= m_size) throw std::out_of_range("Invalid tube index");
+
+    std::atomic<Tube*>& slot(m_pages[i / pageSize()]);
+    Tube* page(slot.load());
+
+    if (!page)
+    {
+        // If another thread beats us to this page, use theirs instead.
+        std::unique_ptr<Tube[]> created(new Tube[pageSize()]);
+        if (slot.compare_exchange_strong(page, created.get()))
+        {
+            page = created.release();
+            tubeBytes += pageBytes;
+        }
+    }
+
+    return page[i % pageSize()];
+}
+
+bool PagedTubes::empty() const
+{
+    bool empty(true);
+    forEach([&empty](std::size_t, const Tube& tube)
+    {
+        if (!tube.empty()) empty = false;
+    });
+    return empty;
+}
+
+void PagedTubes::append(PagedTubes& other)
+{
+    const std::size_t offset(m_size);
+    const std::size_t pages(numPages());
+
+    m_size += other.m_size;
+
+    std::unique_ptr<std::atomic<Tube*>[]> grown(
+            new std::atomic<Tube*>[numPages()]);
+    for (std::size_t p(0); p < numPages(); ++p)
+    {
+        grown[p] = p < pages ? m_pages[p].load() : nullptr;
+    }
+    m_pages = std::move(grown);
+
+    other.forEach([this, offset](std::size_t i, Tube& tube)
+    {
+        if (!tube.empty()) at(offset + i) = std::move(tube);
+    });
 
+    other.clear();
+}
+
+void PagedTubes::clear()
+{
+    for (std::size_t p(0); p < numPages(); ++p)
+    {
+        if (Tube* page = m_pages[p].exchange(nullptr))
+        {
+            delete [] page;
+            tubeBytes -= pageBytes;
+        }
+    }
+
+    m_size = 0;
+}
+
+std::size_t PagedTubes::bytes() { return tubeBytes; }
+
+} // namespace entwine
@@ -10,10 +10,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -34,21 +37,27 @@ public:
     class Insertion
     {
     public:
-        Insertion() : m_done(false), m_delta(0) { }
+        Insertion() : m_done(false), m_swapped(false), m_delta(0) { }
 
         Insertion(bool done, int delta)
             : m_done(done)
+            , m_swapped(false)
             , m_delta(delta)
         { }
 
         bool done() const { return m_done; }
         int delta() const { return m_delta; }
 
+        // True if the contents of the tube were modified by this insertion.
+        bool changed() const { return m_done || m_swapped; }
+
         void setDelta(int delta) { m_delta = delta; }
         void setDone(int delta) { m_done = true; m_delta = delta; }
+        void setSwapped(int delta) { m_swapped = true; m_delta = delta; }
 
     private:
         bool m_done;
+        bool m_swapped;
         int m_delta;
     };
 
@@ -102,5 +111,74 @@ private:
     SpinLock m_spinner;
 };
 
+// A fixed number of tubes, allocated in pages on first access.  Chunks near
+// the edges of the data may only ever touch a few of their tubes, so nothing
+// is allocated for the pages that are never reached.  Access via at() may be
+// concurrent, but resizing may not.
+class PagedTubes
+{
+public:
+    static constexpr std::size_t pageSize() { return 256; }
+
+    explicit PagedTubes(std::size_t size = 0);
+    PagedTubes(PagedTubes&& other) noexcept;
+    PagedTubes& operator=(PagedTubes&& other) noexcept;
+    ~PagedTubes();
+
+    std::size_t size() const { return m_size; }
+
+    // Allocates the page containing this tube if needed.
+    Tube& at(std::size_t i);
+
+    // True if no allocated tube contains any cells.
+    bool empty() const;
+
+    // Visit the allocated tubes, in order, along with their indices.
+    template<typename F> void forEach(F f)
+    {
+        for (std::size_t p(0); p < numPages(); ++p)
+        {
+            if (Tube* page = m_pages[p].load())
+            {
+                const std::size_t begin(p * pageSize());
+                const std::size_t n(std::min(pageSize(), m_size - begin));
+                for (std::size_t i(0); i < n; ++i) f(begin + i, page[i]);
+            }
+        }
+    }
+
+    template<typename F> void forEach(F f) const
+    {
+        for (std::size_t p(0); p < numPages(); ++p)
+        {
+            if (const Tube* page = m_pages[p].load())
+            {
+                const std::size_t begin(p * pageSize());
+                const std::size_t n(std::min(pageSize(), m_size - begin));
+                for (std::size_t i(0); i < n; ++i) f(begin + i, page[i]);
+            }
+        }
+    }
+
+    // Append the tubes of other to our own, leaving other empty.
+    void append(PagedTubes& other);
+    void clear();
+
+    // Bytes currently allocated for tubes across all instances.
+    static std::size_t bytes();
+
+private:
+    std::size_t numPages() const
+    {
+        return (m_size + pageSize() - 1) / pageSize();
+    }
+
+    std::size_t m_size;
+    std::unique_ptr<std::atomic<Tube*>[]> m_pages;
+
+    PagedTubes(const PagedTubes&) = delete;
+    PagedTubes& operator=(const PagedTubes&) = delete;
+};
+
 } // namespace entwine
 
@@ -17,11 +17,64 @@
 
 #include <entwine/types/binary-point-table.hpp>
 #include <entwine/types/schema.hpp>
+#include <entwine/util/metrics.hpp>
 #include <entwine/util/unique.hpp>
 
 namespace entwine
 {
 
+namespace
+{
+    // Estimated compressed size as a fraction of the uncompressed size.
+    const double compressionRatio(0.2);
+}
+
+Compressor::Compressor(
+        const Schema& schema,
+        const std::size_t numPoints,
+        const std::size_t extra)
+    : m_pointSize(schema.pointSize())
+    , m_timer(Metrics::Phase::Compress)
+    , m_data(makeUnique<std::vector<char>>())
+{
+    m_data->reserve(
+            static_cast<std::size_t>(
+                static_cast<double>(numPoints * m_pointSize) *
+                compressionRatio) + extra);
+
+    std::vector<char>& v(*m_data);
+    auto cb([&v](char* p, std::size_t s) { v.insert(v.end(), p, p + s); });
+
+    m_compressor = makeUnique<pdal::LazPerfCompressor>(
+            cb,
+            schema.pdalLayout().dimTypes());
+}
+
+Compressor::~Compressor() { }
+
+void Compressor::push(const char* point)
+{
+    m_compressor->compress(point, m_pointSize);
+    ++m_numPoints;
+}
+
+void Compressor::push(const char* data, const std::size_t size)
+{
+    m_compressor->compress(data, size);
+    m_numPoints += size / m_pointSize;
+}
+
+std::unique_ptr<std::vector<char>> Compressor::data()
+{
+    if (!m_compressor) throw std::runtime_error("Compression already done");
+
+    m_compressor->done();
+    m_compressor.reset();
+    m_timer.stop();
+
+    return std::move(m_data);
+}
+
 std::unique_ptr<std::vector<char>> Compression::compress(
         const std::vector<char>& d,
         const Schema& schema)
@@ -34,20 +87,9 @@ std::unique_ptr<std::vector<char>> Compression::compress(
         const std::size_t size,
         const Schema& schema)
 {
-    auto v(makeUnique<std::vector<char>>());
-    v->reserve(static_cast<std::size_t>(static_cast<double>(size) * 0.2));
-
-    const auto dimTypes(schema.pdalLayout().dimTypes());
-    auto cb([&v](char* p, std::size_t s)
-    {
-        v->insert(v->end(), p, p + s);
-    });
-
-    auto compressor(makeUnique<pdal::LazPerfCompressor>(cb, dimTypes));
-    compressor->compress(data, size);
-    compressor->done();
-
-    return v;
+    Compressor compressor(schema, size / schema.pointSize(), 0);
+    compressor.push(data, size);
+    return compressor.data();
 }
 
 std::unique_ptr<std::vector<char>> Compression::decompress(
@@ -115,6 +157,15 @@ Cell::PooledStack Compression::decompress(
         const std::vector<char>& data,
         const std::size_t numPoints,
         PointPool& pointPool)
+{
+    return decompress(data.data(), data.size(), numPoints, pointPool);
+}
+
+Cell::PooledStack Compression::decompress(
+        const char* data,
+        const std::size_t size,
+        const std::size_t numPoints,
+        PointPool& pointPool)
 {
     Data::PooledStack dataStack(pointPool.dataPool().acquire(numPoints));
     Cell::PooledStack cellStack(pointPool.cellPool().acquire(numPoints));
@@ -127,11 +178,11 @@ Cell::PooledStack Compression::decompress(
     const auto dimTypes(schema.pdalLayout().dimTypes());
 
     auto cb([&dataStack, &table, &pointRef, &current]
-            (const char* pos, std::size_t size)
+            (const char* pos, std::size_t pointSize)
     {
         Data::PooledNode dataNode(dataStack.popOne());
 
-        std::copy(pos, pos + size, *dataNode);
+        std::copy(pos, pos + pointSize, *dataNode);
         table.setPoint(*dataNode);
 
         (*current)->set(pointRef, std::move(dataNode));
@@ -140,7 +191,7 @@ Cell::PooledStack Compression::decompress(
 
     auto decompressor(
             makeUnique<pdal::LazPerfDecompressor>(cb, dimTypes, numPoints));
-    decompressor->decompress(data.data(), data.size());
+    decompressor->decompress(data, size);
     decompressor->done();
 
     assert(dataStack.empty());
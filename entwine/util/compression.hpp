@@ -18,12 +18,47 @@
 #include <vector>
 
 #include <entwine/types/structure.hpp>
+#include <entwine/util/metrics.hpp>
+
+namespace pdal
+{
+    class LazPerfCompressor;
+}
 
 namespace entwine
 {
 
 class Schema;
 
+// Compresses points one at a time as they are produced, so callers holding
+// points in pooled nodes needn't first gather them into a contiguous buffer.
+// Output is accumulated into a buffer reserved from an estimate of the
+// compressed size of the expected points, which grows if the estimate is short.
+class Compressor
+{
+public:
+    // The extra bytes are reserved beyond the estimated compressed data, for
+    // appending by the caller.
+    Compressor(const Schema& schema, std::size_t numPoints, std::size_t extra);
+    ~Compressor();
+
+    void push(const char* point);
+    void push(const char* data, std::size_t size);
+
+    // Completes the compression.  No more points may be pushed afterward.
+    std::unique_ptr<std::vector<char>> data();
+
+    std::size_t numPoints() const { return m_numPoints; }
+
+private:
+    const std::size_t m_pointSize;
+    std::size_t m_numPoints = 0;
+
+    Metrics::Timer m_timer;
+    std::unique_ptr<std::vector<char>> m_data;
+    std::unique_ptr<pdal::LazPerfCompressor> m_compressor;
+};
+
 class Compression
 {
 public:
@@ -53,6 +88,30 @@ public:
             std::size_t numPoints,
             PointPool& pointPool);
 
+    static Cell::PooledStack decompress(
+            const char* data,
+            std::size_t size,
+            std::size_t numPoints,
+            PointPool& pointPool);
+
+    // Zstandard compression of byte-shuffled points: byte k of every point is
+    // stored contiguously, followed by byte k + 1 of every point, and so on.
+    // Since dimensions are fixed-width and packed, each of these planes holds
+    // a single byte of a single dimension, so the slowly-varying high bytes of
+    // neighboring points compress well even with a fast entropy coder.
+    //
+    // Unavailable, and throws, if entwine was built without zstd.
+    static std::unique_ptr<std::vector<char>> compressZstd(
+            const std::vector<const char*>& points,
+            const Schema& schema,
+            int level);
+
+    static Cell::PooledStack decompressZstd(
+            const char* data,
+            std::size_t size,
+            std::size_t numPoints,
+            PointPool& pointPool);
+
     static std::unique_ptr<std::vector<char>> compressLzma(
             const std::vector<char>& data);
 
@@ -182,41 +182,55 @@ std::unique_ptr<Preview> Executor::preview(
     // been set, then we'll need to transform our bounds and SRS values.
     if (p.numPoints && reprojection)
     {
-        using DimId = pdal::Dimension::Id;
+        p.bounds = reproject(p.bounds, p.srs, *reprojection);
 
-        BufferState bufferState(p.bounds);
+        auto lock(getLock());
+        p.srs = pdal::SpatialReference(reprojection->out()).getWKT();
+    }
 
-        const auto selectedSrs(
-                srsFoundOrDefault(qi.m_srs, *reprojection));
+    return result;
+}
 
-        UniqueStage scopedFilter(createReprojectionFilter(selectedSrs));
-        if (!scopedFilter) return result;
+Bounds Executor::reproject(
+        const Bounds& bounds,
+        const std::string& srs,
+        const Reprojection& reprojection)
+{
+    using DimId = pdal::Dimension::Id;
 
-        pdal::Filter& filter(*scopedFilter->getAs<pdal::Filter*>());
+    BufferState bufferState(bounds);
 
-        filter.setInput(bufferState.getBuffer());
-        { auto lock(getLock()); filter.prepare(bufferState.getTable()); }
-        filter.execute(bufferState.getTable());
+    pdal::SpatialReference found;
+    { auto lock(getLock()); found = pdal::SpatialReference(srs); }
 
-        p.bounds = Bounds::expander();
-        for (std::size_t i(0); i < bufferState.getView().size(); ++i)
-        {
-            const Point point(
-                    bufferState.getView().getFieldAs<double>(DimId::X, i),
-                    bufferState.getView().getFieldAs<double>(DimId::Y, i),
-                    bufferState.getView().getFieldAs<double>(DimId::Z, i));
+    const auto selectedSrs(srsFoundOrDefault(found, reprojection));
 
-            p.bounds.grow(point);
-        }
+    UniqueStage scopedFilter(createReprojectionFilter(selectedSrs));
+    if (!scopedFilter)
+    {
+        throw std::runtime_error("Could not create reprojection filter");
+    }
 
-        auto lock(getLock());
-        p.srs = pdal::SpatialReference(reprojection->out()).getWKT();
+    pdal::Filter& filter(*scopedFilter->getAs<pdal::Filter*>());
+
+    filter.setInput(bufferState.getBuffer());
+    { auto lock(getLock()); filter.prepare(bufferState.getTable()); }
+    filter.execute(bufferState.getTable());
+
+    Bounds b(Bounds::expander());
+    for (std::size_t i(0); i < bufferState.getView().size(); ++i)
+    {
+        const Point point(
+                bufferState.getView().getFieldAs<double>(DimId::X, i),
+                bufferState.getView().getFieldAs<double>(DimId::Y, i),
+                bufferState.getView().getFieldAs<double>(DimId::Z, i));
+
+        b.grow(point);
     }
 
-    return result;
+    return b;
 }
 
-
 Bounds Executor::transform(
         const Bounds& bounds,
         const std::vector<double>& t) const
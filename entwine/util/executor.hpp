@@ -22,6 +22,7 @@
 #include <entwine/types/pooled-point-table.hpp>
 #include <entwine/types/reprojection.hpp>
 #include <entwine/types/structure.hpp>
+#include <entwine/util/json.hpp>
 #include <entwine/util/unique.hpp>
 
 namespace pdal
@@ -75,12 +76,39 @@ public:
         , metadata(metadata)
     { }
 
+    explicit Preview(const Json::Value& json)
+        : bounds(json.isMember("bounds") ? Bounds(json["bounds"]) : Bounds())
+        , numPoints(json["numPoints"].asUInt64())
+        , srs(json["srs"].asString())
+        , dimNames(extract<std::string>(json["dimNames"]))
+        , scale(json.isMember("scale") ?
+                makeUnique<Scale>(json["scale"]) : nullptr)
+        , metadata(json["metadata"])
+        , sampled(json["sampled"].asBool())
+    { }
+
+    Json::Value toJson() const
+    {
+        Json::Value json;
+        if (numPoints) json["bounds"] = bounds.toJson();
+        json["numPoints"] = static_cast<Json::UInt64>(numPoints);
+        if (srs.size()) json["srs"] = srs;
+        json["dimNames"] = toJsonArray(dimNames);
+        if (scale) json["scale"] = scale->toJson();
+        if (!metadata.isNull()) json["metadata"] = metadata;
+        if (sampled) json["sampled"] = true;
+        return json;
+    }
+
     Bounds bounds;
     std::size_t numPoints = 0;
     std::string srs;
     std::vector<std::string> dimNames;
     std::unique_ptr<Scale> scale;
     Json::Value metadata;
+
+    // True if the bounds were estimated from a subset of the points.
+    bool sampled = false;
 };
 
 class Executor
@@ -115,6 +143,13 @@ public:
             std::string path,
             const Reprojection* reprojection = nullptr);
 
+    // Reproject bounds from the SRS found in a file header, which may be
+    // empty, to the output SRS of the given reprojection.
+    Bounds reproject(
+            const Bounds& bounds,
+            const std::string& srs,
+            const Reprojection& reprojection);
+
     std::string getSrsString(std::string input) const;
 
     Bounds transform(
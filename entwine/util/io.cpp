@@ -17,6 +17,7 @@
 
 #include <entwine/third/arbiter/arbiter.hpp>
 #include <entwine/tree/chunk.hpp>
+#include <entwine/util/metrics.hpp>
 
 namespace
 {
@@ -55,6 +56,8 @@ void ensurePut(
         const std::string& path,
         const std::vector<char>& data)
 {
+    Metrics::Timer timer(Metrics::Phase::Put);
+
     bool done(false);
     std::size_t tried(0);
 
@@ -67,6 +70,8 @@ void ensurePut(
         }
         catch (...)
         {
+            Metrics::count(Metrics::Counter::PutRetries);
+
             if (++tried < retries)
             {
                 sleep(tried, "PUT", endpoint.prefixedRoot() + path);
@@ -95,6 +100,8 @@ std::unique_ptr<std::vector<char>> ensureGet(
         }
         else
         {
+            Metrics::count(Metrics::Counter::GetRetries);
+
             if (++tried < retries)
             {
                 sleep(tried, "GET", endpoint.prefixedRoot() + path);
@@ -0,0 +1,286 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/util/las.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/util/executor.hpp>
+#include <entwine/util/unique.hpp>
+
+namespace entwine
+{
+namespace las
+{
+
+namespace
+{
+    const std::size_t publicHeaderSize(227);
+    const std::size_t vlrHeaderSize(54);
+    const std::size_t extraBytesSize(192);
+
+    const uint16_t wktRecordId(2112);
+    const uint16_t geotiffKeysRecordId(34735);
+    const uint16_t geotiffDoublesRecordId(34736);
+    const uint16_t geotiffAsciiRecordId(34737);
+    const uint16_t extraBytesRecordId(4);
+
+    const uint16_t internalWaveformBit(0x02);
+    const uint16_t wktEncodingBit(0x10);
+
+    template<typename T>
+    T get(const std::vector<char>& data, std::size_t pos)
+    {
+        if (pos + sizeof(T) > data.size())
+        {
+            throw std::runtime_error("Invalid LAS header read");
+        }
+
+        T v;
+        std::memcpy(&v, data.data() + pos, sizeof(T));
+        return v;
+    }
+
+    std::string getString(
+            const std::vector<char>& data,
+            std::size_t pos,
+            std::size_t size)
+    {
+        const char* begin(data.data() + pos);
+        return std::string(begin, std::find(begin, begin + size, 0));
+    }
+}
+
+bool good(const std::string& path)
+{
+    std::string ext(arbiter::Arbiter::getExtension(path));
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == "las" || ext == "laz";
+}
+
+Header::Header(const std::vector<char>& data)
+{
+    if (data.size() < publicHeaderSize || getString(data, 0, 4) != "LASF")
+    {
+        throw std::runtime_error("Data does not contain a LAS header");
+    }
+
+    const uint16_t encoding(get<uint16_t>(data, 6));
+    const uint8_t major(get<uint8_t>(data, 24));
+    const uint8_t minor(get<uint8_t>(data, 25));
+    const uint16_t headerSize(get<uint16_t>(data, 94));
+    const uint8_t rawFormat(get<uint8_t>(data, 104));
+
+    m_pointOffset = get<uint32_t>(data, 96);
+    m_pointFormat = rawFormat & 0x3f;
+    m_pointSize = get<uint16_t>(data, 105);
+    m_compressed = (rawFormat & 0x80) != 0;
+    m_numPoints = get<uint32_t>(data, 107);
+
+    // Anything following the point records bounds their extent.
+    if (minor >= 3 && headerSize >= 235 && (encoding & internalWaveformBit))
+    {
+        m_dataEnd = get<uint64_t>(data, 227);
+    }
+
+    if (minor >= 4 && headerSize >= 255 && data.size() >= 255)
+    {
+        if (const uint64_t n = get<uint64_t>(data, 247)) m_numPoints = n;
+
+        const uint64_t evlrs(get<uint64_t>(data, 235));
+        if (evlrs && (!m_dataEnd || evlrs < m_dataEnd)) m_dataEnd = evlrs;
+    }
+
+    m_scale = Scale(
+            get<double>(data, 131),
+            get<double>(data, 139),
+            get<double>(data, 147));
+
+    m_offset = Offset(
+            get<double>(data, 155),
+            get<double>(data, 163),
+            get<double>(data, 171));
+
+    // Stored as max/min pairs per dimension.
+    m_bounds = Bounds(
+            get<double>(data, 187), get<double>(data, 203),
+            get<double>(data, 219), get<double>(data, 179),
+            get<double>(data, 195), get<double>(data, 211));
+
+    // Mirror the naming of the PDAL LAS reader metadata for the values we
+    // have on hand.
+    Json::Value& m(m_metadata);
+    m["compressed"] = m_compressed;
+    m["major_version"] = major;
+    m["minor_version"] = minor;
+    m["dataformat_id"] = m_pointFormat;
+    m["filesource_id"] = get<uint16_t>(data, 4);
+    m["global_encoding"] = encoding;
+    m["system_id"] = getString(data, 26, 32);
+    m["software_id"] = getString(data, 58, 32);
+    m["creation_doy"] = get<uint16_t>(data, 90);
+    m["creation_year"] = get<uint16_t>(data, 92);
+    m["header_size"] = headerSize;
+    m["dataoffset"] = m_pointOffset;
+    m["point_length"] = m_pointSize;
+    m["count"] = static_cast<Json::UInt64>(m_numPoints);
+    m["scale_x"] = m_scale.x;
+    m["scale_y"] = m_scale.y;
+    m["scale_z"] = m_scale.z;
+    m["offset_x"] = m_offset.x;
+    m["offset_y"] = m_offset.y;
+    m["offset_z"] = m_offset.z;
+    m["minx"] = m_bounds.min().x;
+    m["miny"] = m_bounds.min().y;
+    m["minz"] = m_bounds.min().z;
+    m["maxx"] = m_bounds.max().x;
+    m["maxy"] = m_bounds.max().y;
+    m["maxz"] = m_bounds.max().z;
+
+    if (m_pointFormat > 10) m_supported = false;
+
+    parseVlrs(data, headerSize, get<uint32_t>(data, 100));
+
+    // A WKT SRS may live in an extended VLR at the end of the file, which we
+    // don't have.
+    if ((encoding & wktEncodingBit) && m_wkt.empty()) m_supported = false;
+}
+
+void Header::parseVlrs(
+        const std::vector<char>& data,
+        const std::size_t headerSize,
+        const std::size_t numVlrs)
+{
+    std::size_t pos(headerSize);
+
+    for (std::size_t i(0); i < numVlrs; ++i)
+    {
+        if (pos + vlrHeaderSize > data.size()) return;
+
+        const std::string user(getString(data, pos + 2, 16));
+        const uint16_t recordId(get<uint16_t>(data, pos + 18));
+        const uint16_t length(get<uint16_t>(data, pos + 20));
+
+        pos += vlrHeaderSize;
+        if (pos + length > data.size()) return;
+
+        if (user == "LASF_Projection")
+        {
+            if (recordId == wktRecordId)
+            {
+                m_wkt = getString(data, pos, length);
+            }
+            else if (
+                    recordId == geotiffKeysRecordId ||
+                    recordId == geotiffDoublesRecordId ||
+                    recordId == geotiffAsciiRecordId)
+            {
+                m_geotiff += std::to_string(recordId) + ':';
+                m_geotiff.append(data.data() + pos, length);
+            }
+        }
+        else if (user == "LASF_Spec" && recordId == extraBytesRecordId)
+        {
+            for (std::size_t e(0); e + extraBytesSize <= length;
+                    e += extraBytesSize)
+            {
+                // Undocumented extra bytes and the deprecated multi-valued
+                // types are left to PDAL.
+                const uint8_t type(get<uint8_t>(data, pos + e + 2));
+                if (type == 0 || type > 10) m_supported = false;
+
+                m_extraDims.push_back(getString(data, pos + e + 4, 32));
+            }
+        }
+
+        pos += length;
+    }
+
+    m_complete = true;
+}
+
+std::vector<std::string> Header::dimNames() const
+{
+    std::vector<std::string> dims {
+        "X", "Y", "Z", "Intensity", "ReturnNumber", "NumberOfReturns",
+        "ScanDirectionFlag", "EdgeOfFlightLine", "Classification",
+        "ScanAngleRank", "UserData", "PointSourceId"
+    };
+
+    const uint8_t f(m_pointFormat);
+
+    if (f == 1 || f >= 3) dims.push_back("GpsTime");
+
+    if (f == 2 || f == 3 || f == 5 || f == 7 || f == 8 || f == 10)
+    {
+        dims.push_back("Red");
+        dims.push_back("Green");
+        dims.push_back("Blue");
+    }
+
+    if (f == 8 || f == 10) dims.push_back("Infrared");
+
+    if (f >= 6)
+    {
+        dims.push_back("ScanChannel");
+        dims.push_back("ClassFlags");
+    }
+
+    dims.insert(dims.end(), m_extraDims.begin(), m_extraDims.end());
+    return dims;
+}
+
+uint64_t Header::numRecords(const uint64_t fileSize) const
+{
+    if (m_compressed || m_pointSize < 12) return 0;
+
+    const uint64_t end(m_dataEnd ? std::min(m_dataEnd, fileSize) : fileSize);
+    if (end <= m_pointOffset) return 0;
+
+    return (end - m_pointOffset) / m_pointSize;
+}
+
+void Header::grow(
+        Bounds& bounds,
+        const std::vector<char>& records,
+        const Transformation* transformation) const
+{
+    for (std::size_t pos(0); pos + m_pointSize <= records.size();
+            pos += m_pointSize)
+    {
+        const Point p(
+                get<int32_t>(records, pos) * m_scale.x + m_offset.x,
+                get<int32_t>(records, pos + 4) * m_scale.y + m_offset.y,
+                get<int32_t>(records, pos + 8) * m_scale.z + m_offset.z);
+
+        if (transformation) bounds.grow(Point::transform(p, *transformation));
+        else bounds.grow(p);
+    }
+}
+
+std::unique_ptr<Preview> Header::preview() const
+{
+    if (!m_complete || !m_supported) return nullptr;
+
+    return makeUnique<Preview>(
+            m_numPoints ? m_bounds : Bounds(),
+            m_numPoints,
+            m_wkt,
+            dimNames(),
+            &m_scale,
+            m_metadata);
+}
+
+} // namespace las
+} // namespace entwine
+
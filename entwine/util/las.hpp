@@ -0,0 +1,112 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include <entwine/types/bounds.hpp>
+#include <entwine/types/defs.hpp>
+
+namespace entwine
+{
+
+class Preview;
+
+namespace las
+{
+
+// Enough to cover the public header block and the VLRs of the vast majority
+// of LAS/LAZ files.  If the VLRs extend past this, the header reports exactly
+// how many bytes are needed.
+const std::size_t initialHeaderBytes(16384);
+
+// True if this path looks like a LAS or LAZ file by its extension.
+bool good(const std::string& path);
+
+// A minimal parser for the LAS public header block and its VLRs, which lets
+// us preview a file from the leading bytes of a range read rather than from a
+// complete local copy of the file.  This does not go through PDAL, so many
+// headers may be parsed concurrently.
+class Header
+{
+public:
+    // Throws if the data does not contain a LAS public header block.
+    explicit Header(const std::vector<char>& data);
+
+    // Number of leading bytes of the file required to parse the header and
+    // all of its VLRs.
+    std::size_t size() const { return m_pointOffset; }
+
+    // Returns null if the supplied data did not cover the full header, or if
+    // the header contains anything we can't natively interpret - in either
+    // case, the caller should fall back to a PDAL preview.  The SRS of the
+    // resulting preview is only populated for WKT-based headers.
+    std::unique_ptr<Preview> preview() const;
+
+    // Number of point records, derived from the size of the file rather than
+    // from the header.  Returns zero if the records can't be addressed
+    // directly, as is the case for compressed data.
+    uint64_t numRecords(uint64_t fileSize) const;
+
+    // Byte offset of the record at this index.
+    uint64_t recordOffset(uint64_t index) const
+    {
+        return m_pointOffset + index * m_pointSize;
+    }
+
+    std::size_t pointSize() const { return m_pointSize; }
+
+    // Grow the bounds by the positions of a buffer of raw point records,
+    // transformed if a transformation is given.
+    void grow(
+            Bounds& bounds,
+            const std::vector<char>& records,
+            const Transformation* transformation = nullptr) const;
+
+    // Raw contents of the GeoTIFF key VLRs, if any.  Files with identical keys
+    // share an SRS, so this may be used to look up a previously resolved WKT.
+    const std::string& geotiff() const { return m_geotiff; }
+
+private:
+    void parseVlrs(
+            const std::vector<char>& data,
+            std::size_t headerSize,
+            std::size_t numVlrs);
+
+    std::vector<std::string> dimNames() const;
+
+    uint32_t m_pointOffset = 0;
+    uint8_t m_pointFormat = 0;
+    uint16_t m_pointSize = 0;
+    bool m_compressed = false;
+    uint64_t m_dataEnd = 0;
+    uint64_t m_numPoints = 0;
+    Bounds m_bounds;
+    Scale m_scale;
+    Offset m_offset;
+    Json::Value m_metadata;
+
+    std::string m_wkt;
+    std::string m_geotiff;
+    std::vector<std::string> m_extraDims;
+    bool m_complete = false;
+    bool m_supported = true;
+};
+
+} // namespace las
+} // namespace entwine
+
@@ -0,0 +1,89 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/util/mapped-file.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace entwine
+{
+
+#ifndef _WIN32
+
+std::unique_ptr<MappedFile> MappedFile::create(
+        const std::string& path,
+        const std::size_t size)
+{
+    const int flags(size ? O_RDWR | O_CREAT : O_RDWR);
+    const int fd(::open(path.c_str(), flags, 0644));
+    if (fd < 0) return nullptr;
+
+    struct stat info;
+    std::size_t actual(0);
+
+    if (::fstat(fd, &info) == 0)
+    {
+        actual = info.st_size;
+
+        // A newly created file is empty, so give it the requested size.
+        if (!actual && size && ::ftruncate(fd, size) == 0) actual = size;
+    }
+
+    void* data(nullptr);
+
+    if (actual)
+    {
+        data = ::mmap(
+                nullptr,
+                actual,
+                PROT_READ | PROT_WRITE,
+                MAP_SHARED,
+                fd,
+                0);
+    }
+
+    // The mapping remains valid after the descriptor is closed.
+    ::close(fd);
+
+    if (!data || data == MAP_FAILED) return nullptr;
+
+    return std::unique_ptr<MappedFile>(
+            new MappedFile(static_cast<char*>(data), actual));
+}
+
+MappedFile::~MappedFile()
+{
+    ::munmap(m_data, m_size);
+}
+
+void MappedFile::sync()
+{
+    ::msync(m_data, m_size, MS_SYNC);
+}
+
+#else
+
+std::unique_ptr<MappedFile> MappedFile::create(const std::string&, std::size_t)
+{
+    return nullptr;
+}
+
+MappedFile::~MappedFile() { }
+void MappedFile::sync() { }
+
+#endif
+
+} // namespace entwine
+
@@ -0,0 +1,53 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace entwine
+{
+
+// A local file mapped into memory.  The mapping is shared with the file, so
+// modifications to the data are written through to it.
+class MappedFile
+{
+public:
+    // Returns null if the file can't be mapped, or if memory mapping isn't
+    // supported on this platform.  If size is non-zero, the file is created
+    // with this size if it doesn't exist, and otherwise it must already exist
+    // and be non-empty.
+    static std::unique_ptr<MappedFile> create(
+            const std::string& path,
+            std::size_t size = 0);
+
+    ~MappedFile();
+
+    char* data() { return m_data; }
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+    // Block until all modifications have been written to the file.
+    void sync();
+
+private:
+    MappedFile(char* data, std::size_t size) : m_data(data), m_size(size) { }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    char* const m_data;
+    const std::size_t m_size;
+};
+
+} // namespace entwine
+
@@ -0,0 +1,99 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/util/metrics.hpp>
+
+#include <array>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+
+namespace entwine
+{
+
+namespace
+{
+    const std::size_t numPhases(static_cast<std::size_t>(Metrics::Phase::End));
+    const std::size_t numCounters(
+            static_cast<std::size_t>(Metrics::Counter::End));
+
+    std::array<std::atomic<uint64_t>, numPhases> phaseNs {};
+    std::array<std::atomic<uint64_t>, numPhases> phaseCounts {};
+    std::array<std::atomic<uint64_t>, numCounters> counters {};
+
+    template<typename T>
+    std::size_t index(T t) { return static_cast<std::size_t>(t); }
+}
+
+std::string Metrics::name(const Phase phase)
+{
+    switch (phase)
+    {
+        case Phase::Fetch:      return "fetch";
+        case Phase::Read:       return "read";
+        case Phase::Insert:     return "insert";
+        case Phase::Clip:       return "clip";
+        case Phase::Serialize:  return "serialize";
+        case Phase::Compress:   return "compress";
+        case Phase::Put:        return "put";
+        default:                break;
+    }
+
+    throw std::runtime_error("Invalid phase");
+}
+
+std::string Metrics::name(const Counter counter)
+{
+    switch (counter)
+    {
+        case Counter::ChunksCreated:    return "chunksCreated";
+        case Counter::ChunksSaved:      return "chunksSaved";
+        case Counter::FetchRetries:     return "fetchRetries";
+        case Counter::PutRetries:       return "putRetries";
+        case Counter::GetRetries:       return "getRetries";
+        default:                        break;
+    }
+
+    throw std::runtime_error("Invalid counter");
+}
+
+void Metrics::add(const Phase phase, const std::chrono::nanoseconds elapsed)
+{
+    phaseNs[index(phase)] += elapsed.count();
+    ++phaseCounts[index(phase)];
+}
+
+void Metrics::count(const Counter counter, const uint64_t n)
+{
+    counters[index(counter)] += n;
+}
+
+Json::Value Metrics::toJson()
+{
+    Json::Value json;
+
+    for (std::size_t i(0); i < numPhases; ++i)
+    {
+        Json::Value& phase(json["phases"][name(static_cast<Phase>(i))]);
+        phase["seconds"] = phaseNs[i] / 1000000000.0;
+        phase["count"] = Json::UInt64(phaseCounts[i]);
+    }
+
+    for (std::size_t i(0); i < numCounters; ++i)
+    {
+        json["counters"][name(static_cast<Counter>(i))] =
+            Json::UInt64(counters[i]);
+    }
+
+    return json;
+}
+
+} // namespace entwine
+
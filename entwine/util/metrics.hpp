@@ -0,0 +1,91 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <json/json.h>
+
+namespace entwine
+{
+
+// Process-wide build telemetry.  Phase times are summed over all threads, so
+// a phase may account for more time than has elapsed.  Phases nest: reading
+// an input drives the insertion of its points, which clips chunks, and
+// serializing a chunk includes its compression and upload.
+class Metrics
+{
+public:
+    enum class Phase
+    {
+        Fetch,      // Fetch an input file to local storage.
+        Read,       // Read an input file, including insertion of its points.
+        Insert,     // Insert points into the tree.
+        Clip,       // Release stale chunks from an insertion thread.
+        Serialize,  // Serialize a chunk.
+        Compress,   // Compress point data.
+        Put,        // Write a file to the output or tmp, including retries.
+        End
+    };
+
+    enum class Counter
+    {
+        ChunksCreated,
+        ChunksSaved,
+        FetchRetries,
+        PutRetries,
+        GetRetries,
+        End
+    };
+
+    static std::string name(Phase phase);
+    static std::string name(Counter counter);
+
+    static void add(Phase phase, std::chrono::nanoseconds elapsed);
+    static void count(Counter counter, uint64_t n = 1);
+
+    // Times a phase for the lifetime of this object, or until stop().
+    class Timer
+    {
+    public:
+        explicit Timer(Phase phase)
+            : m_phase(phase)
+            , m_start(std::chrono::steady_clock::now())
+        { }
+
+        ~Timer() { stop(); }
+
+        void stop()
+        {
+            if (m_stopped) return;
+            m_stopped = true;
+            add(m_phase, std::chrono::steady_clock::now() - m_start);
+        }
+
+    private:
+        const Phase m_phase;
+        const std::chrono::steady_clock::time_point m_start;
+        bool m_stopped = false;
+    };
+
+    // Cumulative totals:
+    //      { "phases": { "<phase>": { "seconds": s, "count": n }, ... },
+    //        "counters": { "<counter>": n, ... } }
+    static Json::Value toJson();
+
+    Metrics() = delete;
+};
+
+} // namespace entwine
+
@@ -10,6 +10,7 @@
 
 #include <entwine/util/pool.hpp>
 
+#include <chrono>
 #include <iostream>
 #include <string>
 
@@ -33,10 +34,11 @@ void Pool::go()
     std::lock_guard<std::mutex> lock(m_mutex);
     if (m_running) return;
     m_running = true;
+    m_busy.assign(m_numThreads, 0);
 
     for (std::size_t i(0); i < m_numThreads; ++i)
     {
-        m_threads.emplace_back([this]() { work(); });
+        m_threads.emplace_back([this, i]() { work(i); });
     }
 }
 
@@ -78,7 +80,25 @@ void Pool::add(std::function<void()> task)
     m_consumeCv.notify_all();
 }
 
-void Pool::work()
+std::size_t Pool::queued() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tasks.size();
+}
+
+std::size_t Pool::active() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_outstanding;
+}
+
+std::vector<double> Pool::busy() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_busy;
+}
+
+void Pool::work(const std::size_t index)
 {
     while (true)
     {
@@ -99,13 +119,19 @@ void Pool::work()
             // Notify add(), which may be waiting for a spot in the queue.
             m_produceCv.notify_all();
 
+            const auto start(std::chrono::steady_clock::now());
+
             std::string err;
             try { task(); }
             catch (std::exception& e) { err = e.what(); }
             catch (...) { err = "Unknown error"; }
 
+            const std::chrono::duration<double> elapsed(
+                    std::chrono::steady_clock::now() - start);
+
             lock.lock();
             --m_outstanding;
+            m_busy[index] += elapsed.count();
             if (err.size())
             {
                 std::cout << "Exception in pool task: " << err << std::endl;
@@ -58,10 +58,18 @@ public:
     std::size_t size() const { return m_numThreads; }
     std::size_t numThreads() const { return m_numThreads; }
 
+    // Tasks waiting for a thread, and tasks currently running.
+    std::size_t queued() const;
+    std::size_t active() const;
+
+    // Total time, in seconds, that each thread has spent running tasks since
+    // the last call to go().
+    std::vector<double> busy() const;
+
 private:
     // Worker thread function.  Wait for a task and run it - or if stop() is
     // called, complete any outstanding task and return.
-    void work();
+    void work(std::size_t index);
 
     std::size_t m_numThreads;
     std::size_t m_queueSize;
@@ -74,6 +82,8 @@ private:
     std::size_t m_outstanding = 0;
     bool m_running = false;
 
+    std::vector<double> m_busy;
+
     mutable std::mutex m_mutex;
     std::condition_variable m_produceCv;
     std::condition_variable m_consumeCv;
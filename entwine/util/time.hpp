@@ -8,6 +8,8 @@
 *
 ******************************************************************************/
 
+#pragma once
+
 #include <chrono>
 #include <fstream>
 #include <iostream>
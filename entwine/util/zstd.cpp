@@ -0,0 +1,166 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include <entwine/util/compression.hpp>
+
+#include <string>
+
+#ifdef ENTWINE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <entwine/types/binary-point-table.hpp>
+#include <entwine/types/schema.hpp>
+#include <entwine/util/metrics.hpp>
+#include <entwine/util/unique.hpp>
+
+namespace entwine
+{
+
+#ifdef ENTWINE_ZSTD
+
+namespace
+{
+
+// Points are shuffled in blocks, so that each plane is read or written in
+// runs rather than one byte per point.
+const std::size_t blockPoints(256);
+
+void check(const std::size_t code)
+{
+    if (ZSTD_isError(code))
+    {
+        throw std::runtime_error(
+                std::string("Zstandard error: ") + ZSTD_getErrorName(code));
+    }
+}
+
+} // unnamed namespace
+
+std::unique_ptr<std::vector<char>> Compression::compressZstd(
+        const std::vector<const char*>& points,
+        const Schema& schema,
+        const int level)
+{
+    Metrics::Timer timer(Metrics::Phase::Compress);
+
+    const std::size_t numPoints(points.size());
+    const std::size_t pointSize(schema.pointSize());
+
+    std::vector<char> shuffled(numPoints * pointSize);
+
+    for (std::size_t begin(0); begin < numPoints; begin += blockPoints)
+    {
+        const std::size_t end(std::min(begin + blockPoints, numPoints));
+
+        for (std::size_t k(0); k < pointSize; ++k)
+        {
+            char* plane(shuffled.data() + k * numPoints);
+            for (std::size_t i(begin); i < end; ++i) plane[i] = points[i][k];
+        }
+    }
+
+    const std::size_t bound(ZSTD_compressBound(shuffled.size()));
+    auto out(makeUnique<std::vector<char>>(bound));
+
+    const std::size_t size(
+            ZSTD_compress(
+                out->data(),
+                out->size(),
+                shuffled.data(),
+                shuffled.size(),
+                level));
+
+    check(size);
+    out->resize(size);
+
+    return out;
+}
+
+Cell::PooledStack Compression::decompressZstd(
+        const char* data,
+        const std::size_t size,
+        const std::size_t numPoints,
+        PointPool& pointPool)
+{
+    const Schema& schema(pointPool.schema());
+    const std::size_t pointSize(schema.pointSize());
+
+    std::vector<char> shuffled(numPoints * pointSize);
+
+    const std::size_t result(
+            ZSTD_decompress(shuffled.data(), shuffled.size(), data, size));
+
+    check(result);
+
+    if (result != shuffled.size())
+    {
+        throw std::runtime_error("Invalid zstd chunk size");
+    }
+
+    Data::PooledStack dataStack(pointPool.dataPool().acquire(numPoints));
+    Cell::PooledStack cellStack(pointPool.cellPool().acquire(numPoints));
+
+    std::vector<Data::PooledNode> nodes;
+    nodes.reserve(numPoints);
+    for (std::size_t i(0); i < numPoints; ++i)
+    {
+        nodes.push_back(dataStack.popOne());
+    }
+
+    for (std::size_t begin(0); begin < numPoints; begin += blockPoints)
+    {
+        const std::size_t end(std::min(begin + blockPoints, numPoints));
+
+        for (std::size_t k(0); k < pointSize; ++k)
+        {
+            const char* plane(shuffled.data() + k * numPoints);
+            for (std::size_t i(begin); i < end; ++i) (*nodes[i])[k] = plane[i];
+        }
+    }
+
+    BinaryPointTable table(schema);
+    pdal::PointRef pointRef(table, 0);
+
+    Cell::RawNode* current(cellStack.head());
+
+    for (Data::PooledNode& node : nodes)
+    {
+        table.setPoint(*node);
+        (*current)->set(pointRef, std::move(node));
+        current = current->next();
+    }
+
+    return cellStack;
+}
+
+#else
+
+std::unique_ptr<std::vector<char>> Compression::compressZstd(
+        const std::vector<const char*>&,
+        const Schema&,
+        int)
+{
+    throw std::runtime_error("Entwine was built without zstd");
+}
+
+Cell::PooledStack Compression::decompressZstd(
+        const char*,
+        std::size_t,
+        std::size_t,
+        PointPool&)
+{
+    throw std::runtime_error("Entwine was built without zstd");
+}
+
+#endif
+
+} // namespace entwine
+
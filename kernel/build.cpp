@@ -20,6 +20,7 @@
 #include <entwine/tree/builder.hpp>
 #include <entwine/tree/chunk.hpp>
 #include <entwine/tree/config-parser.hpp>
+#include <entwine/tree/coordinator.hpp>
 #include <entwine/tree/thread-pools.hpp>
 #include <entwine/types/bounds.hpp>
 #include <entwine/types/metadata.hpp>
@@ -62,6 +63,15 @@ namespace
             "\t-a <tmp path>\n"
             "\t\tDirectory for entwine-generated temporary files.\n\n"
 
+            "\t-k <cache path>\n"
+            "\t\tDirectory for a persistent cache of per-file inference\n"
+            "\t\tresults, which may be shared between builds of the same\n"
+            "\t\tinput data.\n\n"
+
+            "\t-l <metrics path>\n"
+            "\t\tLocal file to which build telemetry is appended as one\n"
+            "\t\tJSON object per line, every 10 seconds.\n\n"
+
             "\t-b [xmin, ymin, zmin, xmax, ymax, zmax]\n"
             "\t\tSet the boundings for the index.  Points outside of the\n"
             "\t\tgiven coordinates will be discarded.\n\n"
@@ -96,13 +106,16 @@ namespace
             "\t-e\n"
             "\t\tEnable AWS server-side-encryption.\n\n"
 
-            "\t-x\n"
+            "\t-x (<sample fraction>)\n"
             "\t\tDo not trust file headers when determining bounds.  By\n"
-            "\t\tdefault, the headers are considered to be good.\n\n"
+            "\t\tdefault, the headers are considered to be good.  If a\n"
+            "\t\tfraction in (0, 1] is given, bounds are estimated from\n"
+            "\t\tthat fraction of the points of uncompressed LAS files\n"
+            "\t\trather than from all of them.\n\n"
 
             "\t-c <storage compression-type>\n"
             "\t\tSet data storage type.  Valid value: 'binary', 'laszip',\n"
-            "\t\tor 'lazperf'.\n\n"
+            "\t\t'lazperf', 'lazperf-segmented', or 'zstd'.\n\n"
 
             "\t-n\n"
             "\t\tIf set, absolute positioning will be used, even if values\n"
@@ -119,7 +132,17 @@ namespace
             "\t\tsubset-number - One-based subset ID in range\n"
             "\t\t[1, subset-total].\n\n"
             "\t\tsubset-total - Total number of subsets that will be built.\n"
-            "\t\tMust be a binary power.\n\n"
+            "\t\tMust be a binary power, unless --balance is set.\n\n"
+
+            "\t--balance\n"
+            "\t\tSplit subsets so that each contains roughly the same number\n"
+            "\t\tof points, according to the inferred file bounds, rather\n"
+            "\t\tthan splitting the bounds uniformly.  All subsets of a build\n"
+            "\t\tmust use the same setting.\n\n"
+
+            "\t-w, --workers <count>\n"
+            "\t\tBuild in subsets using this many local worker processes,\n"
+            "\t\tthen merge them.  Cannot be combined with -s <id> <of>.\n\n"
 
             "\t-m <JSON-array>\n"
             "\t\tTransformation matrix.\n\n"
@@ -205,6 +228,7 @@ void Kernel::build(std::vector<std::string> args)
     entwine::arbiter::Arbiter localArbiter;
 
     std::size_t a(0);
+    std::size_t workers(0);
 
     if (args[0].front() != '-')
     {
@@ -270,6 +294,16 @@ void Kernel::build(std::vector<std::string> args)
             if (++a < args.size()) json["tmp"] = args[a];
             else error("Invalid tmp specification");
         }
+        else if (arg == "-k")
+        {
+            if (++a < args.size()) json["cache"] = args[a];
+            else error("Invalid cache specification");
+        }
+        else if (arg == "-l")
+        {
+            if (++a < args.size()) json["metrics"] = args[a];
+            else error("Invalid metrics specification");
+        }
         else if (arg == "-b")
         {
             std::string str;
@@ -285,7 +319,15 @@ void Kernel::build(std::vector<std::string> args)
             else error("Invalid bounds: " + str);
         }
         else if (arg == "-f") { json["force"] = true; }
-        else if (arg == "-x") { json["trustHeaders"] = false; }
+        else if (arg == "-x")
+        {
+            json["trustHeaders"] = false;
+
+            if (a + 1 < args.size() && args[a + 1].front() != '-')
+            {
+                json["sample"] = std::stod(args[++a]);
+            }
+        }
         else if (arg == "-n") { json["absolute"] = true; }
         else if (arg == "-e") { json["arbiter"]["s3"]["sse"] = true; }
         else if (arg == "-h")
@@ -401,6 +443,15 @@ void Kernel::build(std::vector<std::string> args)
             }
             else error("Invalid density specification");
         }
+        else if (arg == "--balance")
+        {
+            json["subset"]["balance"] = true;
+        }
+        else if (arg == "-w" || arg == "--workers")
+        {
+            if (++a < args.size()) workers = std::stoul(args[a]);
+            else error("Invalid worker count specification");
+        }
         else if (arg == "-p")
         {
             if (++a < args.size())
@@ -417,9 +468,22 @@ void Kernel::build(std::vector<std::string> args)
         ++a;
     }
 
-    auto arbiter(std::make_shared<entwine::arbiter::Arbiter>(json["arbiter"]));
-
     json["verbose"] = true;
+
+    if (workers)
+    {
+        // The coordinator forks, so it must start before we have any threads.
+        Coordinator coordinator(json, workers);
+        coordinator.go();
+        return;
+    }
+
+    if (json.isMember("subset") && !json["subset"].isMember("id"))
+    {
+        error("--balance requires a subset specification or workers");
+    }
+
+    auto arbiter(std::make_shared<entwine::arbiter::Arbiter>(json["arbiter"]));
     std::unique_ptr<Builder> builder(ConfigParser::getBuilder(json, arbiter));
 
     if (builder->isContinuation())
@@ -495,6 +559,12 @@ void Kernel::build(std::vector<std::string> args)
     if (!metadata.trustHeaders())
     {
         std::cout << "\tTrust file headers? " << yesNo(false) << "\n";
+
+        if (json.isMember("sample"))
+        {
+            std::cout << "\tSampled fraction: " <<
+                json["sample"].asDouble() << "\n";
+        }
     }
 
     std::cout <<
@@ -587,7 +657,20 @@ void Kernel::build(std::vector<std::string> args)
         "\t\tOutside specified bounds: " <<
             commify(stats.outOfBounds()) << "\n" <<
         "\t\tOverflow past max depth: " <<
-            commify(stats.overflows()) << "\n" <<
-        std::endl;
+            commify(stats.overflows()) << "\n";
+
+    const StorageStats io(storage.stats());
+
+    std::cout <<
+        "\tChunks written: " << commify(io.chunks) << "\n" <<
+        "\t\tRewritten: " << commify(io.rewrites) << "\n" <<
+        "\t\tBytes written: " << commify(io.bytes) << "\n";
+
+    if (const uint64_t total = storage.totalBytes())
+    {
+        std::cout << "\t\tIndex size: " << commify(total) << "\n";
+    }
+
+    std::cout << std::endl;
 }
 
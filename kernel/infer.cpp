@@ -63,9 +63,17 @@ namespace
             "\t-a <tmp path>\n"
             "\t\tDirectory for entwine-generated temporary files.\n\n"
 
-            "\t-x\n"
+            "\t-k <cache path>\n"
+            "\t\tDirectory for a persistent cache of per-file results.  A\n"
+            "\t\trepeated inference of unchanged files will not need to\n"
+            "\t\tread them.\n\n"
+
+            "\t-x (<sample fraction>)\n"
             "\t\tDo not trust file headers when determining bounds.  By\n"
-            "\t\tdefault, the headers are considered to be good.\n\n"
+            "\t\tdefault, the headers are considered to be good.  If a\n"
+            "\t\tfraction in (0, 1] is given, bounds are estimated from\n"
+            "\t\tthat fraction of the points of uncompressed LAS files\n"
+            "\t\trather than from all of them.\n\n"
 
             "\t-m <JSON-array>\n"
             "\t\tTransformation matrix.\n\n";
@@ -130,7 +138,9 @@ void Kernel::infer(std::vector<std::string> args)
     std::size_t threads(4);
     Json::Value jsonReprojection;
     std::string tmpPath("tmp");
+    std::string cachePath;
     bool trustHeaders(true);
+    double sample(0);
     Json::Value arbiterConfig;
     std::unique_ptr<std::vector<double>> transformation;
 
@@ -169,6 +179,17 @@ void Kernel::infer(std::vector<std::string> args)
                 throw std::runtime_error("Invalid tmp specification");
             }
         }
+        else if (arg == "-k")
+        {
+            if (++a < args.size())
+            {
+                cachePath = args[a];
+            }
+            else
+            {
+                throw std::runtime_error("Invalid cache specification");
+            }
+        }
         else if (arg == "-o")
         {
             if (++a < args.size())
@@ -210,6 +231,11 @@ void Kernel::infer(std::vector<std::string> args)
         else if (arg == "-x")
         {
             trustHeaders = false;
+
+            if (a + 1 < args.size() && args[a + 1].front() != '-')
+            {
+                sample = std::stod(args[++a]);
+            }
         }
         else if (arg == "-t")
         {
@@ -269,9 +295,14 @@ void Kernel::infer(std::vector<std::string> args)
     if (paths.size() == 1) std::cout << paths.front() << std::endl;
     else std::cout << paths.size() << " paths" << std::endl;
     std::cout << "\tTemp path: " << tmpPath << std::endl;
+    if (cachePath.size())
+    {
+        std::cout << "\tCache path: " << cachePath << std::endl;
+    }
     std::cout << "\tThreads: " << threads << std::endl;
     std::cout << "\tReprojection: " << reprojString << std::endl;
     std::cout << "\tTrust file headers? " << trustHeadersString << std::endl;
+    if (sample) std::cout << "\tSampled fraction: " << sample << std::endl;
 
     const bool allowDelta(true);
     const bool verbose(true);
@@ -289,6 +320,8 @@ void Kernel::infer(std::vector<std::string> args)
             arbiter.get());
 
     if (transformation) inference.transformation(*transformation);
+    if (cachePath.size()) inference.cache(cachePath);
+    if (sample) inference.sample(sample);
 
     inference.go();
 
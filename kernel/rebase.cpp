@@ -49,8 +49,7 @@ namespace
         backup("h/ids");
         backup("h/0");
 
-        HierarchyCell::Pool pool;
-        Hierarchy h(pool, m, ep, &ep, true, false);
+        Hierarchy h(m, ep, &ep, true, false);
         h.rebase(ep, depth);
     }
 }
@@ -0,0 +1,152 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include <entwine/util/time.hpp>
+
+namespace entwine
+{
+
+class Metadata;
+class Reader;
+
+namespace arbiter { class Endpoint; }
+
+namespace bench
+{
+
+// Accumulates time across start/stop pairs, so that a benchmark may exclude
+// its setup and teardown from the measurement.
+class Timer
+{
+public:
+    void start() { m_start = now(); }
+    void stop()
+    {
+        m_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                now() - m_start).count();
+    }
+
+    double ns() const { return m_ns; }
+    double seconds() const { return m_ns / 1000000000.0; }
+
+private:
+    TimePoint m_start;
+    double m_ns = 0;
+};
+
+// A microbenchmark performs some number of operations per call, timing only
+// the relevant portions with the given Timer, and returns that number.
+using Micro = std::function<std::size_t(Timer&)>;
+
+class Results
+{
+public:
+    explicit Results(double minSeconds) : m_minSeconds(minSeconds) { }
+
+    // After one untimed warm-up call, the benchmark is called repeatedly
+    // until at least the minimum measured time has elapsed.  Returns the
+    // recorded result.
+    Json::Value& micro(const std::string& name, const Micro& f)
+    {
+        Timer warmup;
+        f(warmup);
+
+        Timer timer;
+        std::size_t ops(0);
+        std::size_t calls(0);
+
+        do { ops += f(timer); ++calls; }
+        while (timer.seconds() < m_minSeconds);
+
+        Json::Value& json(m_json["micro"].append(Json::objectValue));
+        json["name"] = name;
+        json["calls"] = Json::UInt64(calls);
+        json["ops"] = Json::UInt64(ops);
+        json["seconds"] = timer.seconds();
+        json["nsPerOp"] = ops ? timer.ns() / ops : 0.0;
+        json["opsPerSecond"] = timer.ns() ? ops / timer.seconds() : 0.0;
+
+        std::cerr << "\t" << name << ": " << json["nsPerOp"].asDouble() <<
+            " ns/op" << std::endl;
+
+        return json;
+    }
+
+    Json::Value& macro(const std::string& name)
+    {
+        return m_json["macro"][name];
+    }
+
+    Json::Value& json() { return m_json; }
+
+private:
+    const double m_minSeconds;
+    Json::Value m_json;
+};
+
+// Latency distribution, in milliseconds.
+inline Json::Value summarize(std::vector<double> ms)
+{
+    Json::Value json;
+    json["count"] = Json::UInt64(ms.size());
+    if (ms.empty()) return json;
+
+    std::sort(ms.begin(), ms.end());
+
+    double total(0);
+    for (const double v : ms) total += v;
+
+    auto percentile([&ms](double p)
+    {
+        const std::size_t i(p * (ms.size() - 1) + 0.5);
+        return ms[std::min(i, ms.size() - 1)];
+    });
+
+    json["mean"] = total / ms.size();
+    json["p50"] = percentile(0.5);
+    json["p90"] = percentile(0.9);
+    json["p99"] = percentile(0.99);
+    json["max"] = ms.back();
+    return json;
+}
+
+// Component benchmarks, run against the metadata and point data of an
+// existing index.  Points are packed in the native schema of the index.
+void runMicro(
+        Results& results,
+        const Metadata& metadata,
+        const std::vector<char>& points,
+        const arbiter::Endpoint& tmp);
+
+// Build the configured index from scratch, recording throughput.
+void runBuild(Results& results, const Json::Value& config);
+
+// Run depth-by-depth and randomized bounded queries against an existing index,
+// recording latencies.  Returns the data of the full index.
+std::vector<char> runQueries(
+        Results& results,
+        Reader& reader,
+        std::size_t numQueries);
+
+} // namespace bench
+} // namespace entwine
+
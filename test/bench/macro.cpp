@@ -0,0 +1,168 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include "bench.hpp"
+
+#include <random>
+#include <stdexcept>
+
+#include <entwine/reader/reader.hpp>
+#include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/tree/builder.hpp>
+#include <entwine/tree/config-parser.hpp>
+#include <entwine/types/manifest.hpp>
+#include <entwine/util/json.hpp>
+#include <entwine/util/metrics.hpp>
+
+namespace entwine
+{
+namespace bench
+{
+
+namespace
+{
+    double msSince(TimePoint start)
+    {
+        return since<std::chrono::microseconds>(start) / 1000.0;
+    }
+}
+
+void runBuild(Results& results, const Json::Value& config)
+{
+    std::cerr << "Building " << config["input"].asString() << std::endl;
+
+    const auto start(now());
+    const Json::Value before(Metrics::toJson());
+
+    auto builder(ConfigParser::getBuilder(config));
+    if (!builder) throw std::runtime_error("Could not create builder");
+    builder->go();
+    builder.reset();
+
+    const double seconds(msSince(start) / 1000.0);
+    const Json::Value after(Metrics::toJson());
+
+    arbiter::Arbiter a;
+    const arbiter::Endpoint out(a.getEndpoint(config["output"].asString()));
+    const Manifest manifest(parse(out.get("entwine-manifest")), out);
+    const std::size_t inserts(manifest.pointStats().inserts());
+
+    Json::Value& json(results.macro("build"));
+    json["files"] = Json::UInt64(manifest.size());
+    json["points"] = Json::UInt64(inserts);
+    json["seconds"] = seconds;
+    json["pointsPerSecond"] = seconds ? inserts / seconds : 0.0;
+
+    // Chunk serialization, including compression and writing, is summed over
+    // all threads.
+    const uint64_t chunks(
+            after["counters"]["chunksSaved"].asUInt64() -
+            before["counters"]["chunksSaved"].asUInt64());
+    const double serialize(
+            after["phases"]["serialize"]["seconds"].asDouble() -
+            before["phases"]["serialize"]["seconds"].asDouble());
+
+    json["storage"] = config["storage"].asString();
+    json["chunks"] = Json::UInt64(chunks);
+    json["chunksPerSecond"] = seconds ? chunks / seconds : 0.0;
+    json["serializeSeconds"] = serialize;
+
+    std::cerr << "\tInserted " << commify(inserts) << " points in " <<
+        seconds << " s" << std::endl;
+}
+
+std::vector<char> runQueries(
+        Results& results,
+        Reader& reader,
+        const std::size_t numQueries)
+{
+    const Metadata& metadata(reader.metadata());
+    const std::size_t pointSize(metadata.schema().pointSize());
+    const Bounds& bounds(metadata.boundsNativeConforming());
+
+    Json::Value& json(results.macro("query"));
+
+    std::cerr << "Querying" << std::endl;
+
+    // Each depth in its entirety, until the data runs out.
+    {
+        std::vector<double> ms;
+        std::size_t points(0);
+        bool found(false);
+
+        for (std::size_t depth(0); ; ++depth)
+        {
+            const auto start(now());
+            const std::size_t np(reader.query(depth).size() / pointSize);
+            ms.push_back(msSince(start));
+
+            points += np;
+            if (np) found = true;
+            else if (found) break;
+            else if (depth > 64) break;
+        }
+
+        json["depth"] = summarize(ms);
+        json["depth"]["points"] = Json::UInt64(points);
+    }
+
+    // Random boxes of random sizes, over a range of depths.
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> unit(0, 1);
+        std::uniform_int_distribution<std::size_t> depthDist(
+                metadata.structure().baseDepthBegin(),
+                metadata.structure().coldDepthBegin() + 4);
+
+        std::vector<double> ms;
+        std::size_t points(0);
+
+        for (std::size_t i(0); i < numQueries; ++i)
+        {
+            const double w(bounds.width() * (0.05 + unit(gen) * 0.45));
+            const double d(bounds.depth() * (0.05 + unit(gen) * 0.45));
+            const double x(bounds.min().x + unit(gen) * (bounds.width() - w));
+            const double y(bounds.min().y + unit(gen) * (bounds.depth() - d));
+
+            const Bounds q(
+                    x, y, bounds.min().z,
+                    x + w, y + d, bounds.max().z);
+
+            const std::size_t depthBegin(depthDist(gen));
+            const std::size_t depthEnd(depthBegin + 1 + i % 4);
+
+            const auto start(now());
+            points += reader.query(q, depthBegin, depthEnd).size() / pointSize;
+            ms.push_back(msSince(start));
+        }
+
+        json["bounded"] = summarize(ms);
+        json["bounded"]["points"] = Json::UInt64(points);
+    }
+
+    // Everything at once, which also provides the data for the microbenchmarks.
+    const auto start(now());
+    std::vector<char> data(reader.query(std::size_t(0), std::size_t(0)));
+    const double ms(msSince(start));
+
+    json["full"]["ms"] = ms;
+    json["full"]["points"] = Json::UInt64(data.size() / pointSize);
+    json["full"]["pointsPerSecond"] =
+        ms ? data.size() / pointSize / (ms / 1000.0) : 0.0;
+
+    std::cerr << "\tFull query: " << commify(data.size() / pointSize) <<
+        " points in " << ms << " ms" << std::endl;
+
+    return data;
+}
+
+} // namespace bench
+} // namespace entwine
+
@@ -0,0 +1,166 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include "bench.hpp"
+#include "bench-config.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <entwine/reader/cache.hpp>
+#include <entwine/reader/reader.hpp>
+#include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/util/json.hpp>
+
+using namespace entwine;
+
+namespace
+{
+    std::string getUsageString()
+    {
+        return
+            "\nUsage: entwine-bench <options>\n"
+
+            "\nBuilds an index, queries it, and runs microbenchmarks against\n"
+            "its data.  Results are written as JSON.  Larger and skewed\n"
+            "inputs may be created with generate-synthetic.\n"
+
+            "\nOptions:\n"
+
+            "\t-i <input path>\n"
+            "\t\tInput data.  Defaults to the bench-ellipsoid-multi-laz\n"
+            "\t\tdirectory of the test data, which is written by running\n"
+            "\t\tgenerate there with a point count, for example\n"
+            "\t\t`generate 10000000`.\n\n"
+
+            "\t-o <output path>\n"
+            "\t\tIndex directory.  Defaults to a temporary directory.\n\n"
+
+            "\t-t <threads>\n"
+            "\t\tBuild threads.  Default: 8.\n\n"
+
+            "\t-q <count>\n"
+            "\t\tNumber of randomized bounded queries.  Default: 100.\n\n"
+
+            "\t-s <seconds>\n"
+            "\t\tMinimum measured time per microbenchmark.  Default: 1.\n\n"
+
+            "\t-f <file>\n"
+            "\t\tWrite results to this file rather than to stdout.\n\n"
+
+            "\t-z\n"
+            "\t\tBuild with scaled LasZip storage rather than absolutely\n"
+            "\t\tpositioned lazperf.\n\n"
+
+            "\t-x\n"
+            "\t\tSkip the build and benchmark an existing index at the\n"
+            "\t\toutput path.\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string input(ENTWINE_BENCH_DATA_PATH "bench-ellipsoid-multi-laz");
+    std::string output(arbiter::fs::getTempPath() + "entwine-bench");
+    std::string file;
+    std::size_t threads(8);
+    std::size_t queries(100);
+    double seconds(1);
+    bool build(true);
+    bool laszip(false);
+
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    try
+    {
+        for (std::size_t a(0); a < args.size(); ++a)
+        {
+            const std::string arg(args[a]);
+            const bool last(a + 1 == args.size());
+
+            if (arg == "-x") build = false;
+            else if (arg == "-z") laszip = true;
+            else if (arg == "-h" || arg == "--help")
+            {
+                std::cout << getUsageString() << std::endl;
+                return 0;
+            }
+            else if (last)
+            {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            else if (arg == "-i") input = args[++a];
+            else if (arg == "-o") output = args[++a];
+            else if (arg == "-f") file = args[++a];
+            else if (arg == "-t") threads = std::stoul(args[++a]);
+            else if (arg == "-q") queries = std::stoul(args[++a]);
+            else if (arg == "-s") seconds = std::stod(args[++a]);
+            else throw std::runtime_error("Invalid argument: " + arg);
+        }
+
+        arbiter::Arbiter a;
+        const std::string tmpPath(arbiter::fs::getTempPath());
+        const arbiter::Endpoint tmp(a.getEndpoint(tmpPath));
+
+        bench::Results results(seconds);
+        Json::Value& json(results.json());
+        json["output"] = output;
+        json["threads"] = Json::UInt64(threads);
+
+        if (build)
+        {
+            Json::Value config;
+            config["input"] = input;
+            config["output"] = output;
+            config["tmp"] = tmpPath;
+            config["threads"] = Json::UInt64(threads);
+            config["absolute"] = !laszip;
+            config["storage"] = laszip ? "laszip" : "lazperf";
+            config["force"] = true;
+
+            json["input"] = input;
+            bench::runBuild(results, config);
+        }
+
+        Cache cache(1024 * 1024 * 1024);
+        Reader reader(output, tmpPath, cache);
+
+        const std::vector<char> data(
+                bench::runQueries(results, reader, queries));
+        json["cache"] = cache.stats();
+
+        bench::runMicro(results, reader.metadata(), data, tmp);
+
+        if (file.empty())
+        {
+            std::cout << json.toStyledString() << std::endl;
+        }
+        else
+        {
+            std::ofstream stream(file, std::ios::out | std::ios::trunc);
+            if (!stream.good())
+            {
+                throw std::runtime_error("Could not open " + file);
+            }
+            stream << json.toStyledString();
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "Benchmark failed: " << e.what() << std::endl;
+        std::cerr << getUsageString() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,542 @@
+/******************************************************************************
+* Copyright (c) 2017, Connor Manning (connor@hobu.co)
+*
+* Entwine -- Point cloud indexing
+*
+* Entwine is available under the terms of the LGPL2 license. See COPYING
+* for specific license text and more information.
+*
+******************************************************************************/
+
+#include "bench.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include <entwine/formats/cesium/settings.hpp>
+#include <entwine/formats/cesium/tile.hpp>
+#include <entwine/reader/filter.hpp>
+#include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/tree/climber.hpp>
+#include <entwine/tree/hierarchy-block.hpp>
+#include <entwine/types/binary-point-table.hpp>
+#include <entwine/types/point-pool.hpp>
+#include <entwine/types/tube.hpp>
+#include <entwine/util/compression.hpp>
+#include <entwine/util/json.hpp>
+
+namespace entwine
+{
+namespace bench
+{
+
+namespace
+{
+    // Caps the working set of each benchmark.
+    const std::size_t maxPoints(1 << 20);
+
+    // Chunk-sized slices for compression.
+    const std::size_t slicePoints(1 << 16);
+
+    // Depth to which points are climbed for tube insertion, which is deep
+    // enough that most tubes are shared by only a few points.
+    const std::size_t tubeDepth(12);
+
+    // Results which would otherwise be unused are written here, so that the
+    // work producing them isn't optimized away.
+    volatile std::size_t sink(0);
+
+    std::vector<Point> extractPoints(
+            const Schema& schema,
+            const std::vector<char>& data)
+    {
+        const std::size_t pointSize(schema.pointSize());
+        const std::size_t np(std::min(data.size() / pointSize, maxPoints));
+
+        BinaryPointTable table(schema);
+        pdal::PointRef pointRef(table, 0);
+
+        std::vector<Point> points;
+        points.reserve(np);
+
+        for (std::size_t i(0); i < np; ++i)
+        {
+            table.setPoint(data.data() + i * pointSize);
+            points.emplace_back(
+                    pointRef.getFieldAs<double>(pdal::Dimension::Id::X),
+                    pointRef.getFieldAs<double>(pdal::Dimension::Id::Y),
+                    pointRef.getFieldAs<double>(pdal::Dimension::Id::Z));
+        }
+
+        return points;
+    }
+}
+
+void runMicro(
+        Results& results,
+        const Metadata& metadata,
+        const std::vector<char>& data,
+        const arbiter::Endpoint& tmp)
+{
+    const Schema& schema(metadata.schema());
+    const std::size_t pointSize(schema.pointSize());
+    const Structure& structure(metadata.structure());
+    const Bounds& cube(metadata.boundsScaledCubic());
+
+    const std::vector<Point> points(extractPoints(schema, data));
+    if (points.empty()) throw std::runtime_error("No points to benchmark");
+
+    std::cerr << "Microbenchmarks over " << commify(points.size()) <<
+        " points" << std::endl;
+
+    results.micro("PointState::climb", [&](Timer& timer)
+    {
+        const std::size_t depth(structure.coldDepthBegin() + 4);
+        PointState pointState(structure, cube);
+
+        timer.start();
+        for (const Point& p : points)
+        {
+            pointState.reset();
+            pointState.climbTo(p, depth);
+        }
+        timer.stop();
+
+        return points.size() * depth;
+    });
+
+    results.micro("BigUint::climb", [&](Timer& timer)
+    {
+        // The index arithmetic of an octree descent, which overflows a single
+        // block after about twenty levels.
+        const std::size_t depth(32);
+        const std::size_t n(points.size());
+        std::size_t check(0);
+
+        timer.start();
+        for (std::size_t i(0); i < n; ++i)
+        {
+            Id id(0);
+            for (std::size_t d(0); d < depth; ++d)
+            {
+                id <<= 3;
+                ++id.data().front();
+                id += (i + d) % 8;
+            }
+            check += id.data().front();
+        }
+        timer.stop();
+
+        sink = check;
+        return n * depth;
+    });
+
+    results.micro("BigUint::divMod", [&](Timer& timer)
+    {
+        const Id big(Id(1) << 70);
+        const Id divisor(structure.basePointsPerChunk());
+        const std::size_t n(points.size());
+        std::size_t check(0);
+
+        timer.start();
+        for (std::size_t i(0); i < n; ++i)
+        {
+            const auto r((big + i).divMod(divisor));
+            check += r.second.getSimple();
+        }
+        timer.stop();
+
+        sink = check;
+        return n;
+    });
+
+    results.micro("SplicePool::acquire/release", [&](Timer& timer)
+    {
+        Cell::Pool pool;
+        const std::size_t n(points.size());
+        const std::size_t batch(256);
+
+        timer.start();
+        for (std::size_t i(0); i < n; i += batch)
+        {
+            Cell::PooledStack stack(pool.acquire(batch));
+            for (std::size_t j(0); j < batch && !stack.empty(); ++j)
+            {
+                Cell::PooledNode node(stack.popOne());
+                pool.release(std::move(node));
+            }
+        }
+        timer.stop();
+
+        return n;
+    });
+
+    {
+        // Climbers are copied per point, so they're created once, untimed.
+        std::vector<Climber> climbers;
+        climbers.reserve(points.size());
+
+        std::map<Id, Tube> tubes;
+        std::vector<Tube*> targets;
+        targets.reserve(points.size());
+
+        for (const Point& p : points)
+        {
+            Climber climber(metadata);
+            climber.magnifyTo(p, tubeDepth);
+            climbers.push_back(climber);
+            targets.push_back(&tubes[climber.index()]);
+        }
+
+        PointPool pointPool(schema);
+
+        results.micro("Tube::insert", [&](Timer& timer)
+        {
+            const std::size_t n(points.size());
+
+            Cell::PooledStack cellStack(pointPool.cellPool().acquire(n));
+            Data::PooledStack dataStack(pointPool.dataPool().acquire(n));
+
+            std::vector<Cell::PooledNode> cells;
+            cells.reserve(n);
+
+            for (std::size_t i(0); i < n; ++i)
+            {
+                Data::PooledNode dataNode(dataStack.popOne());
+                std::copy(
+                        data.data() + i * pointSize,
+                        data.data() + (i + 1) * pointSize,
+                        *dataNode);
+
+                cells.push_back(cellStack.popOne());
+                cells.back()->point() = points[i];
+                cells.back()->push(std::move(dataNode));
+            }
+
+            std::size_t done(0);
+
+            timer.start();
+            for (std::size_t i(0); i < n; ++i)
+            {
+                if (targets[i]->insert(climbers[i], cells[i]).done()) ++done;
+            }
+            timer.stop();
+
+            // Return everything to the pools.
+            Cell::PooledStack used(pointPool.cellPool());
+            for (auto& cell : cells) if (cell) used.push(std::move(cell));
+            for (auto& p : tubes)
+            {
+                for (auto& c : p.second) used.push(std::move(c.second));
+                p.second = Tube();
+            }
+            pointPool.release(std::move(used));
+
+            sink = done;
+            return n;
+        });
+    }
+
+    {
+        const std::size_t np(points.size());
+        const std::size_t slices((np + slicePoints - 1) / slicePoints);
+
+        std::vector<std::unique_ptr<std::vector<char>>> compressed;
+        for (std::size_t i(0); i < slices; ++i)
+        {
+            const std::size_t count(
+                    std::min(slicePoints, np - i * slicePoints));
+            compressed.push_back(
+                    Compression::compress(
+                        data.data() + i * slicePoints * pointSize,
+                        count * pointSize,
+                        schema));
+        }
+
+        results.micro("Compression::compress", [&](Timer& timer)
+        {
+            timer.start();
+            for (std::size_t i(0); i < slices; ++i)
+            {
+                const std::size_t count(
+                        std::min(slicePoints, np - i * slicePoints));
+                Compression::compress(
+                        data.data() + i * slicePoints * pointSize,
+                        count * pointSize,
+                        schema);
+            }
+            timer.stop();
+
+            return np;
+        });
+
+        // Both codecs decode into pooled cells, as chunk storage reads do.
+        // Only the decoding is timed, and the cells are returned untimed.
+        PointPool pointPool(schema);
+
+        const Json::Value& lazperf(
+                results.micro("Compression::decompress", [&](Timer& timer)
+        {
+            for (std::size_t i(0); i < slices; ++i)
+            {
+                const auto& c(*compressed[i]);
+                const std::size_t count(
+                        std::min(slicePoints, np - i * slicePoints));
+
+                timer.start();
+                Cell::PooledStack cells(
+                        Compression::decompress(
+                            c.data(),
+                            c.size(),
+                            count,
+                            pointPool));
+                timer.stop();
+
+                pointPool.release(std::move(cells));
+            }
+
+            return np;
+        }));
+
+        // Ratios are of uncompressed to compressed size, and decode rates are
+        // in uncompressed megabytes per second.
+        auto describe([&](
+                    const std::vector<std::unique_ptr<std::vector<char>>>& c,
+                    const Json::Value& decode)
+        {
+            std::size_t bytes(0);
+            for (const auto& v : c) bytes += v->size();
+
+            Json::Value json;
+            json["bytes"] = Json::UInt64(bytes);
+            json["ratio"] = bytes ? double(np * pointSize) / bytes : 0.0;
+            json["decodeMBps"] =
+                decode["opsPerSecond"].asDouble() * pointSize / 1000000.0;
+            return json;
+        });
+
+        Json::Value& summary(results.json()["compression"]);
+        summary["rawBytes"] = Json::UInt64(np * pointSize);
+        summary["lazperf"] = describe(compressed, lazperf);
+
+#ifdef ENTWINE_ZSTD
+        const int zstdLevel(3);
+
+        std::vector<std::vector<const char*>> slicePositions(slices);
+        for (std::size_t i(0); i < np; ++i)
+        {
+            slicePositions[i / slicePoints].push_back(
+                    data.data() + i * pointSize);
+        }
+
+        std::vector<std::unique_ptr<std::vector<char>>> zstdCompressed;
+        for (const auto& positions : slicePositions)
+        {
+            zstdCompressed.push_back(
+                    Compression::compressZstd(positions, schema, zstdLevel));
+        }
+
+        results.micro("Compression::compressZstd", [&](Timer& timer)
+        {
+            timer.start();
+            for (const auto& positions : slicePositions)
+            {
+                Compression::compressZstd(positions, schema, zstdLevel);
+            }
+            timer.stop();
+
+            return np;
+        });
+
+        const Json::Value& zstd(
+                results.micro("Compression::decompressZstd", [&](Timer& timer)
+        {
+            for (std::size_t i(0); i < slices; ++i)
+            {
+                const auto& c(*zstdCompressed[i]);
+                const std::size_t count(slicePositions[i].size());
+
+                timer.start();
+                Cell::PooledStack cells(
+                        Compression::decompressZstd(
+                            c.data(),
+                            c.size(),
+                            count,
+                            pointPool));
+                timer.stop();
+
+                pointPool.release(std::move(cells));
+            }
+
+            return np;
+        }));
+
+        summary["zstd"] = describe(zstdCompressed, zstd);
+        summary["zstd"]["level"] = zstdLevel;
+#endif
+    }
+
+    results.micro("HierarchyTube::count (contended)", [&](Timer& timer)
+    {
+        // All threads count into the same small set of tubes and ticks,
+        // which is the worst case for the shallow depths of a build.
+        const std::size_t numThreads(8);
+        const std::size_t numTubes(16);
+        const std::size_t numTicks(8);
+        const std::size_t n(points.size());
+
+        std::vector<HierarchyTube> tubes(numTubes);
+        std::vector<std::thread> threads;
+
+        timer.start();
+        for (std::size_t t(0); t < numThreads; ++t)
+        {
+            threads.emplace_back([&tubes, n, t]()
+            {
+                for (std::size_t i(0); i < n; ++i)
+                {
+                    const std::size_t v(i + t);
+                    tubes[v % numTubes].count(v / numTubes % numTicks, 1);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        timer.stop();
+
+        return numThreads * n;
+    });
+
+    if (metadata.hierarchyStructure().hasBase())
+    {
+        // Counts land in the base block of the hierarchy, at its deepest
+        // depth.
+        const Structure& hs(metadata.hierarchyStructure());
+        std::vector<std::pair<Id, uint64_t>> positions;
+
+        PointState pointState(hs, cube);
+        for (const Point& p : points)
+        {
+            pointState.reset();
+            pointState.climbTo(p, hs.baseDepthEnd() - 1);
+            if (hs.isWithinBase(pointState.depth()))
+            {
+                positions.emplace_back(pointState.index(), pointState.tick());
+            }
+        }
+
+        const std::string name("bench-hierarchy");
+        std::unique_ptr<HierarchyBlock> block;
+
+        results.micro("HierarchyBlock::count", [&](Timer& timer)
+        {
+            block = HierarchyBlock::create(
+                    metadata, 0, &tmp, hs.baseIndexSpan());
+
+            timer.start();
+            for (const auto& p : positions) block->count(p.first, p.second, 1);
+            timer.stop();
+
+            return positions.size();
+        });
+
+        // Saving includes the combination of the block, its compression if
+        // any, and a local write.
+        results.micro("HierarchyBlock::save", [&](Timer& timer)
+        {
+            timer.start();
+            block->save(tmp, "-" + name);
+            timer.stop();
+
+            return positions.size();
+        });
+
+        const std::vector<char> saved(tmp.getBinary("0-" + name));
+
+        results.micro("HierarchyBlock::parse", [&](Timer& timer)
+        {
+            timer.start();
+            auto parsed(
+                    HierarchyBlock::create(
+                        metadata, 0, &tmp, hs.baseIndexSpan(), saved, true));
+            timer.stop();
+
+            return positions.size();
+        });
+
+        arbiter::fs::remove(tmp.fullPath("0-" + name));
+    }
+
+    {
+        // Tiles of the benchmark points, colored by index and with normals
+        // facing outward from the center of the data.
+        const std::size_t np(std::min(points.size(), slicePoints));
+        const Point mid(cube.mid());
+
+        cesium::TileData tileData(np, true, true);
+        for (std::size_t i(0); i < np; ++i)
+        {
+            const Point& p(points[i]);
+            tileData.points.push_back(p);
+            tileData.colors.emplace_back(i % 256, (i / 256) % 256, i * 7 % 256);
+            tileData.normals.push_back(Point::normalize(p - mid));
+        }
+
+        auto encode([&](const std::string name, const cesium::Settings& s)
+        {
+            std::size_t bytes(0);
+
+            Json::Value& json(
+                    results.micro(name, [&](Timer& timer)
+            {
+                timer.start();
+                bytes = cesium::Tile(tileData, s).asBinary().size();
+                timer.stop();
+
+                return np;
+            }));
+
+            json["bytesPerPoint"] = static_cast<double>(bytes) / np;
+        });
+
+        encode("cesium::Tile (float)", cesium::Settings(0, 0, "", false));
+        encode(
+                "cesium::Tile (compact)",
+                cesium::Settings(0, 0, "", false, true, true, true));
+    }
+
+    {
+        const Filter filter(
+                metadata,
+                Bounds::everything(),
+                parse(
+                    "{ \"Classification\": { \"$in\": [2, 3, 4] }, "
+                    "\"Z\": { \"$gt\": 0 } }"),
+                nullptr);
+
+        BinaryPointTable table(schema);
+        pdal::PointRef pointRef(table, 0);
+
+        results.micro("Filter::check", [&](Timer& timer)
+        {
+            const std::size_t n(points.size());
+            std::size_t passed(0);
+
+            timer.start();
+            for (std::size_t i(0); i < n; ++i)
+            {
+                table.setPoint(data.data() + i * pointSize);
+                if (filter.check(pointRef)) ++passed;
+            }
+            timer.stop();
+
+            sink = passed;
+            return n;
+        });
+    }
+}
+
+} // namespace bench
+} // namespace entwine
+
@@ -1,5 +1,6 @@
 #include <cmath>
 #include <iostream>
+#include <string>
 
 #include <entwine/third/arbiter/arbiter.hpp>
 #include <entwine/types/dir.hpp>
@@ -25,9 +26,19 @@ namespace
     }
 }
 
-int main()
+// Usage: generate [number of points]
+//
+// The default size is the one expected by the unit tests, written to the
+// ellipsoid-* directories that they read.  Other sizes may be generated for
+// benchmarking, and are written to bench-ellipsoid-* instead so that the unit
+// test data is left alone.
+int main(int argc, char** argv)
 {
     const Point radius(150, 100, 50);
+    const double defaultPoints(100000);
+    const double numPoints(argc > 1 ? std::stod(argv[1]) : defaultPoints);
+    const std::string prefix(
+            numPoints == defaultPoints ? "ellipsoid-" : "bench-ellipsoid-");
 
     pdal::PointTable table;
     table.layout()->registerDims({
@@ -141,7 +152,7 @@ int main()
     addCartesian(Point(-1, 0, 0));
 
     {
-        double N = 100000 + 4;
+        double N = numPoints + 4;
         double area = 4 * pi / N;
         double distance = std::sqrt(area);
         double mTheta = std::round(pi / distance);
@@ -204,7 +215,7 @@ int main()
     }
 
     {
-        arbiter::fs::mkdirp("ellipsoid-single-laz");
+        arbiter::fs::mkdirp(prefix + "single-laz");
 
         pdal::BufferReader reader;
         for (auto v : views) reader.addView(v);
@@ -215,7 +226,7 @@ int main()
                     sf.createStage("writers.las")));
 
         pdal::Options options;
-        options.add("filename", "ellipsoid-single-laz/ellipsoid.laz");
+        options.add("filename", prefix + "single-laz/ellipsoid.laz");
         options.add("compression", "laszip");
         writer.setOptions(options);
         writer.setInput(reader);
@@ -224,7 +235,7 @@ int main()
     }
 
     {
-        arbiter::fs::mkdirp("ellipsoid-multi-laz");
+        arbiter::fs::mkdirp(prefix + "multi-laz");
 
         for (std::size_t i(0); i < views.size(); ++i)
         {
@@ -240,7 +251,7 @@ int main()
                         sf.createStage("writers.las")));
 
             pdal::Options options;
-            options.add("filename", "ellipsoid-multi-laz/" + dir + ".laz");
+            options.add("filename", prefix + "multi-laz/" + dir + ".laz");
             options.add("compression", "laszip");
             writer.setOptions(options);
             writer.setInput(reader);
@@ -250,7 +261,32 @@ int main()
     }
 
     {
-        arbiter::fs::mkdirp("ellipsoid-multi-bpf");
+        arbiter::fs::mkdirp(prefix + "multi-las");
+
+        for (std::size_t i(0); i < views.size(); ++i)
+        {
+            auto v(views.at(i));
+            const std::string dir(dirToString(toDir(i)));
+
+            pdal::BufferReader reader;
+            reader.addView(v);
+
+            pdal::StageFactory sf;
+            pdal::Writer& writer(
+                    *dynamic_cast<pdal::Writer*>(
+                        sf.createStage("writers.las")));
+
+            pdal::Options options;
+            options.add("filename", prefix + "multi-las/" + dir + ".las");
+            writer.setOptions(options);
+            writer.setInput(reader);
+            writer.prepare(table);
+            writer.execute(table);
+        }
+    }
+
+    {
+        arbiter::fs::mkdirp(prefix + "multi-bpf");
 
         for (std::size_t i(0); i < views.size(); ++i)
         {
@@ -266,7 +302,7 @@ int main()
                         sf.createStage("writers.bpf")));
 
             pdal::Options options;
-            options.add("filename", "ellipsoid-multi-bpf/" + dir + ".bpf");
+            options.add("filename", prefix + "multi-bpf/" + dir + ".bpf");
             writer.setOptions(options);
             writer.setInput(reader);
             writer.prepare(table);
@@ -275,7 +311,7 @@ int main()
     }
 
     {
-        arbiter::fs::mkdirp("ellipsoid-single-nyc");
+        arbiter::fs::mkdirp(prefix + "single-nyc");
 
         pdal::BufferReader reader;
         for (auto v : nycViews) reader.addView(v);
@@ -286,7 +322,7 @@ int main()
                     sf.createStage("writers.las")));
 
         pdal::Options options;
-        options.add("filename", "ellipsoid-single-nyc/ellipsoid.laz");
+        options.add("filename", prefix + "single-nyc/ellipsoid.laz");
         options.add("compression", "laszip");
         writer.setSpatialReference(pdal::SpatialReference("EPSG:3857"));
         writer.setOptions(options);
@@ -296,7 +332,7 @@ int main()
     }
 
     {
-        arbiter::fs::mkdirp("ellipsoid-multi-nyc");
+        arbiter::fs::mkdirp(prefix + "multi-nyc");
 
         for (std::size_t i(0); i < nycViews.size(); ++i)
         {
@@ -312,7 +348,7 @@ int main()
                         sf.createStage("writers.las")));
 
             pdal::Options options;
-            options.add("filename", "ellipsoid-multi-nyc/" + dir + ".laz");
+            options.add("filename", prefix + "multi-nyc/" + dir + ".laz");
             options.add("compression", "laszip");
             writer.setSpatialReference(pdal::SpatialReference("EPSG:3857"));
             writer.setOptions(options);
@@ -323,7 +359,7 @@ int main()
     }
 
     {
-        arbiter::fs::mkdirp("ellipsoid-single-nyc-wrong-srs");
+        arbiter::fs::mkdirp(prefix + "single-nyc-wrong-srs");
 
         pdal::BufferReader reader;
         for (auto v : nycViews) reader.addView(v);
@@ -334,7 +370,7 @@ int main()
                     sf.createStage("writers.las")));
 
         pdal::Options options;
-        options.add("filename", "ellipsoid-single-nyc-wrong-srs/ellipsoid.laz");
+        options.add("filename", prefix + "single-nyc-wrong-srs/ellipsoid.laz");
         options.add("compression", "laszip");
         writer.setSpatialReference(pdal::SpatialReference("EPSG:26915"));
         writer.setOptions(options);
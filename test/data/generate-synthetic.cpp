@@ -0,0 +1,540 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <entwine/third/arbiter/arbiter.hpp>
+#include <entwine/types/point.hpp>
+#include <entwine/util/json.hpp>
+#include <entwine/util/pool.hpp>
+#include <entwine/util/time.hpp>
+
+#include <pdal/PointTable.hpp>
+#include <pdal/Reader.hpp>
+#include <pdal/io/LasWriter.hpp>
+
+// Streams synthetic point clouds of arbitrary size to LAS/LAZ files.  Points
+// are generated one at a time as the writer pulls them, so memory use does not
+// depend on the number of points.  Every point is a function of the seed and
+// its index, so files may be written concurrently and output is reproducible.
+
+using namespace entwine;
+using D = pdal::Dimension::Id;
+
+namespace
+{
+    const double pi(std::acos(-1));
+
+    std::string getUsageString()
+    {
+        return
+            "\nUsage: generate-synthetic <options>\n"
+
+            "\nOptions:\n"
+
+            "\t-o <output directory>\n"
+            "\t\tRequired.\n\n"
+
+            "\t-n <points>\n"
+            "\t\tTotal number of points.  Default: 10000000.\n\n"
+
+            "\t-f <files>\n"
+            "\t\tNumber of output files.  Default: 16.\n\n"
+
+            "\t-d <distribution>\n"
+            "\t\tuniform: Evenly spread over gently rolling terrain.\n"
+            "\t\tclustered: Dense urban clusters with buildings, over a\n"
+            "\t\t\tsparse uniform background.\n"
+            "\t\tstrips: Overlapping flight lines of zigzag scans.  Each\n"
+            "\t\t\tfile holds consecutive scans, like flight line files.\n"
+            "\t\tdensity: Power-law density with tiny, extremely dense\n"
+            "\t\t\thotspots.\n"
+            "\t\tDefault: uniform.\n\n"
+
+            "\t-p <LAS point format>\n"
+            "\t\tOne of 0, 1, 2, 3, 6, 7, or 8.  Default: 3.\n\n"
+
+            "\t-u <ratio>\n"
+            "\t\tFraction of points which duplicate the previous point\n"
+            "\t\texactly.  Default: 0.\n\n"
+
+            "\t-e <extent>\n"
+            "\t\tWidth and depth of the data, in meters.  Default: 10000.\n\n"
+
+            "\t-s <seed>\n"
+            "\t\tDefault: 42.\n\n"
+
+            "\t-t <threads>\n"
+            "\t\tFiles written concurrently.  Default: 4.\n\n"
+
+            "\t-c\n"
+            "\t\tWrite LAZ rather than LAS.\n";
+    }
+
+    enum class Distribution { Uniform, Clustered, Strips, Density };
+
+    Distribution toDistribution(const std::string& s)
+    {
+        if (s == "uniform") return Distribution::Uniform;
+        if (s == "clustered") return Distribution::Clustered;
+        if (s == "strips") return Distribution::Strips;
+        if (s == "density") return Distribution::Density;
+        throw std::runtime_error("Invalid distribution: " + s);
+    }
+
+    // The dimensions of the standard LAS point formats which are written here.
+    pdal::Dimension::IdList dimsFor(const int format)
+    {
+        pdal::Dimension::IdList dims {
+            D::X, D::Y, D::Z,
+            D::Intensity,
+            D::ReturnNumber, D::NumberOfReturns,
+            D::ScanDirectionFlag, D::EdgeOfFlightLine,
+            D::Classification, D::ScanAngleRank, D::UserData,
+            D::PointSourceId
+        };
+
+        const bool time(format != 0 && format != 2);
+        const bool color(format == 2 || format == 3 || format >= 7);
+
+        if (time) dims.push_back(D::GpsTime);
+        if (color)
+        {
+            dims.insert(dims.end(), { D::Red, D::Green, D::Blue });
+        }
+        if (format == 8) dims.push_back(D::Infrared);
+
+        return dims;
+    }
+
+    struct Options
+    {
+        std::string out;
+        uint64_t points = 10000000;
+        std::size_t files = 16;
+        Distribution distribution = Distribution::Uniform;
+        std::string distributionName = "uniform";
+        int format = 3;
+        double duplicates = 0;
+        double extent = 10000;
+        uint64_t seed = 42;
+        std::size_t threads = 4;
+        bool compress = false;
+    };
+
+    // Per-point attributes, before they are written into the point layout.
+    struct Sample
+    {
+        Point p;
+        uint16_t intensity = 0;
+        uint8_t returnNumber = 1;
+        uint8_t numReturns = 1;
+        bool scanDirection = false;
+        bool edge = false;
+        uint8_t classification = 1;
+        double scanAngle = 0;
+        uint16_t sourceId = 0;
+        double gpsTime = 0;
+        uint16_t red = 0, green = 0, blue = 0, infrared = 0;
+    };
+
+    struct Cluster
+    {
+        Point center;
+        double sigma;
+        double height;
+    };
+
+    // Generates the points of one file, whose points are the range [begin,
+    // end) of the full data set.  Any spatial structure shared between files,
+    // like cluster locations, is derived from the seed alone.
+    class Generator
+    {
+    public:
+        Generator(const Options& options, uint64_t begin, uint64_t end)
+            : m_o(options)
+            , m_begin(begin)
+            , m_end(end)
+            , m_index(begin)
+            , m_gen(options.seed * 1000003 + begin)
+        {
+            std::mt19937_64 shared(options.seed);
+            const double e(m_o.extent);
+
+            for (std::size_t i(0); i < 32; ++i)
+            {
+                m_clusters.push_back(Cluster {
+                    Point(unit(shared) * e, unit(shared) * e, 0),
+                    e * (0.01 + unit(shared) * 0.04),
+                    5 + unit(shared) * 60 });
+            }
+
+            for (std::size_t i(0); i < 4; ++i)
+            {
+                m_hotspots.push_back(
+                        Point(unit(shared) * e, unit(shared) * e, 0));
+            }
+        }
+
+        bool done() const { return m_index >= m_end; }
+
+        void next(pdal::PointRef& point)
+        {
+            if (m_index == m_begin || unit(m_gen) >= m_o.duplicates)
+            {
+                generate();
+            }
+
+            const Sample& s(m_sample);
+            point.setField(D::X, s.p.x);
+            point.setField(D::Y, s.p.y);
+            point.setField(D::Z, s.p.z);
+            point.setField(D::Intensity, s.intensity);
+            point.setField(D::ReturnNumber, s.returnNumber);
+            point.setField(D::NumberOfReturns, s.numReturns);
+            point.setField(D::ScanDirectionFlag, s.scanDirection);
+            point.setField(D::EdgeOfFlightLine, s.edge);
+            point.setField(D::Classification, s.classification);
+            point.setField(D::ScanAngleRank, s.scanAngle);
+            point.setField(D::UserData, 0);
+            point.setField(D::PointSourceId, s.sourceId);
+
+            if (point.hasDim(D::GpsTime)) point.setField(D::GpsTime, s.gpsTime);
+            if (point.hasDim(D::Red))
+            {
+                point.setField(D::Red, s.red);
+                point.setField(D::Green, s.green);
+                point.setField(D::Blue, s.blue);
+            }
+            if (point.hasDim(D::Infrared))
+            {
+                point.setField(D::Infrared, s.infrared);
+            }
+
+            ++m_index;
+        }
+
+    private:
+        template<typename Gen>
+        static double unit(Gen& gen)
+        {
+            return std::uniform_real_distribution<double>(0, 1)(gen);
+        }
+
+        double normal(double sigma)
+        {
+            return std::normal_distribution<double>(0, sigma)(m_gen);
+        }
+
+        double terrain(double x, double y) const
+        {
+            const double e(m_o.extent);
+            return 100 +
+                20 * std::sin(x / e * 2 * pi) * std::cos(y / e * 2 * pi) +
+                5 * std::sin(x / e * 17 * pi) * std::sin(y / e * 13 * pi);
+        }
+
+        double clamp(double v) const
+        {
+            return std::max(0.0, std::min(v, m_o.extent));
+        }
+
+        void generate()
+        {
+            Sample& s(m_sample);
+            s = Sample();
+            s.gpsTime = 1e8 + m_index * 1e-5;
+
+            switch (m_o.distribution)
+            {
+                case Distribution::Uniform: uniform(); break;
+                case Distribution::Clustered: clustered(); break;
+                case Distribution::Strips: strips(); break;
+                case Distribution::Density: density(); break;
+            }
+
+            const double ground(terrain(s.p.x, s.p.y));
+            if (s.classification == 1)
+            {
+                // Unassigned so far: ground, or low to high vegetation.
+                const double r(unit(m_gen));
+                if (r < 0.6) s.p.z = ground + normal(0.05);
+                else s.p.z = ground + r * r * 30;
+
+                if (r < 0.6) s.classification = 2;
+                else s.classification = r < 0.7 ? 3 : (r < 0.85 ? 4 : 5);
+            }
+
+            if (s.classification > 2)
+            {
+                s.numReturns = 1 + m_gen() % 4;
+                s.returnNumber = 1 + m_gen() % s.numReturns;
+            }
+
+            s.intensity = 200 * s.classification + m_gen() % 200;
+            s.red = s.classification == 2 ? 140 << 8 : 60 << 8;
+            s.green = s.classification == 6 ? 90 << 8 : 130 << 8;
+            s.blue = s.classification == 6 ? 90 << 8 : 70 << 8;
+            s.infrared = s.classification >= 3 ? 200 << 8 : 80 << 8;
+        }
+
+        void uniform()
+        {
+            m_sample.p.x = unit(m_gen) * m_o.extent;
+            m_sample.p.y = unit(m_gen) * m_o.extent;
+        }
+
+        void clustered()
+        {
+            Sample& s(m_sample);
+            if (unit(m_gen) < 0.2) return uniform();
+
+            const Cluster& c(m_clusters[m_gen() % m_clusters.size()]);
+            s.p.x = clamp(c.center.x + normal(c.sigma));
+            s.p.y = clamp(c.center.y + normal(c.sigma));
+
+            // Rectangular building footprints on a block grid, with roofs at
+            // a height which falls off away from the cluster center.
+            const double block(25);
+            const double bx(std::fmod(s.p.x, block) / block);
+            const double by(std::fmod(s.p.y, block) / block);
+
+            if (bx > 0.15 && bx < 0.85 && by > 0.15 && by < 0.85)
+            {
+                const double d(
+                        std::hypot(s.p.x - c.center.x, s.p.y - c.center.y));
+                const double h(c.height * std::exp(-d / (2 * c.sigma)));
+
+                if (h > 3)
+                {
+                    s.p.z = terrain(s.p.x, s.p.y) + std::round(h);
+                    s.classification = 6;
+                }
+            }
+        }
+
+        void strips()
+        {
+            // Fixed-size scans across the track, with consecutive scans in
+            // alternating directions.  Adjacent lines overlap by 20%.
+            Sample& s(m_sample);
+            const double e(m_o.extent);
+            const uint64_t lines(std::max<uint64_t>(m_o.files, 8));
+            const uint64_t perLine((m_o.points + lines - 1) / lines);
+            const uint64_t perScan(std::max<uint64_t>(
+                        std::sqrt(static_cast<double>(perLine) / 64), 8));
+            const uint64_t scans((perLine + perScan - 1) / perScan);
+
+            const uint64_t line(m_index / perLine);
+            const uint64_t k(m_index % perLine);
+            const uint64_t scan(k / perScan);
+            const uint64_t j(k % perScan);
+
+            const double spacing(e / lines);
+            const double width(spacing * 1.2);
+            const bool forward(scan % 2 == 0);
+
+            double across(static_cast<double>(j) / (perScan - 1));
+            if (!forward) across = 1 - across;
+
+            double along(e * (scan + 0.5) / scans);
+            if (line % 2) along = e - along;
+
+            s.p.x = clamp(along + normal(0.05));
+            s.p.y = clamp(spacing * (line + 0.5) + (across - 0.5) * width);
+            s.scanDirection = forward;
+            s.edge = j == 0 || j == perScan - 1;
+            s.scanAngle = (across - 0.5) * 40;
+            s.sourceId = line + 1;
+        }
+
+        void density()
+        {
+            // Half of the points are within a few meters of one of a handful
+            // of hotspots.  The rest fall off steeply from one corner.
+            Sample& s(m_sample);
+
+            if (unit(m_gen) < 0.5)
+            {
+                const Point& h(m_hotspots[m_gen() % m_hotspots.size()]);
+                const double sigma(m_o.extent * 0.0002);
+                s.p.x = clamp(h.x + normal(sigma));
+                s.p.y = clamp(h.y + normal(sigma));
+            }
+            else
+            {
+                s.p.x = std::pow(unit(m_gen), 4) * m_o.extent;
+                s.p.y = std::pow(unit(m_gen), 4) * m_o.extent;
+            }
+        }
+
+        const Options& m_o;
+        const uint64_t m_begin;
+        const uint64_t m_end;
+        uint64_t m_index;
+
+        std::mt19937_64 m_gen;
+        std::vector<Cluster> m_clusters;
+        std::vector<Point> m_hotspots;
+
+        Sample m_sample;
+    };
+
+    class SyntheticReader : public pdal::Reader
+    {
+    public:
+        SyntheticReader(Generator& generator) : m_generator(generator) { }
+
+        virtual bool processOne(pdal::PointRef& point) override
+        {
+            if (m_generator.done()) return false;
+            m_generator.next(point);
+            return true;
+        }
+
+        std::string getName() const override { return "readers.synthetic"; }
+
+    private:
+        Generator& m_generator;
+    };
+
+    // Stage preparation is not thread-safe.
+    std::mutex mutex;
+
+    void write(
+            const Options& o,
+            const std::string& filename,
+            const uint64_t begin,
+            const uint64_t end)
+    {
+        Generator generator(o, begin, end);
+        SyntheticReader reader(generator);
+
+        pdal::FixedPointTable table(4096);
+        table.layout()->registerDims(dimsFor(o.format));
+        table.layout()->finalize();
+
+        pdal::Options options;
+        options.add("filename", filename);
+        options.add("dataformat_id", o.format);
+        options.add("minor_version", o.format >= 6 ? 4 : 2);
+        options.add("scale_x", 0.01);
+        options.add("scale_y", 0.01);
+        options.add("scale_z", 0.01);
+        options.add("offset_x", 0);
+        options.add("offset_y", 0);
+        options.add("offset_z", 0);
+        if (o.compress) options.add("compression", "laszip");
+
+        pdal::LasWriter writer;
+        writer.setOptions(options);
+        writer.setInput(reader);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writer.prepare(table);
+        }
+
+        writer.execute(table);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options o;
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    try
+    {
+        for (std::size_t i(0); i < args.size(); ++i)
+        {
+            const std::string arg(args[i]);
+
+            if (arg == "-c") { o.compress = true; continue; }
+            if (arg == "-h" || arg == "--help")
+            {
+                std::cout << getUsageString() << std::endl;
+                return 0;
+            }
+            if (i + 1 == args.size())
+            {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+
+            const std::string val(args[++i]);
+
+            if (arg == "-o") o.out = val;
+            else if (arg == "-n") o.points = std::stod(val);
+            else if (arg == "-f") o.files = std::stoul(val);
+            else if (arg == "-d")
+            {
+                o.distribution = toDistribution(val);
+                o.distributionName = val;
+            }
+            else if (arg == "-p") o.format = std::stoi(val);
+            else if (arg == "-u") o.duplicates = std::stod(val);
+            else if (arg == "-e") o.extent = std::stod(val);
+            else if (arg == "-s") o.seed = std::stoull(val);
+            else if (arg == "-t") o.threads = std::stoul(val);
+            else throw std::runtime_error("Invalid argument: " + arg);
+        }
+
+        if (o.out.empty()) throw std::runtime_error("Output required");
+        if (!o.files) throw std::runtime_error("At least one file required");
+        if (o.format < 0 || o.format > 8 || o.format == 4 || o.format == 5)
+        {
+            throw std::runtime_error("Unsupported point format");
+        }
+        if (o.duplicates < 0 || o.duplicates >= 1)
+        {
+            throw std::runtime_error("Duplicate ratio must be in [0, 1)");
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cout << e.what() << "\n" << getUsageString() << std::endl;
+        return 1;
+    }
+
+    if (o.out.back() != '/') o.out += '/';
+    arbiter::fs::mkdirp(o.out);
+
+    const auto start(now());
+    const std::string ext(o.compress ? ".laz" : ".las");
+    const uint64_t perFile(o.points / o.files);
+    const uint64_t extra(o.points % o.files);
+
+    Pool pool(o.threads);
+
+    uint64_t begin(0);
+    for (std::size_t i(0); i < o.files; ++i)
+    {
+        const uint64_t end(begin + perFile + (i < extra ? 1 : 0));
+        const std::string filename(
+                o.out + o.distributionName + "-" + std::to_string(i) + ext);
+
+        pool.add([&o, filename, begin, end]()
+        {
+            write(o, filename, begin, end);
+        });
+
+        begin = end;
+    }
+
+    pool.join();
+
+    for (const auto& e : pool.errors()) std::cout << e << std::endl;
+    if (pool.errors().size()) return 1;
+
+    std::cout << "Wrote " << commify(o.points) << " points to " <<
+        o.files << " files in " << since<std::chrono::seconds>(start) <<
+        " seconds" << std::endl;
+
+    return 0;
+}
+
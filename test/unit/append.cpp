@@ -0,0 +1,164 @@
+#include "gtest/gtest.h"
+#include "config.hpp"
+
+#include <future>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <entwine/reader/append.hpp>
+#include <entwine/third/arbiter/arbiter.hpp>
+
+using namespace entwine;
+
+namespace
+{
+    const std::string tmpPath(test::dataPath() + "tmp/append/");
+
+    std::vector<char> version(int v)
+    {
+        const std::string s("version " + std::to_string(v));
+        return std::vector<char>(s.begin(), s.end());
+    }
+
+    // Records writes, optionally blocking the first one until released and
+    // failing while told to.
+    class Recorder
+    {
+    public:
+        AppendWriter::Put put(bool block = false)
+        {
+            if (!block) m_release.set_value();
+
+            return [this](
+                    const arbiter::Endpoint&,
+                    const std::string& path,
+                    const std::vector<char>& data)
+            {
+                // Whether this write fails is decided when it starts.
+                bool fail(false);
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    fail = m_fail;
+                }
+
+                if (!m_blocked)
+                {
+                    m_blocked = true;
+                    m_started.set_value();
+                    m_release.get_future().wait();
+                }
+
+                if (fail) throw std::runtime_error("Put failed");
+
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_writes.emplace_back(path, data);
+            };
+        }
+
+        void awaitStarted() { m_started.get_future().wait(); }
+        void release() { m_release.set_value(); }
+        void fail(bool f)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_fail = f;
+        }
+
+        std::vector<std::pair<std::string, std::vector<char>>> writes()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_writes;
+        }
+
+    private:
+        bool m_blocked = false;
+        bool m_fail = false;
+        std::promise<void> m_started;
+        std::promise<void> m_release;
+        std::mutex m_mutex;
+        std::vector<std::pair<std::string, std::vector<char>>> m_writes;
+    };
+}
+
+TEST(AppendWriter, Coalesces)
+{
+    arbiter::Arbiter a;
+    const auto ep(a.getEndpoint(tmpPath));
+
+    Recorder recorder;
+    AppendWriter writer(1, recorder.put(true));
+
+    // While the first write is in progress, newer versions replace each
+    // other, so only the newest is written after it.
+    writer.put(ep, "a", version(0));
+    recorder.awaitStarted();
+    for (int v(1); v < 10; ++v) writer.put(ep, "a", version(v));
+    recorder.release();
+    writer.flush();
+
+    const auto writes(recorder.writes());
+    ASSERT_EQ(writes.size(), 2u);
+    EXPECT_EQ(writes[0].second, version(0));
+    EXPECT_EQ(writes[1].second, version(9));
+}
+
+TEST(AppendWriter, FlushWrites)
+{
+    arbiter::Arbiter a;
+    arbiter::fs::mkdirp(tmpPath);
+    const auto ep(a.getEndpoint(tmpPath));
+
+    AppendWriter writer;
+    writer.put(ep, "flushed", version(1));
+    writer.put(ep, "flushed", version(2));
+    writer.flush();
+
+    EXPECT_EQ(ep.getBinary("flushed"), version(2));
+}
+
+TEST(AppendWriter, Failure)
+{
+    arbiter::Arbiter a;
+    const auto ep(a.getEndpoint(tmpPath));
+
+    Recorder recorder;
+    AppendWriter writer(1, recorder.put());
+
+    recorder.fail(true);
+    writer.put(ep, "a", version(1));
+    EXPECT_THROW(writer.flush(), std::runtime_error);
+    EXPECT_TRUE(recorder.writes().empty());
+
+    // The failed data is kept and retried.
+    recorder.fail(false);
+    writer.flush();
+
+    const auto writes(recorder.writes());
+    ASSERT_EQ(writes.size(), 1u);
+    EXPECT_EQ(writes[0].second, version(1));
+}
+
+TEST(AppendWriter, FailureSuperseded)
+{
+    arbiter::Arbiter a;
+    const auto ep(a.getEndpoint(tmpPath));
+
+    Recorder recorder;
+    AppendWriter writer(1, recorder.put(true));
+
+    // Newer data arriving during a failed write is still written.
+    recorder.fail(true);
+    writer.put(ep, "a", version(1));
+    recorder.awaitStarted();
+    writer.put(ep, "a", version(2));
+    recorder.fail(false);
+    recorder.release();
+
+    writer.flush();
+
+    const auto writes(recorder.writes());
+    ASSERT_EQ(writes.size(), 1u);
+    EXPECT_EQ(writes[0].second, version(2));
+}
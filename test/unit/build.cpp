@@ -1,6 +1,9 @@
 #include "gtest/gtest.h"
 #include "config.hpp"
 
+#include <algorithm>
+#include <map>
+
 #include <pdal/Dimension.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/Utils.hpp>
@@ -12,7 +15,11 @@
 #include "entwine/tree/config-parser.hpp"
 #include "entwine/tree/inference.hpp"
 #include "entwine/tree/merger.hpp"
+#include "entwine/tree/tiler.hpp"
+#include "entwine/types/storage-types.hpp"
+#include "entwine/types/storage.hpp"
 #include "entwine/types/vector-point-table.hpp"
+#include "entwine/util/compression.hpp"
 #include "entwine/util/json.hpp"
 
 #include "octree.hpp"
@@ -115,8 +122,9 @@ TEST_P(BuildTest, Verify)
         do
         {
             build(config, ran);
-            const Json::Value mani(parse(outEp.get("entwine-manifest")));
-            total = mani["fileInfo"].size();
+            total = Manifest(
+                    parse(outEp.get("entwine-manifest")),
+                    outEp).size();
             ran += run;
         }
         while (run && ran < total);
@@ -144,6 +152,7 @@ TEST_P(BuildTest, Verify)
     }
 
     const Json::Value meta(parse(outEp.get("entwine")));
+    EXPECT_GT(meta["chunkBytes"].asUInt64(), 0u);
 
     const Metadata metadata(meta);
     const Manifest manifest(parse(outEp.get("entwine-manifest")), outEp);
@@ -179,7 +188,21 @@ TEST_P(BuildTest, Verify)
     // Miscellaneous parameters.
     EXPECT_EQ(
             meta["storage"].asString(),
-            config["absolute"].asBool() ? "lazperf" : "laszip");
+            config.isMember("storage") ?
+                config["storage"].asString() :
+                config["absolute"].asBool() ? "lazperf" : "laszip");
+
+    if (config.isMember("zstdLevel"))
+    {
+        EXPECT_EQ(meta["zstdLevel"].asInt(), config["zstdLevel"].asInt());
+    }
+
+    if (config.isMember("segmentPoints"))
+    {
+        EXPECT_EQ(
+                meta["segmentPoints"].asUInt64(),
+                config["segmentPoints"].asUInt64());
+    }
 
     EXPECT_EQ(meta["compressHierarchy"].asString(), "lzma");
 
@@ -276,6 +299,31 @@ TEST_P(BuildTest, Verify)
 
         ++depth;
     }
+
+    // Each completed query, 4 per depth, is recorded in the cache statistics.
+    const Json::Value stats(cache.stats());
+    EXPECT_EQ(stats["stages"]["query"]["count"].asUInt64(), (depth - 1) * 4);
+    EXPECT_LE(
+            stats["stages"]["query"]["p50"].asDouble(),
+            stats["stages"]["query"]["p99"].asDouble());
+    EXPECT_EQ(
+            stats["stages"]["fetch"]["count"].asUInt64(),
+            stats["chunks"]["misses"].asUInt64());
+
+    // Every point should be exported to exactly one tile.
+    arbiter::Arbiter localArbiter;
+    Tiler tiler(localArbiter.getEndpoint(outPath), 4, bounds.width() / 4);
+
+    std::mutex mutex;
+    std::size_t tiled(0);
+
+    tiler.go([&](pdal::PointView& view, Bounds)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tiled += view.size();
+    });
+
+    EXPECT_EQ(tiled, manifest.pointStats().inserts());
 }
 
 namespace absolute
@@ -319,15 +367,67 @@ namespace absolute
         return json;
     })());
 
+    Json::Value balanced(([]()
+    {
+        Json::Value json;
+        json["input"] = test::dataPath() + "ellipsoid-multi-laz";
+        json["output"] = outPath;
+        json["absolute"] = true;
+        json["subset"]["of"] = 3;
+        json["subset"]["balance"] = true;
+        return json;
+    })());
+
+    Json::Value segmented(([]()
+    {
+        Json::Value json;
+        json["input"] = test::dataPath() + "ellipsoid-multi-laz";
+        json["output"] = outPath;
+        json["absolute"] = true;
+        json["storage"] = "lazperf-segmented";
+        return json;
+    })());
+
+    Json::Value segmentedSmall(([]()
+    {
+        Json::Value json;
+        json["input"] = test::dataPath() + "ellipsoid-multi-laz";
+        json["output"] = outPath;
+        json["absolute"] = true;
+        json["storage"] = "lazperf-segmented";
+        json["segmentPoints"] = 1000;
+        return json;
+    })());
+
     Expectations one(single, actualBounds);
     Expectations two(multi, actualBounds);
     Expectations con(continued, actualBounds);
     Expectations sub(subset, actualBounds);
+    Expectations bal(balanced, actualBounds);
+    Expectations seg(segmented, actualBounds);
+    Expectations sms(segmentedSmall, actualBounds);
 
     INSTANTIATE_TEST_CASE_P(
             Absolute,
             BuildTest,
-            testing::Values(one, two, con, sub), );
+            testing::Values(one, two, con, sub, bal, seg, sms), );
+
+#ifdef ENTWINE_ZSTD
+    Json::Value zstd(([]()
+    {
+        Json::Value json;
+        json["input"] = test::dataPath() + "ellipsoid-multi-laz";
+        json["output"] = outPath;
+        json["absolute"] = true;
+        json["storage"] = "zstd";
+        json["zstdLevel"] = 5;
+        return json;
+    })());
+
+    Expectations zst(zstd, actualBounds);
+
+    INSTANTIATE_TEST_CASE_P(AbsoluteZstd, BuildTest, testing::Values(zst), );
+#endif
 }
 
 namespace scaled
@@ -380,6 +480,189 @@ namespace scaled
             testing::Values(one, two, con, sub), );
 }
 
+TEST(Build, Continuation)
+{
+    arbiter::Arbiter a;
+    const arbiter::Endpoint outEp(a.getEndpoint(outPath));
+
+    auto cleanup([&a]()
+    {
+        for (const auto p : a.resolve(outPath + "/**"))
+        {
+            pdal::FileUtils::deleteFile(p);
+        }
+    });
+
+    // Chunk files are named by their IDs.
+    auto chunkFiles([&a]()
+    {
+        std::map<std::string, uint64_t> files;
+        for (const auto p : a.resolve(outPath + "/*"))
+        {
+            const std::string name(arbiter::util::getBasename(p));
+            if (name.find_first_not_of("0123456789") == std::string::npos)
+            {
+                files[name] = a.getSize(p);
+            }
+        }
+        return files;
+    });
+
+    cleanup();
+
+    Json::Value config;
+    config["input"] = test::dataPath() + "ellipsoid-multi-laz";
+    config["output"] = outPath;
+    config["absolute"] = true;
+
+    auto builder(ConfigParser::getBuilder(config));
+    ASSERT_TRUE(builder);
+    builder->go(7);
+
+    const auto before(chunkFiles());
+    ASSERT_FALSE(before.empty());
+
+    // Append one more file, which covers a single octant.
+    builder = ConfigParser::getBuilder(config);
+    ASSERT_TRUE(builder);
+    ASSERT_TRUE(builder->isContinuation());
+    builder->go(1);
+
+    const StorageStats stats(builder->metadata().storage().stats());
+    EXPECT_GT(stats.chunks, 0u);
+    EXPECT_LT(stats.rewrites, stats.chunks);
+    EXPECT_LT(stats.rewrites, before.size());
+
+    // Only chunks receiving new points are loaded.
+    EXPECT_LT(stats.reads, before.size());
+
+    uint64_t bytes(0);
+    for (const auto& f : chunkFiles()) bytes += f.second;
+
+    const Json::Value meta(parse(outEp.get("entwine")));
+    EXPECT_EQ(meta["chunkBytes"].asUInt64(), bytes);
+
+    cleanup();
+}
+
+TEST(Build, Segments)
+{
+    arbiter::Arbiter a;
+    const arbiter::Endpoint outEp(a.getEndpoint(outPath));
+    const arbiter::Endpoint tmpEp(a.getEndpoint(tmpPath));
+
+    Json::Value config;
+    config["input"] = test::dataPath() + "ellipsoid-multi-laz";
+    config["output"] = outPath;
+    config["absolute"] = true;
+    config["force"] = true;
+    config["storage"] = "lazperf-segmented";
+    config["segmentPoints"] = 1000;
+
+    auto builder(ConfigParser::getBuilder(config));
+    ASSERT_TRUE(builder);
+    builder->go();
+    builder.reset();
+
+    const Json::Value meta(parse(outEp.get("entwine")));
+    EXPECT_EQ(meta["segmentPoints"].asUInt64(), 1000u);
+
+    const Metadata metadata(meta);
+
+    TailFieldList fields;
+    for (const auto& f : meta["tail"])
+    {
+        fields.push_back(toTailField(f.asString()));
+    }
+
+    // Chunk files are named by their IDs - take the largest.
+    std::string name;
+    uint64_t largest(0);
+    for (const auto p : a.resolve(outPath + "/*"))
+    {
+        const std::string basename(arbiter::util::getBasename(p));
+        if (
+                basename.find_first_not_of("0123456789") ==
+                    std::string::npos &&
+                a.getSize(p) > largest)
+        {
+            name = basename;
+            largest = a.getSize(p);
+        }
+    }
+
+    ASSERT_FALSE(name.empty());
+
+    std::vector<char> data(outEp.getBinary(name));
+    const Tail tail(data, fields);
+    const TailSegments& segments(tail.segments());
+    ASSERT_GT(segments.size(), 1u);
+
+    std::size_t numPoints(0);
+    std::size_t numBytes(0);
+    for (const TailSegment& segment : segments)
+    {
+        EXPECT_LE(segment.numPoints, 1000u);
+        numPoints += segment.numPoints;
+        numBytes += segment.numBytes;
+    }
+
+    EXPECT_EQ(numPoints, tail.numPoints());
+    EXPECT_EQ(numBytes, data.size());
+
+    // The whole chunk, decoded across threads and stitched together.
+    PointPool pool(metadata.schema(), metadata.delta());
+    const Cell::PooledStack cells(
+            metadata.storage().deserialize(outEp, tmpEp, pool, Id(name)));
+
+    std::vector<const char*> points;
+    for (const Cell& cell : cells)
+    {
+        for (const char* p : cell) points.push_back(p);
+    }
+
+    ASSERT_EQ(points.size(), tail.numPoints());
+
+    // A segment from the middle of the chunk, decoded on its own.
+    const std::size_t index(segments.size() / 2);
+    const TailSegment& segment(segments[index]);
+
+    std::size_t first(0);
+    std::size_t offset(0);
+    for (std::size_t i(0); i < index; ++i)
+    {
+        first += segments[i].numPoints;
+        offset += segments[i].numBytes;
+    }
+
+    const Cell::PooledStack middle(
+            Compression::decompress(
+                data.data() + offset,
+                segment.numBytes,
+                segment.numPoints,
+                pool));
+
+    const std::size_t pointSize(metadata.schema().pointSize());
+    std::size_t i(first);
+
+    for (const Cell& cell : middle)
+    {
+        for (const char* p : cell)
+        {
+            ASSERT_LT(i, points.size());
+            EXPECT_TRUE(std::equal(p, p + pointSize, points[i]));
+            ++i;
+        }
+    }
+
+    EXPECT_EQ(i, first + segment.numPoints);
+
+    for (const auto p : a.resolve(outPath + "/**"))
+    {
+        pdal::FileUtils::deleteFile(p);
+    }
+}
+
 TEST(Build, Kernel)
 {
     std::string output;
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <json/json.h>
+
+#include <entwine/formats/cesium/settings.hpp>
+#include <entwine/formats/cesium/tile.hpp>
+
+using namespace entwine;
+
+namespace
+{
+    const std::size_t numPoints(1 << 18);
+    const std::size_t headerSize(28);
+
+    // Points on the surface of the same ellipsoid as the test data set, with
+    // outward-facing normals.
+    cesium::TileData makeTileData()
+    {
+        cesium::TileData data(numPoints, true, true);
+        const double pi(std::acos(-1.0));
+        const Point radius(500, 400, 300);
+
+        for (std::size_t i(0); i < numPoints; ++i)
+        {
+            const double lon(2.0 * pi * (i % 512) / 512.0);
+            const double lat(pi * (i / 512) / (numPoints / 512) - pi / 2.0);
+
+            const Point n(
+                    std::cos(lat) * std::cos(lon),
+                    std::cos(lat) * std::sin(lon),
+                    std::sin(lat));
+
+            data.points.emplace_back(
+                    radius.x * n.x, radius.y * n.y, radius.z * n.z);
+            data.colors.emplace_back(i % 256, (i / 256) % 256, (i * 7) % 256);
+            data.normals.push_back(n);
+        }
+
+        return data;
+    }
+
+    template<typename T>
+    T get(const std::vector<char>& data, std::size_t pos)
+    {
+        T v;
+        std::memcpy(&v, data.data() + pos, sizeof(T));
+        return v;
+    }
+
+    std::vector<char> encode(
+            const cesium::TileData& data,
+            const cesium::Settings& settings)
+    {
+        return cesium::Tile(data, settings).asBinary();
+    }
+}
+
+TEST(Cesium, Compact)
+{
+    const cesium::TileData data(makeTileData());
+    const cesium::Settings plain(0, 0, "", false);
+    const cesium::Settings compact(0, 0, "", false, true, true, true);
+
+    EXPECT_TRUE(cesium::Settings(compact.toJson()).quantize());
+    EXPECT_TRUE(cesium::Settings(compact.toJson()).octNormals());
+    EXPECT_TRUE(cesium::Settings(compact.toJson()).rgb565());
+
+    const std::vector<char> a(encode(data, plain));
+    const std::vector<char> b(encode(data, compact));
+
+    // 27 bytes per point down to 10.
+    ASSERT_EQ(a.size(), get<uint32_t>(a, 8));
+    ASSERT_EQ(b.size(), get<uint32_t>(b, 8));
+    EXPECT_LT(b.size() * 2, a.size());
+
+    const uint32_t jsonSize(get<uint32_t>(b, 12));
+    const uint32_t binarySize(get<uint32_t>(b, 16));
+    EXPECT_EQ(binarySize % 8, 0u);
+
+    Json::Value json;
+    Json::Reader reader;
+    ASSERT_TRUE(reader.parse(
+                std::string(b.data() + headerSize, jsonSize), json, false));
+
+    EXPECT_EQ(json["POINTS_LENGTH"].asUInt64(), numPoints);
+    EXPECT_FALSE(json.isMember("POSITION"));
+    EXPECT_FALSE(json.isMember("RGB"));
+    EXPECT_FALSE(json.isMember("NORMAL"));
+
+    const std::size_t body(headerSize + jsonSize);
+    const std::size_t positions(
+            body + json["POSITION_QUANTIZED"]["byteOffset"].asUInt64());
+    const std::size_t colors(body + json["RGB565"]["byteOffset"].asUInt64());
+    const std::size_t normals(
+            body + json["NORMAL_OCT16P"]["byteOffset"].asUInt64());
+
+    const Json::Value& offset(json["QUANTIZED_VOLUME_OFFSET"]);
+    const Json::Value& scale(json["QUANTIZED_VOLUME_SCALE"]);
+
+    for (std::size_t i(0); i < numPoints; i += 97)
+    {
+        const Point& p(data.points[i]);
+        const double v[3] = { p.x, p.y, p.z };
+
+        for (Json::ArrayIndex d(0); d < 3; ++d)
+        {
+            const double q(get<uint16_t>(b, positions + (i * 3 + d) * 2));
+            const double s(scale[d].asDouble());
+            const double o(offset[d].asDouble());
+            EXPECT_NEAR(q / 65535.0 * s + o, v[d], s / 65535.0);
+        }
+
+        const Color& c(data.colors[i]);
+        const uint16_t rgb(get<uint16_t>(b, colors + i * 2));
+        EXPECT_EQ(rgb >> 11, c.r >> 3);
+        EXPECT_EQ((rgb >> 5) & 0x3f, c.g >> 2);
+        EXPECT_EQ(rgb & 0x1f, c.b >> 3);
+
+        // Decode the octahedral normal per the 3D Tiles spec.
+        const double ox(get<uint8_t>(b, normals + i * 2) / 127.5 - 1.0);
+        const double oy(get<uint8_t>(b, normals + i * 2 + 1) / 127.5 - 1.0);
+        Point n(ox, oy, 1.0 - std::abs(ox) - std::abs(oy));
+        if (n.z < 0)
+        {
+            n = Point(
+                    (1.0 - std::abs(oy)) * (ox < 0 ? -1.0 : 1.0),
+                    (1.0 - std::abs(ox)) * (oy < 0 ? -1.0 : 1.0),
+                    n.z);
+        }
+
+        const double l(std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z));
+        const Point& e(data.normals[i]);
+        EXPECT_GT((n.x * e.x + n.y * e.y + n.z * e.z) / l, 0.999);
+    }
+}
+
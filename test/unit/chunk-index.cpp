@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <set>
+#include <vector>
+
+#include <json/json.h>
+
+#include <entwine/tree/chunk-index.hpp>
+#include <entwine/types/structure.hpp>
+
+using namespace entwine;
+
+namespace
+{
+    Structure makeStructure()
+    {
+        Json::Value json;
+        json["nullDepth"] = 6;
+        json["baseDepth"] = 10;
+        json["coldDepth"] = 0;
+        json["pointsPerChunk"] = 262144;
+        json["numPointsHint"] = 1000000000;
+        json["sparseDepth"] = 14;
+        return Structure(json);
+    }
+
+    // Every chunk ID from the cold depths up through the first few sparse
+    // depths of this structure, whether or not it's in the index.
+    std::vector<Id> allIds(const Structure& s, std::size_t depthEnd)
+    {
+        std::vector<Id> ids;
+
+        for (std::size_t d(s.coldDepthBegin()); d < depthEnd; ++d)
+        {
+            const Id begin(ChunkInfo::calcLevelIndex(s.dimensions(), d));
+            const Id end(ChunkInfo::calcLevelIndex(s.dimensions(), d + 1));
+            const Id step(s.getInfo(begin).pointsPerChunk());
+
+            for (Id id(begin); id < end; id += step) ids.push_back(id);
+        }
+
+        return ids;
+    }
+}
+
+TEST(ChunkIndex, RoundTrip)
+{
+    const Structure structure(makeStructure());
+    const std::vector<Id> all(
+            allIds(structure, structure.sparseDepthBegin() + 3));
+
+    // A dense depth, a sparse depth, and a scattering of deeper chunks.
+    std::set<Id> ids;
+    for (std::size_t i(0); i < all.size(); ++i)
+    {
+        const std::size_t depth(
+                ChunkInfo::calcDepth(structure.factor(), all[i]));
+
+        if (depth == structure.coldDepthBegin() && i % 3) ids.insert(all[i]);
+        else if (depth > structure.coldDepthBegin() && i % 97 == 0)
+        {
+            ids.insert(all[i]);
+        }
+    }
+
+    ASSERT_FALSE(ids.empty());
+
+    const ChunkIndex built(structure, ids);
+    const ChunkIndex loaded(structure, built.toBinary());
+
+    EXPECT_EQ(built.size(), ids.size());
+    EXPECT_EQ(loaded.size(), ids.size());
+    EXPECT_EQ(loaded.ids(), ids);
+    EXPECT_EQ(loaded.toBinary(), built.toBinary());
+
+    for (const Id& id : all)
+    {
+        EXPECT_EQ(loaded.exists(id), ids.count(id) == 1) << id;
+    }
+
+    // Much smaller than the JSON list of decimal IDs.
+    std::size_t jsonSize(0);
+    for (const Id& id : ids) jsonSize += id.str().size() + 3;
+    EXPECT_LT(built.toBinary().size(), jsonSize);
+
+    EXPECT_THROW(
+            ChunkIndex(structure, std::vector<char>(4, 'x')),
+            std::runtime_error);
+}
+
@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <entwine/types/point-pool.hpp>
+#include <entwine/types/schema.hpp>
+#include <entwine/util/compression.hpp>
+
+using namespace entwine;
+
+namespace
+{
+    const Schema schema(
+            DimList
+            {
+                DimInfo(pdal::Dimension::Id::X, pdal::Dimension::Type::Double),
+                DimInfo(pdal::Dimension::Id::Y, pdal::Dimension::Type::Double),
+                DimInfo(pdal::Dimension::Id::Z, pdal::Dimension::Type::Double),
+                DimInfo(pdal::Dimension::Id::Intensity)
+            });
+
+    // Packed points following a spiral, so neighbors are similar but not
+    // identical.
+    std::vector<char> makePoints(const std::size_t numPoints)
+    {
+        const std::size_t pointSize(schema.pointSize());
+        std::vector<char> data(numPoints * pointSize);
+
+        for (std::size_t i(0); i < numPoints; ++i)
+        {
+            char* pos(data.data() + i * pointSize);
+
+            const double t(static_cast<double>(i) / 10.0);
+            const double xyz[3] = { t * std::cos(t), t * std::sin(t), t };
+            const uint16_t intensity(static_cast<uint16_t>(i * 7919));
+
+            std::memcpy(pos, xyz, sizeof(xyz));
+            std::memcpy(pos + sizeof(xyz), &intensity, sizeof(intensity));
+        }
+
+        return data;
+    }
+}
+
+TEST(Compression, CompressorRoundTrip)
+{
+    const std::size_t numPoints(5000);
+    const std::size_t pointSize(schema.pointSize());
+    const std::vector<char> points(makePoints(numPoints));
+
+    // Underestimate the point count, so the output outgrows its reservation.
+    Compressor compressor(schema, numPoints / 10, 0);
+    for (std::size_t i(0); i < numPoints; ++i)
+    {
+        compressor.push(points.data() + i * pointSize);
+    }
+
+    EXPECT_EQ(compressor.numPoints(), numPoints);
+
+    const auto compressed(compressor.data());
+    ASSERT_TRUE(compressed);
+    EXPECT_LT(compressed->size(), points.size());
+    EXPECT_THROW(compressor.data(), std::runtime_error);
+
+    // Pushing points one at a time matches compressing them all at once.
+    EXPECT_EQ(*compressed, *Compression::compress(points, schema));
+
+    const auto decompressed(
+            Compression::decompress(*compressed, schema, numPoints));
+    ASSERT_TRUE(decompressed);
+    EXPECT_EQ(*decompressed, points);
+
+    PointPool pool(schema);
+    const Cell::PooledStack cells(
+            Compression::decompress(
+                compressed->data(),
+                compressed->size(),
+                numPoints,
+                pool));
+
+    ASSERT_EQ(cells.size(), numPoints);
+
+    std::size_t i(0);
+    for (const Cell& cell : cells)
+    {
+        for (const char* p : cell)
+        {
+            ASSERT_LT(i, numPoints);
+            const char* expected(points.data() + i * pointSize);
+            EXPECT_TRUE(std::equal(p, p + pointSize, expected)) << i;
+            ++i;
+        }
+    }
+
+    EXPECT_EQ(i, numPoints);
+}
@@ -7,6 +7,8 @@
 #include <entwine/third/arbiter/arbiter.hpp>
 #include <entwine/tree/builder.hpp>
 #include <entwine/tree/config-parser.hpp>
+#include <entwine/types/manifest.hpp>
+#include <entwine/util/json.hpp>
 
 using namespace entwine;
 
@@ -220,3 +222,72 @@ TEST_F(FilesTest, BoundsScaled)
     }
 }
 
+
+TEST_F(FilesTest, ManifestIndex)
+{
+    // Enough files that the manifest is saved in pieces.
+    FileInfoList fileInfo;
+    for (std::size_t y(0); y < 32; ++y)
+    {
+        for (std::size_t x(0); x < 32; ++x)
+        {
+            fileInfo.emplace_back(
+                    std::to_string(x) + "-" + std::to_string(y) + ".laz");
+            fileInfo.back().bounds(Bounds(x, y, 0, x + 1, y + 1, 1));
+        }
+    }
+
+    fileInfo.emplace_back(std::string("no-bounds.laz"));
+
+    const auto ep(a.getEndpoint(tmpPath + "manifest/"));
+    arbiter::fs::mkdirp(ep.root());
+    Manifest(fileInfo, ep).save(true);
+
+    const Manifest manifest(parse(ep.get("entwine-manifest")), ep);
+    ASSERT_EQ(manifest.size(), fileInfo.size());
+
+    for (const Bounds& b : {
+            Bounds(2.5, 2.5, 0, 4.5, 3.5, 1),
+            Bounds(-10, -10, -10, 100, 100, 100),
+            Bounds(31.5, 0, 0, 40, 0.5, 1),
+            Bounds(50, 50, 0, 60, 60, 1) })
+    {
+        OriginList expected;
+        for (Origin o(0); o < fileInfo.size(); ++o)
+        {
+            const Bounds* f(fileInfo[o].bounds());
+            if (f && f->overlaps(b)) expected.push_back(o);
+        }
+
+        EXPECT_EQ(manifest.find(b), expected);
+    }
+
+    EXPECT_EQ(manifest.get(1000).path(), "8-31.laz");
+    EXPECT_EQ(*manifest.get(1000).bounds(), Bounds(8, 31, 0, 9, 32, 1));
+
+    // A continuation looks at every file, but only rewrites the shards whose
+    // files have changed.
+    Manifest continued(parse(ep.get("entwine-manifest")), ep);
+    for (Origin o(0); o < continued.size(); ++o) continued.get(o);
+
+    const auto m(ep.getSubEndpoint("m"));
+    std::vector<std::string> shards;
+    for (std::size_t i(0); i < continued.size(); i += 100)
+    {
+        shards.push_back(std::to_string(i));
+        pdal::FileUtils::deleteFile(m.fullPath(shards.back()));
+    }
+
+    continued.save(true);
+    for (const auto& s : shards)
+    {
+        EXPECT_FALSE(pdal::FileUtils::fileExists(m.fullPath(s))) << s;
+    }
+
+    continued.set(1000, FileInfo::Status::Inserted);
+    continued.save(true);
+    for (const auto& s : shards)
+    {
+        EXPECT_EQ(pdal::FileUtils::fileExists(m.fullPath(s)), s == "1000");
+    }
+}
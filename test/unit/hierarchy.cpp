@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <entwine/tree/hierarchy-block.hpp>
+
+using namespace entwine;
+
+namespace
+{
+    const std::size_t numThreads(8);
+    const std::size_t numCounts(1 << 20);
+}
+
+TEST(HierarchyTube, Basic)
+{
+    HierarchyTube tube;
+    EXPECT_TRUE(tube.empty());
+
+    // Enough ticks to spill past the inline slots into several tables.
+    for (uint64_t tick(0); tick < 100; ++tick) tube.count(tick, tick + 1);
+    tube.add(42, 1000);
+
+    EXPECT_FALSE(tube.empty());
+    EXPECT_EQ(tube.get(0), 1u);
+    EXPECT_EQ(tube.get(42), 1043u);
+    EXPECT_EQ(tube.get(99), 100u);
+    EXPECT_EQ(tube.get(100), 0u);
+
+    uint64_t prev(0);
+    std::size_t entries(0);
+    tube.forEach([&](uint64_t tick, uint64_t val)
+    {
+        if (entries) { EXPECT_GT(tick, prev); }
+        prev = tick;
+        ++entries;
+    });
+    EXPECT_EQ(entries, 100u);
+
+    HierarchyTube moved(std::move(tube));
+    EXPECT_TRUE(tube.empty());
+    EXPECT_EQ(moved.get(42), 1043u);
+}
+
+TEST(HierarchyTube, Contention)
+{
+    // All threads hammer the same small set of tubes and ticks, which is the
+    // worst case for the shallow depths of a build.
+    const std::size_t numTubes(16);
+    const std::size_t numTicks(8);
+
+    std::vector<HierarchyTube> tubes(numTubes);
+    std::vector<std::thread> threads;
+
+    for (std::size_t t(0); t < numThreads; ++t)
+    {
+        threads.emplace_back([&tubes, t]()
+        {
+            for (std::size_t i(0); i < numCounts; ++i)
+            {
+                const std::size_t n(i + t);
+                tubes[n % numTubes].count(n / numTubes % numTicks, 1);
+            }
+        });
+    }
+
+    for (auto& t : threads) t.join();
+
+    uint64_t total(0);
+    for (const auto& tube : tubes)
+    {
+        tube.forEach([&total](uint64_t tick, uint64_t val) { total += val; });
+    }
+
+    EXPECT_EQ(total, numThreads * numCounts);
+}
@@ -180,3 +180,109 @@ TEST(Infer, TrustHeaders)
                 nycCenter + nominalBounds.max()));
 }
 
+
+TEST(Infer, Cache)
+{
+    const std::string path(test::dataPath() + "ellipsoid-multi-laz");
+    const std::string cachePath(test::dataPath() + "tmp/infer-cache");
+
+    for (const auto& f : arbiter::Arbiter().resolve(cachePath + "/*"))
+    {
+        arbiter::fs::remove(f);
+    }
+
+    Inference first(path);
+    first.cache(cachePath);
+    first.go();
+    ASSERT_TRUE(first.done());
+    ASSERT_TRUE(first.cache());
+    EXPECT_EQ(first.cache()->hits(), 0u);
+    EXPECT_EQ(first.cache()->misses(), 8u);
+
+    Inference second(path);
+    second.cache(cachePath);
+    second.go();
+    ASSERT_TRUE(second.done());
+    EXPECT_EQ(second.cache()->hits(), 8u);
+    EXPECT_EQ(second.cache()->misses(), 0u);
+
+    checkCommon(second);
+    EXPECT_EQ(second.numPoints(), first.numPoints());
+    EXPECT_EQ(second.schema(), first.schema());
+    EXPECT_EQ(second.delta()->scale(), first.delta()->scale());
+}
+
+TEST(Infer, Sampled)
+{
+    const std::string path(test::dataPath() + "ellipsoid-multi-las");
+
+    Inference exact(path, nullptr, false);
+    exact.go();
+    ASSERT_TRUE(exact.done());
+
+    Inference sampled(path, nullptr, false);
+    sampled.sample(0.05);
+    sampled.go();
+    ASSERT_TRUE(sampled.done());
+
+    EXPECT_EQ(sampled.schema(), exact.schema());
+    EXPECT_EQ(sampled.numPoints(), exact.numPoints());
+
+    for (const auto& f : sampled.fileInfo()) EXPECT_TRUE(f.sampled());
+
+    // The estimated bounds should be close to the true bounds, within the
+    // safety margin.
+    checkBoundsNear(sampled.bounds(), exact.bounds(), 30.0);
+
+    EXPECT_ANY_THROW(sampled.sample(0));
+    EXPECT_ANY_THROW(sampled.sample(1.5));
+}
+
+TEST(Infer, SampledTransformation)
+{
+    const std::string path(test::dataPath() + "ellipsoid-multi-las");
+
+    // Swap X and Y, flipping one of them, and stretch Z.
+    const Transformation t
+    {
+        0, 1, 0, 1000,
+        -1, 0, 0, 0,
+        0, 0, 2, 10,
+        0, 0, 0, 1
+    };
+
+    Inference plain(path, nullptr, false);
+    plain.go();
+    ASSERT_TRUE(plain.done());
+
+    const Bounds& b(plain.bounds());
+    const Bounds expected(
+            b.min().y + 1000, -b.max().x, b.min().z * 2 + 10,
+            b.max().y + 1000, -b.min().x, b.max().z * 2 + 10);
+
+    // Every point is read, and each is transformed exactly once.
+    Inference exact(path, nullptr, false);
+    exact.transformation(t);
+    exact.go();
+    ASSERT_TRUE(exact.done());
+    checkBoundsNear(exact.bounds(), expected);
+
+    // Sampling everything visits the same points.
+    Inference full(path, nullptr, false);
+    full.transformation(t);
+    full.sample(1);
+    full.go();
+    ASSERT_TRUE(full.done());
+    for (const auto& f : full.fileInfo()) EXPECT_FALSE(f.sampled());
+    checkBoundsNear(full.bounds(), expected);
+
+    Inference sampled(path, nullptr, false);
+    sampled.transformation(t);
+    sampled.sample(0.05);
+    sampled.go();
+    ASSERT_TRUE(sampled.done());
+    for (const auto& f : sampled.fileInfo()) EXPECT_TRUE(f.sampled());
+
+    // The margin is proportional to the transformed bounds, so is doubled in Z.
+    checkBoundsNear(sampled.bounds(), expected, 60.0);
+}